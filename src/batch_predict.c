@@ -0,0 +1,270 @@
+#define _GNU_SOURCE //for strptime
+
+#include "batch_predict.h"
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+#include <time.h>
+#include <math.h>
+#include "thread_pool.h"
+#include "pass_prediction.h"
+
+//length of formatted time strings
+#define BATCH_PREDICT_TIME_LENGTH 32
+
+int batch_predict_parse_time(const char *string, predict_julian_date_t *ret_time)
+{
+	const char *formats[] = {"%Y-%m-%dT%H:%M:%S", "%Y-%m-%d %H:%M:%S", "%Y-%m-%d"};
+	int num_formats = sizeof(formats)/sizeof(formats[0]);
+	for (int i=0; i < num_formats; i++) {
+		struct tm timeval = {0};
+		const char *end = strptime(string, formats[i], &timeval);
+		if ((end != NULL) && ((*end == '\0') || (*end == 'Z'))) {
+			*ret_time = predict_to_julian(timegm(&timeval));
+			return 0;
+		}
+	}
+	return -1;
+}
+
+int batch_predict_parse_format(const char *string, enum batch_predict_format *ret_format)
+{
+	if (strcmp(string, "csv") == 0) {
+		*ret_format = BATCH_PREDICT_FORMAT_CSV;
+	} else if (strcmp(string, "json") == 0) {
+		*ret_format = BATCH_PREDICT_FORMAT_JSON;
+	} else {
+		return -1;
+	}
+	return 0;
+}
+
+/**
+ * Find satellite in TLE database from satellite number or name.
+ *
+ * \param tle_db TLE database
+ * \param satellite Satellite number or name
+ * \return Index in TLE database, -1 if not found
+ **/
+int batch_predict_find_satellite(const struct tle_db *tle_db, const char *satellite)
+{
+	bool is_number = strlen(satellite) > 0;
+	for (int i=0; satellite[i] != '\0'; i++) {
+		if (!isdigit(satellite[i])) {
+			is_number = false;
+			break;
+		}
+	}
+	if (is_number) {
+		return tle_db_find_entry(tle_db, strtol(satellite, NULL, 10));
+	}
+
+	for (int i=0; i < tle_db->num_tles; i++) {
+		if (strcmp(tle_db_entry_name(tle_db, i), satellite) == 0) {
+			return i;
+		}
+	}
+	return -1;
+}
+
+/**
+ * Format time as ISO 8601 UTC string.
+ *
+ * \param time Time
+ * \param ret_string Returned string, of length BATCH_PREDICT_TIME_LENGTH
+ **/
+void batch_predict_format_time(predict_julian_date_t time, char *ret_string)
+{
+	time_t epoch = predict_from_julian(time);
+	struct tm timeval;
+	gmtime_r(&epoch, &timeval);
+	strftime(ret_string, BATCH_PREDICT_TIME_LENGTH, "%Y-%m-%dT%H:%M:%SZ", &timeval);
+}
+
+/**
+ * Write quoted string with the characters that have to be escaped in the output format escaped.
+ *
+ * \param output Output sink
+ * \param format Output format
+ * \param string String to write
+ **/
+void batch_predict_write_string(output_sink_t *output, enum batch_predict_format format, const char *string)
+{
+	//worst case is six characters per escaped control character, in addition to the quotes
+	char *escaped = (char*)malloc(6*strlen(string) + 3);
+	int length = 0;
+	escaped[length++] = '"';
+	for (int i=0; string[i] != '\0'; i++) {
+		char c = string[i];
+		if (format == BATCH_PREDICT_FORMAT_CSV) {
+			if (c == '"') {
+				escaped[length++] = '"';
+			}
+			escaped[length++] = c;
+		} else {
+			if ((c == '"') || (c == '\\')) {
+				escaped[length++] = '\\';
+				escaped[length++] = c;
+			} else if ((unsigned char)c < 0x20) {
+				length += sprintf(escaped + length, "\\u%04x", c);
+			} else {
+				escaped[length++] = c;
+			}
+		}
+	}
+	escaped[length++] = '"';
+	escaped[length] = '\0';
+	output_sink_write(output, escaped);
+	free(escaped);
+}
+
+/**
+ * Write tabulated rows of pass to output sink, as CSV lines or as the elements of a JSON array.
+ *
+ * \param output Output sink
+ * \param options Prediction options
+ * \param observer Ground station
+ * \param tle_db TLE database
+ * \param pass Pass
+ **/
+void batch_predict_write_rows(output_sink_t *output, const struct batch_predict_options *options, const predict_observer_t *observer, const struct tle_db *tle_db, const struct pass_prediction *pass)
+{
+	predict_orbital_elements_t *orbital_elements = tle_db_entry_to_orbital_elements(tle_db, pass->tle_index);
+	if (orbital_elements == NULL) {
+		return;
+	}
+
+	//names of enum pass_tabulation_event
+	const char *event_names[] = {"aos", "tca", "los", "step"};
+	char aos[BATCH_PREDICT_TIME_LENGTH], row_time[BATCH_PREDICT_TIME_LENGTH];
+	batch_predict_format_time(pass->pass.aos, aos);
+	long satellite_number = tle_db->tles[pass->tle_index].satellite_number;
+
+	pass_tabulation_t tabulation;
+	pass_tabulation_start(&tabulation, observer, orbital_elements, &(pass->pass), options->tabulation_mode, options->tabulation_step);
+	struct pass_tabulation_row row;
+	bool first = true;
+	while (pass_tabulation_next(&tabulation, &row)) {
+		batch_predict_format_time(row.time, row_time);
+		if (options->format == BATCH_PREDICT_FORMAT_CSV) {
+			output_sink_printf(output, "%ld,", satellite_number);
+			batch_predict_write_string(output, options->format, tle_db_entry_name(tle_db, pass->tle_index));
+			output_sink_printf(output, ",%s,%s,%s,%.2f,%.2f,%.1f\n", aos, row_time, event_names[row.event], row.observation.azimuth*180.0/M_PI, row.observation.elevation*180.0/M_PI, row.observation.range);
+		} else {
+			output_sink_printf(output, "%s\n    {\"time\": \"%s\", \"event\": \"%s\", \"azimuth\": %.2f, \"elevation\": %.2f, \"range\": %.1f}", first ? "" : ",", row_time, event_names[row.event], row.observation.azimuth*180.0/M_PI, row.observation.elevation*180.0/M_PI, row.observation.range);
+		}
+		first = false;
+	}
+
+	predict_destroy_orbital_elements(orbital_elements);
+}
+
+/**
+ * Write pass to output sink. In CSV format, only the tabulated rows are written when the pass is tabulated.
+ *
+ * \param output Output sink
+ * \param options Prediction options
+ * \param observer Ground station
+ * \param tle_db TLE database
+ * \param pass Pass
+ * \param first Whether this is the first pass written, used for separating JSON objects
+ **/
+void batch_predict_write_pass(output_sink_t *output, const struct batch_predict_options *options, const predict_observer_t *observer, const struct tle_db *tle_db, const struct pass_prediction *pass, bool first)
+{
+	enum batch_predict_format format = options->format;
+	bool tabulated = options->tabulation_mode != PASS_TABULATION_EVENTS;
+	char aos[BATCH_PREDICT_TIME_LENGTH], tca[BATCH_PREDICT_TIME_LENGTH], los[BATCH_PREDICT_TIME_LENGTH];
+	batch_predict_format_time(pass->pass.aos, aos);
+	batch_predict_format_time(pass->pass.tca, tca);
+	batch_predict_format_time(pass->pass.los, los);
+	long satellite_number = tle_db->tles[pass->tle_index].satellite_number;
+
+	if ((format == BATCH_PREDICT_FORMAT_CSV) && tabulated) {
+		batch_predict_write_rows(output, options, observer, tle_db, pass);
+	} else if (format == BATCH_PREDICT_FORMAT_CSV) {
+		output_sink_printf(output, "%ld,", satellite_number);
+		batch_predict_write_string(output, format, tle_db_entry_name(tle_db, pass->tle_index));
+		output_sink_printf(output, ",%s,%.2f,%s,%.2f,%.2f,%s,%.2f\n", aos, pass->aos_azimuth*180.0/M_PI, tca, pass->tca_azimuth*180.0/M_PI, pass->pass.max_elevation*180.0/M_PI, los, pass->los_azimuth*180.0/M_PI);
+	} else {
+		output_sink_printf(output, "%s\n  {\"satellite_number\": %ld, \"name\": ", first ? "" : ",", satellite_number);
+		batch_predict_write_string(output, format, tle_db_entry_name(tle_db, pass->tle_index));
+		output_sink_printf(output, ", \"aos\": \"%s\", \"aos_azimuth\": %.2f, \"tca\": \"%s\", \"tca_azimuth\": %.2f, \"max_elevation\": %.2f, \"los\": \"%s\", \"los_azimuth\": %.2f", aos, pass->aos_azimuth*180.0/M_PI, tca, pass->tca_azimuth*180.0/M_PI, pass->pass.max_elevation*180.0/M_PI, los, pass->los_azimuth*180.0/M_PI);
+		if (tabulated) {
+			output_sink_write(output, ", \"rows\": [");
+			batch_predict_write_rows(output, options, observer, tle_db, pass);
+			output_sink_write(output, "\n  ]");
+		}
+		output_sink_write(output, "}");
+	}
+}
+
+int batch_predict_select_satellites(const struct batch_predict_options *options, const struct tle_db *tle_db, int **ret_tle_indices)
+{
+	int num_selected = 0;
+	int *tle_indices = NULL;
+	int num_requested = string_array_size((string_array_t*)&(options->satellites));
+	if (num_requested > 0) {
+		tle_indices = (int*)malloc(sizeof(int)*num_requested);
+		for (int i=0; i < num_requested; i++) {
+			const char *satellite = string_array_get((string_array_t*)&(options->satellites), i);
+			int tle_index = batch_predict_find_satellite(tle_db, satellite);
+			if (tle_index < 0) {
+				fprintf(stderr, "Satellite %s not found in TLE database.\n", satellite);
+				free(tle_indices);
+				return -1;
+			}
+			tle_indices[num_selected++] = tle_index;
+		}
+	} else {
+		tle_indices = (int*)malloc(sizeof(int)*(tle_db->num_tles + 1));
+		for (int i=0; i < tle_db->num_tles; i++) {
+			if (tle_db_entry_enabled(tle_db, i)) {
+				tle_indices[num_selected++] = i;
+			}
+		}
+	}
+	*ret_tle_indices = tle_indices;
+	return num_selected;
+}
+
+int batch_predict_run(const struct batch_predict_options *options, const predict_observer_t *observer, const struct tle_db *tle_db, output_sink_t *output)
+{
+	int *tle_indices = NULL;
+	int num_selected = batch_predict_select_satellites(options, tle_db, &tle_indices);
+	if (num_selected < 0) {
+		return -1;
+	}
+
+	pass_prediction_list_t passes = {0};
+	thread_pool_t *pool = thread_pool_create(0);
+	int retval = pass_prediction_run(tle_db, tle_indices, num_selected, observer, options->start_time, options->end_time, options->min_elevation, pool, &passes);
+	if (pool != NULL) {
+		thread_pool_destroy(&pool);
+	}
+	free(tle_indices);
+	if (retval != 0) {
+		fprintf(stderr, "Pass prediction failed.\n");
+		pass_prediction_list_free(&passes);
+		return -1;
+	}
+
+	if ((options->format == BATCH_PREDICT_FORMAT_CSV) && (options->tabulation_mode != PASS_TABULATION_EVENTS)) {
+		output_sink_write(output, "satellite_number,name,aos,time,event,azimuth,elevation,range\n");
+	} else if (options->format == BATCH_PREDICT_FORMAT_CSV) {
+		output_sink_write(output, "satellite_number,name,aos,aos_azimuth,tca,tca_azimuth,max_elevation,los,los_azimuth\n");
+	} else {
+		output_sink_write(output, "[");
+	}
+
+	for (int i=0; i < passes.num_passes; i++) {
+		batch_predict_write_pass(output, options, observer, tle_db, &(passes.passes[i]), i == 0);
+	}
+
+	if (options->format == BATCH_PREDICT_FORMAT_JSON) {
+		output_sink_write(output, "\n]\n");
+	}
+	output_sink_flush(output);
+
+	pass_prediction_list_free(&passes);
+	return 0;
+}
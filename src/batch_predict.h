@@ -0,0 +1,90 @@
+#ifndef BATCH_PREDICT_H_DEFINED
+#define BATCH_PREDICT_H_DEFINED
+
+#include <predict/predict.h>
+#include "string_array.h"
+#include "tle_db.h"
+#include "output_sink.h"
+#include "pass_tabulation.h"
+
+/**
+ * Headless pass prediction, used for the --predict command line mode. Passes of the selected satellites are
+ * found in parallel using the pass prediction engine, and written as CSV or JSON sorted by AOS without
+ * any ncurses user interface. Each pass can optionally be tabulated at fixed time or angular steps, in which case
+ * the rows of each pass are written as well.
+ **/
+
+//default length of prediction time window (hours)
+#define BATCH_PREDICT_DEFAULT_HOURS 24.0
+
+/**
+ * Output format.
+ **/
+enum batch_predict_format {
+	///Comma-separated values, with header line
+	BATCH_PREDICT_FORMAT_CSV,
+	///JSON array of pass objects
+	BATCH_PREDICT_FORMAT_JSON
+};
+
+/**
+ * Options for headless pass prediction.
+ **/
+struct batch_predict_options {
+	///Satellites to predict, given as satellite numbers or names. All enabled satellites in the TLE database are predicted when empty
+	string_array_t satellites;
+	///Start of prediction time window
+	predict_julian_date_t start_time;
+	///End of prediction time window
+	predict_julian_date_t end_time;
+	///Passes with lower maximum elevation are left out (radians)
+	double min_elevation;
+	///Output format
+	enum batch_predict_format format;
+	///Tabulation of each pass. Only the pass summary is written for PASS_TABULATION_EVENTS
+	enum pass_tabulation_mode tabulation_mode;
+	///Distance between tabulated rows, see pass_tabulation_start()
+	double tabulation_step;
+};
+
+/**
+ * Parse UTC time given on the command line, as YYYY-MM-DD, YYYY-MM-DDTHH:MM:SS or YYYY-MM-DD HH:MM:SS.
+ *
+ * \param string Input string
+ * \param ret_time Returned time
+ * \return 0 on success, -1 if the string could not be parsed
+ **/
+int batch_predict_parse_time(const char *string, predict_julian_date_t *ret_time);
+
+/**
+ * Parse output format given on the command line.
+ *
+ * \param string Input string, "csv" or "json"
+ * \param ret_format Returned format
+ * \return 0 on success, -1 if the format is unknown
+ **/
+int batch_predict_parse_format(const char *string, enum batch_predict_format *ret_format);
+
+/**
+ * Resolve the satellite selection in the options to indices in the TLE database.
+ *
+ * \param options Prediction options
+ * \param tle_db TLE database
+ * \param ret_tle_indices Returned array of TLE database indices, to be freed by the caller
+ * \return Number of selected satellites, -1 if a selected satellite could not be found in the TLE database
+ **/
+int batch_predict_select_satellites(const struct batch_predict_options *options, const struct tle_db *tle_db, int **ret_tle_indices);
+
+/**
+ * Predict passes of the selected satellites and write them to the output sink. Satellites are predicted in
+ * parallel, and the passes of all satellites are written in order of AOS.
+ *
+ * \param options Prediction options
+ * \param observer Ground station
+ * \param tle_db TLE database
+ * \param output Output sink
+ * \return 0 on success, -1 if a selected satellite could not be found in the TLE database or the prediction failed
+ **/
+int batch_predict_run(const struct batch_predict_options *options, const predict_observer_t *observer, const struct tle_db *tle_db, output_sink_t *output);
+
+#endif
@@ -3,6 +3,6 @@
 
 #define MAX_NUM_CHARS		1024
 #define MAX_NUM_TRANSPONDERS	10
-#define MAX_NUM_SATS		250
+#define MAX_TRANSPONDER_NAME_LENGTH	80
 
 #endif
@@ -0,0 +1,91 @@
+#include "ephemeris_cache.h"
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+//number of seconds per day
+#define EPHEMERIS_CACHE_SECONDS_PER_DAY 86400.0
+
+ephemeris_cache_t *ephemeris_cache_create(const predict_orbital_elements_t *orbital_elements, double step)
+{
+	ephemeris_cache_t *cache = (ephemeris_cache_t*)malloc(sizeof(ephemeris_cache_t));
+	cache->orbital_elements = orbital_elements;
+	cache->step = step/EPHEMERIS_CACHE_SECONDS_PER_DAY;
+	for (int i=0; i < EPHEMERIS_CACHE_NUM_SAMPLES; i++) {
+		cache->samples[i].grid_index = -1;
+	}
+	return cache;
+}
+
+void ephemeris_cache_destroy(ephemeris_cache_t **cache)
+{
+	free(*cache);
+	*cache = NULL;
+}
+
+/**
+ * Get sample at grid point, propagating the orbit if the sample is not in the cache.
+ *
+ * \param cache Ephemeris cache
+ * \param grid_index Grid point
+ * \return Sample
+ **/
+const struct ephemeris_cache_sample *ephemeris_cache_sample(ephemeris_cache_t *cache, long grid_index)
+{
+	struct ephemeris_cache_sample *sample = &(cache->samples[grid_index % EPHEMERIS_CACHE_NUM_SAMPLES]);
+	if (sample->grid_index != grid_index) {
+		struct predict_orbit orbit;
+		predict_orbit(cache->orbital_elements, &orbit, grid_index*cache->step);
+		memcpy(sample->position, orbit.position, sizeof(double)*3);
+		memcpy(sample->velocity, orbit.velocity, sizeof(double)*3);
+		sample->decayed = orbit.decayed;
+		sample->grid_index = grid_index;
+	}
+	return sample;
+}
+
+int ephemeris_cache_state(ephemeris_cache_t *cache, predict_julian_date_t time, double ret_position[3], double ret_velocity[3])
+{
+	long grid_index = floor(time/cache->step);
+	const struct ephemeris_cache_sample *start = ephemeris_cache_sample(cache, grid_index);
+	const struct ephemeris_cache_sample *end = ephemeris_cache_sample(cache, grid_index+1);
+	if (start->decayed || end->decayed) {
+		return -1;
+	}
+
+	//Hermite basis functions and their derivatives at normalized time s within the interval
+	double h = cache->step*EPHEMERIS_CACHE_SECONDS_PER_DAY;
+	double s = time/cache->step - grid_index;
+	double s2 = s*s;
+	double s3 = s2*s;
+	double h00 = 2*s3 - 3*s2 + 1;
+	double h10 = s3 - 2*s2 + s;
+	double h01 = -2*s3 + 3*s2;
+	double h11 = s3 - s2;
+	double dh00 = 6*s2 - 6*s;
+	double dh10 = 3*s2 - 4*s + 1;
+	double dh01 = -6*s2 + 6*s;
+	double dh11 = 3*s2 - 2*s;
+
+	for (int i=0; i < 3; i++) {
+		ret_position[i] = h00*start->position[i] + h10*h*start->velocity[i] + h01*end->position[i] + h11*h*end->velocity[i];
+		ret_velocity[i] = (dh00*start->position[i] + dh01*end->position[i])/h + dh10*start->velocity[i] + dh11*end->velocity[i];
+	}
+	return 0;
+}
+
+int ephemeris_cache_observe(ephemeris_cache_t *cache, const predict_observer_t *observer, predict_julian_date_t time, struct predict_observation *ret_observation)
+{
+	struct predict_orbit orbit;
+	memset(&orbit, 0, sizeof(struct predict_orbit));
+	if (ephemeris_cache_state(cache, time, orbit.position, orbit.velocity) != 0) {
+		return -1;
+	}
+	orbit.time = time;
+
+	//satellite is never considered visible, since the eclipse state is not interpolated
+	orbit.eclipsed = true;
+	predict_observe_orbit(observer, &orbit, ret_observation);
+	ret_observation->visible = false;
+	return 0;
+}
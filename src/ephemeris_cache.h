@@ -0,0 +1,94 @@
+#ifndef EPHEMERIS_CACHE_H_DEFINED
+#define EPHEMERIS_CACHE_H_DEFINED
+
+#include <predict/predict.h>
+#include <stdbool.h>
+
+/**
+ * Ephemeris cache. The ECI position and velocity of a satellite are sampled from predict_orbit() on a fixed time grid,
+ * and queries in between are answered by cubic Hermite interpolation between the two surrounding samples. Samples
+ * are kept in a direct-mapped table indexed by grid point, so that the cache slides along with the queries and
+ * repeated queries around the same time reuse the same samples.
+ *
+ * Error bound: Cubic Hermite interpolation using position and velocity has a position error of at most
+ * h^4/384 * max|d^4r/dt^4| over the interval, and a velocity error of at most sqrt(3)/216 * h^3 * max|d^4r/dt^4|,
+ * where h is the sampling step. For an orbit with radius r and mean motion n, |d^4r/dt^4| is about r*n^4. With the
+ * default step of 60 seconds, this gives a position error below 0.5 m and a velocity error below 3 cm/s for circular
+ * low earth orbits, and below 2 m and 10 cm/s for eccentric orbits with perigee above 300 km. This is far below the accuracy of
+ * the SGP4/SDP4 models themselves, but the cache should not be used where the exact propagation result is expected.
+ *
+ * An ephemeris cache is not thread-safe, and should only be used from one thread at a time.
+ **/
+
+//default sampling step (seconds)
+#define EPHEMERIS_CACHE_DEFAULT_STEP 60.0
+
+//number of samples kept in the cache, i.e. a window of about four hours at the default step
+#define EPHEMERIS_CACHE_NUM_SAMPLES 256
+
+/**
+ * Sample of satellite state at grid point.
+ **/
+struct ephemeris_cache_sample {
+	///Grid point of sample, -1 if not calculated
+	long grid_index;
+	///ECI position (km)
+	double position[3];
+	///ECI velocity (km/s)
+	double velocity[3];
+	///Whether satellite has decayed at the sample time
+	bool decayed;
+};
+
+/**
+ * Ephemeris cache of a single satellite.
+ **/
+typedef struct {
+	///Orbital elements. Not owned by the cache
+	const predict_orbital_elements_t *orbital_elements;
+	///Sampling step (days)
+	double step;
+	///Samples, at slot grid_index % EPHEMERIS_CACHE_NUM_SAMPLES
+	struct ephemeris_cache_sample samples[EPHEMERIS_CACHE_NUM_SAMPLES];
+} ephemeris_cache_t;
+
+/**
+ * Create ephemeris cache.
+ *
+ * \param orbital_elements Orbital elements. Has to outlive the cache
+ * \param step Sampling step (seconds), see EPHEMERIS_CACHE_DEFAULT_STEP
+ * \return Ephemeris cache
+ **/
+ephemeris_cache_t *ephemeris_cache_create(const predict_orbital_elements_t *orbital_elements, double step);
+
+/**
+ * Destroy ephemeris cache.
+ *
+ * \param cache Ephemeris cache, set to NULL
+ **/
+void ephemeris_cache_destroy(ephemeris_cache_t **cache);
+
+/**
+ * Get interpolated ECI position and velocity of satellite.
+ *
+ * \param cache Ephemeris cache
+ * \param time Time
+ * \param ret_position Returned ECI position (km)
+ * \param ret_velocity Returned ECI velocity (km/s)
+ * \return 0 on success, -1 if the satellite has decayed within the sampling interval around the given time
+ **/
+int ephemeris_cache_state(ephemeris_cache_t *cache, predict_julian_date_t time, double ret_position[3], double ret_velocity[3]);
+
+/**
+ * Observe satellite from ground station using the interpolated ECI state. Azimuth, elevation, range and
+ * their rates are calculated. Visibility is not, and is always returned as false.
+ *
+ * \param cache Ephemeris cache
+ * \param observer Ground station
+ * \param time Time
+ * \param ret_observation Returned observation
+ * \return 0 on success, -1 if the satellite has decayed within the sampling interval around the given time
+ **/
+int ephemeris_cache_observe(ephemeris_cache_t *cache, const predict_observer_t *observer, predict_julian_date_t time, struct predict_observation *ret_observation);
+
+#endif
@@ -0,0 +1,142 @@
+#include "event_loop.h"
+#include <stdlib.h>
+#include <stdint.h>
+#include <math.h>
+#include <errno.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/timerfd.h>
+
+event_loop_t *event_loop_create()
+{
+	event_loop_t *loop = (event_loop_t*)calloc(1, sizeof(event_loop_t));
+	return loop;
+}
+
+void event_loop_destroy(event_loop_t **loop)
+{
+	if (*loop == NULL) {
+		return;
+	}
+	for (int i=0; i < (*loop)->num_sources; i++) {
+		if ((*loop)->sources[i].is_timer) {
+			close((*loop)->sources[i].fd);
+		}
+	}
+	free(*loop);
+	*loop = NULL;
+}
+
+/**
+ * Add source to event loop.
+ *
+ * \param loop Event loop
+ * \param fd File descriptor to poll
+ * \param is_timer Whether the file descriptor is a timerfd
+ * \return Source ID, -1 if the maximum number of sources has been reached
+ **/
+int event_loop_add_source(event_loop_t *loop, int fd, bool is_timer)
+{
+	if (loop->num_sources >= EVENT_LOOP_MAX_SOURCES) {
+		return -1;
+	}
+	int source = loop->num_sources;
+	loop->sources[source].fd = fd;
+	loop->sources[source].is_timer = is_timer;
+	loop->sources[source].ready = false;
+	loop->pollfds[source].fd = fd;
+	loop->pollfds[source].events = POLLIN;
+	loop->pollfds[source].revents = 0;
+	loop->num_sources++;
+	return source;
+}
+
+int event_loop_add_fd(event_loop_t *loop, int fd)
+{
+	return event_loop_add_source(loop, fd, false);
+}
+
+/**
+ * Convert time in seconds to timespec.
+ *
+ * \param time Time (seconds)
+ * \param ret_timespec Returned timespec
+ **/
+void event_loop_to_timespec(double time, struct timespec *ret_timespec)
+{
+	double seconds = floor(time);
+	ret_timespec->tv_sec = (time_t)seconds;
+	ret_timespec->tv_nsec = (long)((time - seconds)*1.0e09);
+	if (ret_timespec->tv_nsec >= 1000000000L) {
+		ret_timespec->tv_sec++;
+		ret_timespec->tv_nsec -= 1000000000L;
+	}
+}
+
+int event_loop_add_timer(event_loop_t *loop, double interval)
+{
+	if ((interval <= 0) || (loop->num_sources >= EVENT_LOOP_MAX_SOURCES)) {
+		return -1;
+	}
+
+	//monotonic clock, so that the timer keeps running when the wall clock is stepped backwards
+	int fd = timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC);
+	if (fd < 0) {
+		return -1;
+	}
+
+	//first expiration at the next whole multiple of the interval in wall-clock time, later expirations follow at the interval
+	struct timespec now;
+	clock_gettime(CLOCK_REALTIME, &now);
+	double wall_time = now.tv_sec + now.tv_nsec*1.0e-09;
+	double delay = (floor(wall_time/interval) + 1.0)*interval - wall_time;
+	clock_gettime(CLOCK_MONOTONIC, &now);
+	double monotonic_time = now.tv_sec + now.tv_nsec*1.0e-09;
+	struct itimerspec timer_spec;
+	event_loop_to_timespec(monotonic_time + delay, &(timer_spec.it_value));
+	event_loop_to_timespec(interval, &(timer_spec.it_interval));
+	if (timerfd_settime(fd, TFD_TIMER_ABSTIME, &timer_spec, NULL) != 0) {
+		close(fd);
+		return -1;
+	}
+
+	return event_loop_add_source(loop, fd, true);
+}
+
+int event_loop_wait(event_loop_t *loop)
+{
+	int num_ready = poll(loop->pollfds, loop->num_sources, -1);
+	if (num_ready < 0) {
+		//interrupted by a signal (e.g. terminal resize), which the caller handles like any other wakeup
+		for (int i=0; i < loop->num_sources; i++) {
+			loop->sources[i].ready = false;
+		}
+		return (errno == EINTR) ? 0 : -1;
+	}
+
+	for (int i=0; i < loop->num_sources; i++) {
+		loop->sources[i].ready = (loop->pollfds[i].revents != 0);
+		if (!(loop->sources[i].ready)) {
+			continue;
+		}
+
+		//consume expirations, otherwise the timerfd stays readable
+		if (loop->sources[i].is_timer) {
+			uint64_t num_expirations;
+			if (read(loop->sources[i].fd, &num_expirations, sizeof(num_expirations)) != sizeof(num_expirations)) {
+				loop->sources[i].ready = false;
+			}
+		}
+	}
+	return 0;
+}
+
+bool event_loop_ready(event_loop_t *loop, int source)
+{
+	if ((source < 0) || (source >= loop->num_sources)) {
+		return false;
+	}
+	bool ready = loop->sources[source].ready;
+	loop->sources[source].ready = false;
+	return ready;
+}
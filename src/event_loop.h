@@ -0,0 +1,98 @@
+#ifndef EVENT_LOOP_H_DEFINED
+#define EVENT_LOOP_H_DEFINED
+
+#include <stdbool.h>
+#include <poll.h>
+
+/**
+ * Event loop for the interactive screens. Multiplexes file descriptors (the keyboard, sockets) and periodic
+ * timers (implemented using timerfd) in a single poll(), so that the screens sleep until either input arrives
+ * or a data source is due for an update. Each data source gets its own timer, making its update cadence explicit.
+ *
+ * The typical usage is to wait using event_loop_wait(), and then check which sources are ready using
+ * event_loop_ready().
+ **/
+
+//maximum number of sources in an event loop
+#define EVENT_LOOP_MAX_SOURCES 16
+
+/**
+ * Source of events.
+ **/
+struct event_loop_source {
+	///File descriptor polled for the source. Owned by the event loop for timers
+	int fd;
+	///Whether the source is a timer
+	bool is_timer;
+	///Whether the source became ready during the last wait, and has not been checked since
+	bool ready;
+};
+
+/**
+ * Event loop.
+ **/
+typedef struct {
+	///Number of sources
+	int num_sources;
+	///Sources
+	struct event_loop_source sources[EVENT_LOOP_MAX_SOURCES];
+	///Poll entries, one per source
+	struct pollfd pollfds[EVENT_LOOP_MAX_SOURCES];
+} event_loop_t;
+
+/**
+ * Create event loop without any sources.
+ *
+ * \return Event loop
+ **/
+event_loop_t *event_loop_create();
+
+/**
+ * Close timers and free event loop. File descriptors added using event_loop_add_fd() are not closed.
+ *
+ * \param loop Event loop
+ **/
+void event_loop_destroy(event_loop_t **loop);
+
+/**
+ * Add file descriptor to the event loop. The source becomes ready when the file descriptor is readable,
+ * or on hangup and errors.
+ *
+ * \param loop Event loop
+ * \param fd File descriptor
+ * \return Source ID, -1 on failure
+ **/
+int event_loop_add_fd(event_loop_t *loop, int fd);
+
+/**
+ * Add periodic timer to the event loop. Expirations are aligned to whole multiples of the interval in
+ * wall-clock time, so that e.g. a timer with an interval of one second fires as the displayed clock ticks.
+ * The alignment is calculated once, when the timer is added. The timer itself runs on the monotonic clock and
+ * keeps firing at the interval when the wall clock is adjusted.
+ *
+ * \param loop Event loop
+ * \param interval Interval between expirations (seconds)
+ * \return Source ID, -1 on failure
+ **/
+int event_loop_add_timer(event_loop_t *loop, double interval);
+
+/**
+ * Block until at least one source is ready. Sources that became ready are flagged, replacing the flags
+ * of the previous wait, and expirations of timers are consumed.
+ *
+ * \param loop Event loop
+ * \return 0 on success, -1 on failure
+ **/
+int event_loop_wait(event_loop_t *loop);
+
+/**
+ * Check whether a source became ready during the last wait. Clears the flag, so that the event is only
+ * handled once, even when the caller checks again without waiting in between.
+ *
+ * \param loop Event loop
+ * \param source Source ID
+ * \return True if ready
+ **/
+bool event_loop_ready(event_loop_t *loop, int source);
+
+#endif
@@ -2,75 +2,251 @@
 #include <string.h>
 #include <stdlib.h>
 #include <stdio.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
 #include <unistd.h>
 #include <sys/types.h>
+#include <sys/uio.h>
 #include <sys/socket.h>
 #include <netinet/in.h>
 #include <netdb.h>
 
 void bailout(const char *msg);
 
-int sock_readline(int sockd, char *message, size_t bufsize)
+/**
+ * Receive available data into the free space of the receive buffer, without blocking.
+ * Reads as much as is available and fits in a single system call.
+ *
+ * \param connection Connection
+ * \return Number of characters received, 0 if no data is available, -1 on errors or when the connection has been closed
+ **/
+int sock_receive(hamlib_connection_t *connection)
 {
-	int len=0, pos=0;
-	char c='\0';
+	int end = (connection->receive_start + connection->receive_length) % HAMLIB_RECEIVE_BUFFER_SIZE;
+	int free_space = HAMLIB_RECEIVE_BUFFER_SIZE - connection->receive_length;
+	if (free_space == 0) {
+		return 0;
+	}
+
+	//free space wraps around the end of the buffer
+	struct iovec segments[2];
+	int num_segments = 1;
+	segments[0].iov_base = connection->receive_buffer + end;
+	segments[0].iov_len = free_space;
+	if (end + free_space > HAMLIB_RECEIVE_BUFFER_SIZE) {
+		segments[0].iov_len = HAMLIB_RECEIVE_BUFFER_SIZE - end;
+		segments[1].iov_base = connection->receive_buffer;
+		segments[1].iov_len = free_space - segments[0].iov_len;
+		num_segments = 2;
+	}
 
-	if (message!=NULL) {
-		message[bufsize-1]='\0';
+	int len = readv(connection->socket, segments, num_segments);
+	if (len < 0) {
+		return ((errno == EAGAIN) || (errno == EWOULDBLOCK) || (errno == EINTR)) ? 0 : -1;
+	} else if (len == 0) {
+		return -1;
 	}
+	connection->receive_length += len;
+	return len;
+}
 
-	do {
-		if ((len=recv(sockd, &c, 1, 0)) < 0) {
-			return len;
+/**
+ * Split next reply line from the received data, receiving more data from the socket when no complete line
+ * has been received yet. Does not block. Lines longer than the receive buffer are cut.
+ *
+ * \param connection Connection
+ * \return 1 if a complete line is available in connection->line, 0 if no complete line is available, -1 on errors or when the connection has been closed
+ **/
+int sock_readline(hamlib_connection_t *connection)
+{
+	int scanned = 0;
+	while (true) {
+		//look for the end of the line in the data received so far
+		int line_length = -1;
+		for (int i=scanned; i < connection->receive_length; i++) {
+			if (connection->receive_buffer[(connection->receive_start + i) % HAMLIB_RECEIVE_BUFFER_SIZE] == '\n') {
+				line_length = i;
+				break;
+			}
 		}
-		if (message!=NULL) {
-			message[pos]=c;
-			message[pos+1]='\0';
+		scanned = connection->receive_length;
+		if ((line_length < 0) && (connection->receive_length == HAMLIB_RECEIVE_BUFFER_SIZE)) {
+			line_length = HAMLIB_RECEIVE_BUFFER_SIZE;
 		}
-		pos+=len;
-	} while (c!='\n' && pos<bufsize-2);
 
-	return pos;
+		if (line_length >= 0) {
+			int copy_length = (line_length < MAX_NUM_CHARS-1) ? line_length : MAX_NUM_CHARS-1;
+			for (int i=0; i < copy_length; i++) {
+				connection->line[i] = connection->receive_buffer[(connection->receive_start + i) % HAMLIB_RECEIVE_BUFFER_SIZE];
+			}
+			connection->line[copy_length] = '\0';
+
+			//consume line along with its newline
+			int consumed = (line_length < connection->receive_length) ? line_length + 1 : line_length;
+			connection->receive_start = (connection->receive_start + consumed) % HAMLIB_RECEIVE_BUFFER_SIZE;
+			connection->receive_length -= consumed;
+			return 1;
+		}
+
+		int retval = sock_receive(connection);
+		if (retval <= 0) {
+			return retval;
+		}
+	}
 }
 
-void rotctld_connect(const char *rotctld_host, const char *rotctld_port, int update_interval, double tracking_horizon, rotctld_info_t *ret_info)
+/**
+ * Connect to rotctld/rigctld and put the socket in non-blocking mode.
+ *
+ * \param host Hostname/IP address
+ * \param port Port
+ * \param ret_connection Returned connection
+ * \return 0 on success, -1 on failure
+ **/
+int hamlib_connection_open(const char *host, const char *port, hamlib_connection_t *ret_connection)
 {
 	struct addrinfo hints, *servinfo, *servinfop;
 	memset(&hints, 0, sizeof(hints));
 	hints.ai_family = AF_UNSPEC;
 	hints.ai_socktype = SOCK_STREAM;
 
-	int rotctld_socket = 0;
-	int retval = getaddrinfo(rotctld_host, rotctld_port, &hints, &servinfo);
+	int hamlib_socket = 0;
+	int retval = getaddrinfo(host, port, &hints, &servinfo);
 	if (retval != 0) {
 		bailout("getaddrinfo error");
 		exit(-1);
 	}
 
 	for(servinfop = servinfo; servinfop != NULL; servinfop = servinfop->ai_next) {
-		if ((rotctld_socket = socket(servinfop->ai_family, servinfop->ai_socktype,
+		if ((hamlib_socket = socket(servinfop->ai_family, servinfop->ai_socktype,
 			servinfop->ai_protocol)) == -1) {
 			continue;
 		}
-		if (connect(rotctld_socket, servinfop->ai_addr, servinfop->ai_addrlen) == -1) {
-			close(rotctld_socket);
+		if (connect(hamlib_socket, servinfop->ai_addr, servinfop->ai_addrlen) == -1) {
+			close(hamlib_socket);
 			continue;
 		}
 
 		break;
 	}
+	freeaddrinfo(servinfo);
 	if (servinfop == NULL) {
+		return -1;
+	}
+
+	fcntl(hamlib_socket, F_SETFL, fcntl(hamlib_socket, F_GETFL, 0) | O_NONBLOCK);
+
+	memset(ret_connection, 0, sizeof(hamlib_connection_t));
+	ret_connection->socket = hamlib_socket;
+	return 0;
+}
+
+/**
+ * Send as much of the pending output as the socket accepts, without blocking.
+ *
+ * \param connection Connection
+ * \return 0 on success, -1 on failure
+ **/
+int hamlib_connection_flush(hamlib_connection_t *connection)
+{
+	while (connection->output_length > 0) {
+		int len = send(connection->socket, connection->output, connection->output_length, MSG_DONTWAIT | MSG_NOSIGNAL);
+		if (len < 0) {
+			return ((errno == EAGAIN) || (errno == EWOULDBLOCK) || (errno == EINTR)) ? 0 : -1;
+		}
+		memmove(connection->output, connection->output + len, connection->output_length - len);
+		connection->output_length -= len;
+	}
+	return 0;
+}
+
+/**
+ * Send command and register it for matching against its reply.
+ *
+ * \param connection Connection
+ * \param command Command type
+ * \param message Command string, terminated by a newline
+ * \return 0 on success, -1 on failure
+ **/
+int hamlib_connection_send(hamlib_connection_t *connection, enum hamlib_command command, const char *message)
+{
+	int len = strlen(message);
+	if ((connection->num_pending >= HAMLIB_MAX_PENDING_COMMANDS) || (connection->output_length + len > HAMLIB_OUTPUT_BUFFER_SIZE)) {
+		return -1;
+	}
+	memcpy(connection->output + connection->output_length, message, len);
+	connection->output_length += len;
+
+	connection->pending[(connection->pending_start + connection->num_pending) % HAMLIB_MAX_PENDING_COMMANDS] = command;
+	connection->num_pending++;
+	return hamlib_connection_flush(connection);
+}
+
+/**
+ * Check whether a command of the given type is awaiting its reply.
+ *
+ * \param connection Connection
+ * \param command Command type
+ * \return True if a command of the given type has been sent and not yet replied to
+ **/
+bool hamlib_connection_pending(const hamlib_connection_t *connection, enum hamlib_command command)
+{
+	for (int i=0; i < connection->num_pending; i++) {
+		if (connection->pending[(connection->pending_start + i) % HAMLIB_MAX_PENDING_COMMANDS] == command) {
+			return true;
+		}
+	}
+	return false;
+}
+
+/**
+ * Receive next reply, and match it to the oldest command awaiting a reply.
+ *
+ * \param connection Connection
+ * \param ret_command Returned command the reply belongs to
+ * \return 1 if a reply is available in connection->line, 0 if no complete reply is available, -1 on failure
+ **/
+int hamlib_connection_receive(hamlib_connection_t *connection, enum hamlib_command *ret_command)
+{
+	//unsolicited lines are skipped
+	int retval;
+	while ((retval = sock_readline(connection)) == 1) {
+		if (connection->num_pending > 0) {
+			break;
+		}
+	}
+	if (retval != 1) {
+		return retval;
+	}
+
+	*ret_command = connection->pending[connection->pending_start];
+	connection->pending_start = (connection->pending_start + 1) % HAMLIB_MAX_PENDING_COMMANDS;
+	connection->num_pending--;
+	return 1;
+}
+
+/**
+ * Disconnect from rotctld/rigctld.
+ *
+ * \param connection Connection
+ **/
+void hamlib_connection_close(hamlib_connection_t *connection)
+{
+	hamlib_connection_flush(connection);
+	send(connection->socket, "q\n", 2, MSG_DONTWAIT | MSG_NOSIGNAL);
+	close(connection->socket);
+}
+
+void rotctld_connect(const char *rotctld_host, const char *rotctld_port, int update_interval, double tracking_horizon, rotctld_info_t *ret_info)
+{
+	if (hamlib_connection_open(rotctld_host, rotctld_port, &(ret_info->connection)) != 0) {
 		bailout("Unable to connect to rotctld");
 		exit(-1);
 	}
-	freeaddrinfo(servinfo);
-	/* TrackDataNet() will wait for confirmation of a command before sending
-	   the next so we bootstrap this by asking for the current position */
-	send(rotctld_socket, "p\n", 2, 0);
-	sock_readline(rotctld_socket, NULL, 256);
 
-	ret_info->socket = rotctld_socket;
 	ret_info->connected = true;
+	ret_info->position_queued = false;
 	strncpy(ret_info->host, rotctld_host, MAX_NUM_CHARS);
 	strncpy(ret_info->port, rotctld_port, MAX_NUM_CHARS);
 	ret_info->tracking_horizon = tracking_horizon;
@@ -81,138 +257,175 @@ void rotctld_connect(const char *rotctld_host, const char *rotctld_port, int upd
 	ret_info->update_time_interval = update_interval;
 }
 
-void rotctld_track(const rotctld_info_t *info, double azimuth, double elevation)
+void rotctld_process(rotctld_info_t *info)
 {
-	char message[30];
+	enum hamlib_command command;
+	int retval;
+	while ((retval = hamlib_connection_receive(&(info->connection), &command)) == 1) {
+		//replies only confirm positions, which just allows the next position to be sent
+	}
+	if (retval < 0) {
+		bailout("Lost connection to rotctld");
+		exit(-1);
+	}
 
 	/* If positions are sent too often, rotctld will queue
-	   them and the antenna will lag behind. Therefore, we wait
-	   for confirmation from last command before sending the
-	   next. */
-	sock_readline(info->socket, message, sizeof(message));
+	   them and the antenna will lag behind. Therefore, only
+	   the latest position is sent after the last one has
+	   been confirmed. */
+	if (info->position_queued && !hamlib_connection_pending(&(info->connection), HAMLIB_COMMAND_SET_POSITION)) {
+		char message[MAX_NUM_CHARS];
+		sprintf(message, "P %.2f %.2f\n", info->queued_azimuth, info->queued_elevation);
+		if (hamlib_connection_send(&(info->connection), HAMLIB_COMMAND_SET_POSITION, message) != 0) {
+			bailout("Failed to send to rotctld");
+			exit(-1);
+		}
+		info->position_queued = false;
+	}
 
-	sprintf(message, "P %.2f %.2f\n", azimuth, elevation);
-	int len = strlen(message);
-	if (send(info->socket, message, len, 0) != len) {
+	if (hamlib_connection_flush(&(info->connection)) != 0) {
 		bailout("Failed to send to rotctld");
 		exit(-1);
 	}
 }
 
+void rotctld_track(rotctld_info_t *info, double azimuth, double elevation)
+{
+	info->queued_azimuth = azimuth;
+	info->queued_elevation = elevation;
+	info->position_queued = true;
+	rotctld_process(info);
+}
+
 void rigctld_connect(const char *rigctld_host, const char *rigctld_port, const char *vfo_name, rigctld_info_t *ret_info)
 {
-	struct addrinfo hints, *servinfo, *servinfop;
-	memset(&hints, 0, sizeof(hints));
-	hints.ai_family = AF_UNSPEC;
-	hints.ai_socktype = SOCK_STREAM;
-	int rigctld_socket = 0;
-	int retval = getaddrinfo(rigctld_host, rigctld_port, &hints, &servinfo);
-	if (retval != 0) {
-		bailout("getaddrinfo error");
+	if (strlen(vfo_name) > RIGCTLD_MAX_VFO_NAME_LENGTH) {
+		bailout("rigctld VFO name is too long");
 		exit(-1);
 	}
 
-	for(servinfop = servinfo; servinfop != NULL; servinfop = servinfop->ai_next) {
-		if ((rigctld_socket = socket(servinfop->ai_family, servinfop->ai_socktype,
-			servinfop->ai_protocol)) == -1) {
-			continue;
-		}
-		if (connect(rigctld_socket, servinfop->ai_addr, servinfop->ai_addrlen) == -1) {
-			close(rigctld_socket);
-			continue;
-		}
-
-		break;
-	}
-	if (servinfop == NULL) {
+	if (hamlib_connection_open(rigctld_host, rigctld_port, &(ret_info->connection)) != 0) {
 		bailout("Unable to connect to uplink rigctld");
 		exit(-1);
 	}
-	freeaddrinfo(servinfo);
-	/* FreqDataNet() will wait for confirmation of a command before sending
-	   the next so we bootstrap this by asking for the current frequency */
-	send(rigctld_socket, "f\n", 2, 0);
 
-	ret_info->socket = rigctld_socket;
-	strncpy(ret_info->vfo_name, vfo_name, MAX_NUM_CHARS);
+	strncpy(ret_info->vfo_name, vfo_name, RIGCTLD_MAX_VFO_NAME_LENGTH);
+	ret_info->vfo_name[RIGCTLD_MAX_VFO_NAME_LENGTH] = '\0';
 	ret_info->connected = true;
+	ret_info->frequency_queued = false;
+	ret_info->read_queued = false;
+	ret_info->frequency_read = false;
+	ret_info->read_frequency = 0;
 }
 
-void rigctld_set_frequency(const rigctld_info_t *info, double frequency)
+/**
+ * Send command to rigctld, preceded by VFO selection when a VFO has been specified.
+ * VFO selection and command are pipelined, and their replies matched in order.
+ *
+ * \param info rigctld connection instance
+ * \param command Command type
+ * \param message Command string, terminated by a newline
+ **/
+void rigctld_send(rigctld_info_t *info, enum hamlib_command command, const char *message)
 {
-	char message[256];
-	int len;
-
-	/* If frequencies is sent too often, rigctld will queue
-	   them and the radio will lag behind. Therefore, we wait
-	   for confirmation from last command before sending the
-	   next. */
-	sock_readline(info->socket, message, sizeof(message));
-
-	if (strlen(info->vfo_name) > 0)	{
-		sprintf(message, "V %s\n", info->vfo_name);
-		len = strlen(message);
-		usleep(100); // hack: avoid VFO selection racing
-		if (send(info->socket, message, len, 0) != len)	{
+	if (strlen(info->vfo_name) > 0) {
+		//"V ", VFO name, newline and terminator
+		char vfo_message[RIGCTLD_MAX_VFO_NAME_LENGTH+4];
+		snprintf(vfo_message, sizeof(vfo_message), "V %s\n", info->vfo_name);
+		if (hamlib_connection_send(&(info->connection), HAMLIB_COMMAND_SET_VFO, vfo_message) != 0) {
 			bailout("Failed to send to rigctld");
 			exit(-1);
 		}
-		sock_readline(info->socket, message, sizeof(message));
 	}
 
-	sprintf(message, "F %.0f\n", frequency*1000000);
-	len = strlen(message);
-	if (send(info->socket, message, len, 0) != len)	{
+	if (hamlib_connection_send(&(info->connection), command, message) != 0) {
 		bailout("Failed to send to rigctld");
 		exit(-1);
 	}
 }
 
-double rigctld_read_frequency(const rigctld_info_t *info)
+void rigctld_process(rigctld_info_t *info)
 {
-	char message[256];
-	int len;
-	double freq;
+	enum hamlib_command command;
+	int retval;
+	while ((retval = hamlib_connection_receive(&(info->connection), &command)) == 1) {
+		//error replies to frequency reads are ignored, as are confirmations of other commands
+		if ((command == HAMLIB_COMMAND_GET_FREQUENCY) && (strncmp(info->connection.line, "RPRT", 4) != 0)) {
+			info->read_frequency = atof(info->connection.line)/1.0e6;
+			info->frequency_read = true;
+		}
+	}
+	if (retval < 0) {
+		bailout("Lost connection to rigctld");
+		exit(-1);
+	}
 
-	/* Read pending return message */
-	sock_readline(info->socket, message, sizeof(message));
+	/* If frequencies are sent too often, rigctld will queue
+	   them and the radio will lag behind. Therefore, only
+	   the latest frequency is sent after the last one has
+	   been confirmed. */
+	if (info->frequency_queued && !hamlib_connection_pending(&(info->connection), HAMLIB_COMMAND_SET_FREQUENCY)) {
+		char message[MAX_NUM_CHARS];
+		sprintf(message, "F %.0f\n", info->queued_frequency*1000000);
+		rigctld_send(info, HAMLIB_COMMAND_SET_FREQUENCY, message);
+		info->frequency_queued = false;
+	}
 
-	if (strlen(info->vfo_name) > 0)	{
-		sprintf(message, "V %s\n", info->vfo_name);
-		len = strlen(message);
-		usleep(100); // hack: avoid VFO selection racing
-		if (send(info->socket, message, len, 0) != len)	{
-			bailout("Failed to send to rigctld");
-			exit(-1);
-		}
-		sock_readline(info->socket, message, sizeof(message));
+	//a read already awaiting its reply will return the current frequency as well
+	if (info->read_queued && !hamlib_connection_pending(&(info->connection), HAMLIB_COMMAND_GET_FREQUENCY)) {
+		rigctld_send(info, HAMLIB_COMMAND_GET_FREQUENCY, "f\n");
+		info->read_queued = false;
 	}
 
-	sprintf(message, "f\n");
-	len = strlen(message);
-	if (send(info->socket, message, len, 0) != len)	{
+	if (hamlib_connection_flush(&(info->connection)) != 0) {
 		bailout("Failed to send to rigctld");
 		exit(-1);
 	}
+}
+
+void rigctld_set_frequency(rigctld_info_t *info, double frequency)
+{
+	info->queued_frequency = frequency;
+	info->frequency_queued = true;
+	rigctld_process(info);
+}
+
+void rigctld_request_frequency(rigctld_info_t *info)
+{
+	info->read_queued = true;
+	rigctld_process(info);
+}
+
+bool rigctld_frequency_available(rigctld_info_t *info, double *ret_frequency)
+{
+	if (!(info->frequency_read)) {
+		return false;
+	}
+	*ret_frequency = info->read_frequency;
+	info->frequency_read = false;
+	return true;
+}
 
-	sock_readline(info->socket, message, sizeof(message));
-	freq=atof(message)/1.0e6;
+bool rigctld_read_frequency(rigctld_info_t *info, double *ret_frequency)
+{
+	info->frequency_read = false;
+	rigctld_request_frequency(info);
 
-	sprintf(message, "f\n");
-	len = strlen(message);
-	if (send(info->socket, message, len, 0) != len)	{
-		bailout("Failed to send to rigctld");
-		exit(-1);
+	struct pollfd pollfd = {.fd = info->connection.socket, .events = POLLIN};
+	while (!(info->frequency_read) && hamlib_connection_pending(&(info->connection), HAMLIB_COMMAND_GET_FREQUENCY)) {
+		if (poll(&pollfd, 1, RIGCTLD_READ_TIMEOUT) <= 0) {
+			break;
+		}
+		rigctld_process(info);
 	}
 
-	return freq;
+	return rigctld_frequency_available(info, ret_frequency);
 }
 
 void rigctld_disconnect(rigctld_info_t *info)
 {
 	if (info->connected) {
-		send(info->socket, "q\n", 2, 0);
-		close(info->socket);
+		hamlib_connection_close(&(info->connection));
 		info->connected = false;
 	}
 }
@@ -220,8 +433,7 @@ void rigctld_disconnect(rigctld_info_t *info)
 void rotctld_disconnect(rotctld_info_t *info)
 {
 	if (info->connected) {
-		send(info->socket, "q\n", 2, 0);
-		close(info->socket);
+		hamlib_connection_close(&(info->connection));
 		info->connected = false;
 	}
 }
@@ -11,11 +11,74 @@
 #define RIGCTLD_DOWNLINK_DEFAULT_HOST "localhost"
 #define RIGCTLD_DOWNLINK_DEFAULT_PORT "4532\0\0"
 
+//maximum number of commands awaiting a reply on a connection
+#define HAMLIB_MAX_PENDING_COMMANDS 8
+
+//size of output buffer of a connection
+#define HAMLIB_OUTPUT_BUFFER_SIZE 256
+
+//size of receive buffer of a connection
+#define HAMLIB_RECEIVE_BUFFER_SIZE 1024
+
+//maximum time rigctld_read_frequency() waits for the reply (milliseconds)
+#define RIGCTLD_READ_TIMEOUT 1000
+
+//maximum length of VFO name. Hamlib VFO names are short tokens like VFOA, Main or Sub
+#define RIGCTLD_MAX_VFO_NAME_LENGTH 32
+
+/**
+ * Commands sent to rotctld/rigctld. Each command is answered by a single reply line,
+ * either "RPRT <error code>" or the requested value.
+ **/
+enum hamlib_command {
+	///Set rotator position (P)
+	HAMLIB_COMMAND_SET_POSITION,
+	///Select VFO (V)
+	HAMLIB_COMMAND_SET_VFO,
+	///Set frequency (F)
+	HAMLIB_COMMAND_SET_FREQUENCY,
+	///Get frequency (f)
+	HAMLIB_COMMAND_GET_FREQUENCY
+};
+
+/**
+ * Non-blocking connection to rotctld or rigctld. Commands are sent without waiting for the replies to
+ * earlier commands, and replies are matched to the commands in the order the commands were sent.
+ **/
 typedef struct {
-	///Whether we are connected to a rotctld instance
-	bool connected;
 	///Socket file identificator
 	int socket;
+	///Commands awaiting a reply, oldest first (circular buffer)
+	enum hamlib_command pending[HAMLIB_MAX_PENDING_COMMANDS];
+	///Index of oldest command awaiting a reply
+	int pending_start;
+	///Number of commands awaiting a reply
+	int num_pending;
+	///Output not yet accepted by the socket
+	char output[HAMLIB_OUTPUT_BUFFER_SIZE];
+	///Length of output not yet accepted by the socket
+	int output_length;
+	///Received data not yet split into lines (circular buffer)
+	char receive_buffer[HAMLIB_RECEIVE_BUFFER_SIZE];
+	///Index of oldest character in receive buffer
+	int receive_start;
+	///Number of characters in receive buffer
+	int receive_length;
+	///Last reply line split from the received data, without newline
+	char line[MAX_NUM_CHARS];
+} hamlib_connection_t;
+
+typedef struct {
+	///Whether we are connected to a rotctld instance
+	bool connected;
+	///Connection to rotctld
+	hamlib_connection_t connection;
+	///Whether a position is waiting to be sent. Replaced by newer positions until sent
+	bool position_queued;
+	///Azimuth waiting to be sent (degrees)
+	double queued_azimuth;
+	///Elevation waiting to be sent (degrees)
+	double queued_elevation;
 	///Hostname
 	char host[MAX_NUM_CHARS];
 	///Port
@@ -29,10 +92,20 @@ typedef struct {
 typedef struct {
 	///Whether we are connected to a rigctld instance
 	bool connected;
-	///Socket file identificator
-	int socket;
+	///Connection to rigctld
+	hamlib_connection_t connection;
 	///VFO name
-	char vfo_name[MAX_NUM_CHARS];
+	char vfo_name[RIGCTLD_MAX_VFO_NAME_LENGTH+1];
+	///Whether a frequency is waiting to be sent. Replaced by newer frequencies until sent
+	bool frequency_queued;
+	///Frequency waiting to be sent (MHz)
+	double queued_frequency;
+	///Whether a frequency read is waiting to be sent
+	bool read_queued;
+	///Whether a frequency has been read since last checked using rigctld_frequency_available()
+	bool frequency_read;
+	///Last frequency read from rigctld (MHz)
+	double read_frequency;
 } rigctld_info_t;
 
 /**
@@ -53,20 +126,29 @@ void rotctld_connect(const char *hostname, const char *port, int update_interval
 void rotctld_disconnect(rotctld_info_t *info);
 
 /**
- * Send track data to rotctld. 
+ * Send track data to rotctld. Does not block: If the previous position has not yet been confirmed by rotctld,
+ * the position is queued and sent once the confirmation arrives, replacing any position queued earlier.
+ * This way, rotctld never queues up positions and the antenna does not lag behind.
  *
  * \param info rotctld connection instance
  * \param azimuth Azimuth in degrees
  * \param elevation Elevation in degrees
  **/
-void rotctld_track(const rotctld_info_t *info, double azimuth, double elevation);
+void rotctld_track(rotctld_info_t *info, double azimuth, double elevation);
+
+/**
+ * Handle replies from rotctld and send queued commands. Should be called whenever the socket is readable.
+ *
+ * \param info rotctld connection instance
+ **/
+void rotctld_process(rotctld_info_t *info);
 
 /**
  * Connect to rigctld. 
  *
  * \param hostname Hostname/IP address
  * \param port Port
- * \param vfo_name VFO name
+ * \param vfo_name VFO name, at most RIGCTLD_MAX_VFO_NAME_LENGTH characters
  * \param ret_info Returned rigctld connection instance
  **/
 void rigctld_connect(const char *hostname, const char *port, const char *vfo_name, rigctld_info_t *ret_info);
@@ -77,20 +159,46 @@ void rigctld_connect(const char *hostname, const char *port, const char *vfo_nam
  **/
 void rigctld_disconnect(rigctld_info_t *info);
 
-/*
- * Send frequency data to rigctld. 
+/**
+ * Send frequency data to rigctld. Does not block: If the previous frequency has not yet been confirmed by rigctld,
+ * the frequency is queued and sent once the confirmation arrives, replacing any frequency queued earlier.
  *
  * \param info rigctld connection instance
  * \param frequency Frequency in MHz
  **/
-void rigctld_set_frequency(const rigctld_info_t *info, double frequency);
+void rigctld_set_frequency(rigctld_info_t *info, double frequency);
+
+/**
+ * Request the current frequency from rigctld, without waiting for the reply. The frequency
+ * is available using rigctld_frequency_available() once the reply has been handled.
+ *
+ * \param info rigctld connection instance
+ **/
+void rigctld_request_frequency(rigctld_info_t *info);
+
+/**
+ * Get frequency read from rigctld since the last call, if any.
+ *
+ * \param info rigctld connection instance
+ * \param ret_frequency Returned frequency in MHz
+ * \return True if a frequency has been read since the last call
+ **/
+bool rigctld_frequency_available(rigctld_info_t *info, double *ret_frequency);
+
+/**
+ * Read frequency from rigctld, waiting for the reply.
+ *
+ * \param info rigctld connection instance
+ * \param ret_frequency Returned current frequency in MHz. Left untouched if no frequency was read
+ * \return True if the frequency was read, false if rigctld replied with an error or did not reply within RIGCTLD_READ_TIMEOUT
+ **/
+bool rigctld_read_frequency(rigctld_info_t *info, double *ret_frequency);
 
 /**
- * Read frequency from rigctld. 
+ * Handle replies from rigctld and send queued commands. Should be called whenever the socket is readable.
  *
  * \param info rigctld connection instance
- * \return Current frequency in MHz
  **/
-double rigctld_read_frequency(const rigctld_info_t *info);
+void rigctld_process(rigctld_info_t *info);
 
 #endif
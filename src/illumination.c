@@ -0,0 +1,208 @@
+#include "illumination.h"
+#include <stdlib.h>
+#include <math.h>
+#include "solver.h"
+
+//initial number of entries in interval array
+#define ILLUMINATION_INITIAL_SIZE 32
+
+/**
+ * Eclipse depth of satellite at given time.
+ **/
+struct illumination_sample {
+	///Time
+	predict_julian_date_t time;
+	///Eclipse depth (radians), non-negative when the satellite is eclipsed
+	double depth;
+};
+
+/**
+ * Calculate eclipse depth of satellite.
+ *
+ * \param orbital_elements Orbital elements of satellite
+ * \param time Time
+ * \param ret_sample Returned sample
+ * \return 0 on success, -1 if the satellite has decayed
+ **/
+int illumination_sample(const predict_orbital_elements_t *orbital_elements, predict_julian_date_t time, struct illumination_sample *ret_sample)
+{
+	struct predict_orbit orbit;
+	predict_orbit(orbital_elements, &orbit, time);
+	ret_sample->time = time;
+	ret_sample->depth = orbit.eclipse_depth;
+	if (orbit.decayed) {
+		return -1;
+	}
+	return 0;
+}
+
+/**
+ * Eclipse depth of satellite, for the solver.
+ *
+ * \param time Time
+ * \param data Orbital elements of satellite
+ * \return Eclipse depth (radians)
+ **/
+double illumination_depth(predict_julian_date_t time, void *data)
+{
+	struct illumination_sample sample;
+	illumination_sample((const predict_orbital_elements_t*)data, time, &sample);
+	return sample.depth;
+}
+
+/**
+ * Stop the search for the maximum eclipse depth as soon as an eclipsed point is found.
+ *
+ * \param time Time of deepest point found so far
+ * \param depth Eclipse depth at that time
+ * \param interval Length of the interval still searched
+ * \param data Orbital elements of satellite
+ * \return True if the point is eclipsed
+ **/
+bool illumination_stop_when_eclipsed(predict_julian_date_t time, double depth, double interval, void *data)
+{
+	return depth >= 0;
+}
+
+/**
+ * Find time at which the eclipse depth crosses zero between two samples.
+ *
+ * \param orbital_elements Orbital elements of satellite
+ * \param start Sample before the crossing
+ * \param end Sample after the crossing, on the other side of zero
+ * \return Time of crossing
+ **/
+predict_julian_date_t illumination_find_crossing(const predict_orbital_elements_t *orbital_elements, const struct illumination_sample *start, const struct illumination_sample *end)
+{
+	return solver_find_root(illumination_depth, (void*)orbital_elements, start->time, start->depth, end->time, end->depth, ILLUMINATION_TIME_TOLERANCE);
+}
+
+/**
+ * Search for an eclipsed point around a local maximum of the eclipse depth. Stops as soon as an eclipsed point is found.
+ *
+ * \param orbital_elements Orbital elements of satellite
+ * \param start Sample before the maximum, not eclipsed
+ * \param end Sample after the maximum, not eclipsed
+ * \param ret_sample Returned eclipsed sample
+ * \return True if an eclipsed point was found, false if the satellite stays in sunlight between the samples
+ **/
+bool illumination_find_eclipse_peak(const predict_orbital_elements_t *orbital_elements, const struct illumination_sample *start, const struct illumination_sample *end, struct illumination_sample *ret_sample)
+{
+	ret_sample->depth = solver_find_maximum(illumination_depth, illumination_stop_when_eclipsed, (void*)orbital_elements, start->time, end->time, ILLUMINATION_TIME_TOLERANCE, &(ret_sample->time));
+	return ret_sample->depth >= 0;
+}
+
+/**
+ * Add interval to illumination intervals. Reallocates available space to twice the size when current available size is exceeded.
+ *
+ * \param intervals Illumination intervals
+ * \param start Start of interval
+ * \param end End of interval
+ * \param eclipsed Whether the satellite is eclipsed during the interval
+ * \return 0 on success, -1 on failure
+ **/
+int illumination_intervals_add(illumination_intervals_t *intervals, predict_julian_date_t start, predict_julian_date_t end, bool eclipsed)
+{
+	if (intervals->num_intervals >= intervals->available_size) {
+		int available_size = (intervals->available_size > 0) ? intervals->available_size*2 : ILLUMINATION_INITIAL_SIZE;
+		struct illumination_interval *new_intervals = (struct illumination_interval*)realloc(intervals->intervals, sizeof(struct illumination_interval)*available_size);
+		if (new_intervals == NULL) {
+			return -1;
+		}
+		intervals->intervals = new_intervals;
+		intervals->available_size = available_size;
+	}
+	intervals->intervals[intervals->num_intervals].start = start;
+	intervals->intervals[intervals->num_intervals].end = end;
+	intervals->intervals[intervals->num_intervals].eclipsed = eclipsed;
+	intervals->num_intervals++;
+	return 0;
+}
+
+void illumination_intervals_free(illumination_intervals_t *intervals)
+{
+	free(intervals->intervals);
+	intervals->intervals = NULL;
+	intervals->available_size = 0;
+	intervals->num_intervals = 0;
+}
+
+int illumination_find_intervals(const predict_orbital_elements_t *orbital_elements, predict_julian_date_t start_time, predict_julian_date_t end_time, illumination_intervals_t *ret_intervals)
+{
+	ret_intervals->num_intervals = 0;
+
+	double period = 1.0/orbital_elements->mean_motion;
+	int num_steps = ceil((end_time - start_time)/(period/ILLUMINATION_SAMPLES_PER_ORBIT));
+	if (num_steps < 2) {
+		num_steps = 2;
+	}
+	double step = (end_time - start_time)/num_steps;
+
+	struct illumination_sample before_previous, previous, current;
+	if (illumination_sample(orbital_elements, start_time, &previous) != 0) {
+		return -1;
+	}
+
+	//sample before the time range, so that a local maximum between the first two samples also shows up
+	if (illumination_sample(orbital_elements, start_time - step, &before_previous) != 0) {
+		before_previous = previous;
+	}
+
+	bool eclipsed = previous.depth >= 0;
+	predict_julian_date_t interval_start = start_time;
+	for (int i=1; i <= num_steps; i++) {
+		if (illumination_sample(orbital_elements, start_time + i*step, &current) != 0) {
+			illumination_intervals_add(ret_intervals, interval_start, previous.time, eclipsed);
+			return -1;
+		}
+
+		bool current_eclipsed = current.depth >= 0;
+		if (current_eclipsed != eclipsed) {
+			predict_julian_date_t crossing = illumination_find_crossing(orbital_elements, &previous, &current);
+			if (illumination_intervals_add(ret_intervals, interval_start, crossing, eclipsed) != 0) {
+				return -1;
+			}
+			interval_start = crossing;
+			eclipsed = current_eclipsed;
+		} else if (!eclipsed && (previous.depth > before_previous.depth) && (previous.depth > current.depth)) {
+			//eclipse depth peaks below zero at the samples, but the satellite might still be eclipsed briefly in between.
+			//In the first step, the peak is only searched for within the time range
+			const struct illumination_sample *peak_start = (i == 1) ? &previous : &before_previous;
+			struct illumination_sample peak;
+			if (illumination_find_eclipse_peak(orbital_elements, peak_start, &current, &peak)) {
+				predict_julian_date_t entry = illumination_find_crossing(orbital_elements, peak_start, &peak);
+				predict_julian_date_t exit = illumination_find_crossing(orbital_elements, &peak, &current);
+				if ((illumination_intervals_add(ret_intervals, interval_start, entry, false) != 0) || (illumination_intervals_add(ret_intervals, entry, exit, true) != 0)) {
+					return -1;
+				}
+				interval_start = exit;
+			}
+		}
+
+		before_previous = previous;
+		previous = current;
+	}
+	if (illumination_intervals_add(ret_intervals, interval_start, end_time, eclipsed) != 0) {
+		return -1;
+	}
+	return 0;
+}
+
+double illumination_sunlit_fraction(const predict_orbital_elements_t *orbital_elements, predict_julian_date_t start_time, predict_julian_date_t end_time)
+{
+	illumination_intervals_t intervals = {0};
+	if (illumination_find_intervals(orbital_elements, start_time, end_time, &intervals) != 0) {
+		illumination_intervals_free(&intervals);
+		return -1;
+	}
+
+	double sunlit_time = 0;
+	for (int i=0; i < intervals.num_intervals; i++) {
+		if (!(intervals.intervals[i].eclipsed)) {
+			sunlit_time += intervals.intervals[i].end - intervals.intervals[i].start;
+		}
+	}
+	illumination_intervals_free(&intervals);
+
+	return sunlit_time/(end_time - start_time);
+}
@@ -0,0 +1,74 @@
+#ifndef ILLUMINATION_H_DEFINED
+#define ILLUMINATION_H_DEFINED
+
+#include <predict/predict.h>
+#include <stdbool.h>
+
+/**
+ * Solar illumination of a satellite over a time range. Instead of propagating the satellite every minute and
+ * counting eclipsed samples, the eclipse depth from libpredict is sampled at a fraction of the orbital
+ * period, and the times at which it crosses zero (eclipse entry and exit) are found by Brent's method between
+ * the samples. Eclipses too short to show up in the samples are caught by searching for the maximum eclipse depth
+ * wherever the samples have a local maximum.
+ **/
+
+//number of eclipse depth samples per orbital period
+#define ILLUMINATION_SAMPLES_PER_ORBIT 24
+
+//time resolution of eclipse entry and exit times (days, a tenth of a second)
+#define ILLUMINATION_TIME_TOLERANCE (0.1/86400.0)
+
+/**
+ * Time interval during which a satellite is either in sunlight or eclipsed.
+ **/
+struct illumination_interval {
+	///Start of interval, i.e. eclipse entry or exit, or start of the searched time range
+	predict_julian_date_t start;
+	///End of interval, i.e. eclipse entry or exit, or end of the searched time range
+	predict_julian_date_t end;
+	///Whether the satellite is eclipsed during the interval
+	bool eclipsed;
+};
+
+/**
+ * Dynamic size array of illumination intervals.
+ **/
+typedef struct {
+	///Available size within interval array
+	int available_size;
+	///Current number of intervals
+	int num_intervals;
+	///Consecutive intervals, in chronological order
+	struct illumination_interval *intervals;
+} illumination_intervals_t;
+
+/**
+ * Find sunlight and eclipse intervals of satellite over a time range. The intervals alternate between sunlight and
+ * eclipse, and together cover the time range.
+ *
+ * \param orbital_elements Orbital elements of satellite
+ * \param start_time Start of time range
+ * \param end_time End of time range
+ * \param ret_intervals Returned intervals. Previous contents are cleared. Should be initialized to zero before first use, and freed using illumination_intervals_free()
+ * \return 0 on success, -1 if the satellite decays within the time range, in which case the intervals end at the last time before the decay that was checked, or if memory could not be allocated
+ **/
+int illumination_find_intervals(const predict_orbital_elements_t *orbital_elements, predict_julian_date_t start_time, predict_julian_date_t end_time, illumination_intervals_t *ret_intervals);
+
+/**
+ * Free memory allocated in illumination intervals.
+ *
+ * \param intervals Illumination intervals
+ **/
+void illumination_intervals_free(illumination_intervals_t *intervals);
+
+/**
+ * Calculate the fraction of a time range the satellite spends in sunlight.
+ *
+ * \param orbital_elements Orbital elements of satellite
+ * \param start_time Start of time range
+ * \param end_time End of time range
+ * \return Sunlit fraction in [0, 1], -1 if the satellite decays within the time range or memory could not be allocated
+ **/
+double illumination_sunlit_fraction(const predict_orbital_elements_t *orbital_elements, predict_julian_date_t start_time, predict_julian_date_t end_time);
+
+#endif
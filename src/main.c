@@ -2,6 +2,7 @@
 #include <stdlib.h>
 #include <getopt.h>
 #include <string.h>
+#include <time.h>
 #include <stdbool.h>
 #include "defines.h"
 #include "hamlib.h"
@@ -12,6 +13,8 @@
 #include "qth_config.h"
 #include "tle_db.h"
 #include "transponder_db.h"
+#include "batch_predict.h"
+#include "pass_search_benchmark.h"
 
 //longopt value identificators for command line options without shorthand
 #define FLYBY_OPT_ROTCTLD_PORT 201
@@ -20,6 +23,15 @@
 #define FLYBY_OPT_DOWNLINK_PORT 204
 #define FLYBY_OPT_DOWNLINK_VFO 205
 #define FLYBY_OPT_ROTCTLD_UPDATE_INTERVAL 206
+#define FLYBY_OPT_PREDICT 207
+#define FLYBY_OPT_PREDICT_SATELLITE 208
+#define FLYBY_OPT_PREDICT_START 209
+#define FLYBY_OPT_PREDICT_HOURS 210
+#define FLYBY_OPT_PREDICT_MIN_ELEVATION 211
+#define FLYBY_OPT_PREDICT_FORMAT 212
+#define FLYBY_OPT_PREDICT_OUTPUT 213
+#define FLYBY_OPT_BENCHMARK_PASS_SEARCH 214
+#define FLYBY_OPT_PREDICT_STEP 215
 
 /**
  * Print flyby program usage to stdout.
@@ -58,6 +70,18 @@ int main(int argc, char **argv)
 	char qth_filename[MAX_NUM_CHARS] = {0};
 	bool qth_cmd_filename_set = false;
 
+	//headless pass prediction options
+	bool use_batch_predict = false;
+	bool use_pass_search_benchmark = false;
+	struct batch_predict_options batch_predict_options = {0};
+	batch_predict_options.start_time = predict_to_julian(time(NULL));
+	batch_predict_options.format = BATCH_PREDICT_FORMAT_CSV;
+	batch_predict_options.tabulation_mode = PASS_TABULATION_EVENTS;
+	double batch_predict_hours = BATCH_PREDICT_DEFAULT_HOURS;
+	double min_elevation = 0;
+	char *endptr = NULL;
+	char batch_predict_filename[MAX_NUM_CHARS] = {0};
+
 	//command line options
 	struct option long_options[] = {
 		{"update-tle-db",		required_argument,	0,	'u'},
@@ -73,6 +97,15 @@ int main(int argc, char **argv)
 		{"rigctld-downlink-host",	required_argument,	0,	'D'},
 		{"rigctld-downlink-port",	required_argument,	0,	FLYBY_OPT_DOWNLINK_PORT},
 		{"rigctld-downlink-vfo",	required_argument,	0,	FLYBY_OPT_DOWNLINK_VFO},
+		{"predict",			no_argument,		0,	FLYBY_OPT_PREDICT},
+		{"predict-satellite",		required_argument,	0,	FLYBY_OPT_PREDICT_SATELLITE},
+		{"predict-start",		required_argument,	0,	FLYBY_OPT_PREDICT_START},
+		{"predict-hours",		required_argument,	0,	FLYBY_OPT_PREDICT_HOURS},
+		{"predict-min-elevation",	required_argument,	0,	FLYBY_OPT_PREDICT_MIN_ELEVATION},
+		{"predict-format",		required_argument,	0,	FLYBY_OPT_PREDICT_FORMAT},
+		{"predict-output",		required_argument,	0,	FLYBY_OPT_PREDICT_OUTPUT},
+		{"predict-step",		required_argument,	0,	FLYBY_OPT_PREDICT_STEP},
+		{"benchmark-pass-search",	no_argument,		0,	FLYBY_OPT_BENCHMARK_PASS_SEARCH},
 		{"help",			no_argument,		0,	'h'},
 		{0, 0, 0, 0}
 	};
@@ -128,6 +161,51 @@ int main(int argc, char **argv)
 			case FLYBY_OPT_DOWNLINK_VFO: //downlink vfo
 				strncpy(rigctld_downlink_vfo, optarg, MAX_NUM_CHARS);
 				break;
+			case FLYBY_OPT_PREDICT: //headless pass prediction
+				use_batch_predict = true;
+				break;
+			case FLYBY_OPT_PREDICT_SATELLITE: //satellite to predict
+				string_array_add(&(batch_predict_options.satellites), optarg);
+				break;
+			case FLYBY_OPT_PREDICT_START: //start of prediction window
+				if (batch_predict_parse_time(optarg, &(batch_predict_options.start_time)) != 0) {
+					fprintf(stderr, "Could not parse start time %s, expected YYYY-MM-DD or YYYY-MM-DDTHH:MM:SS.\n", optarg);
+					return 1;
+				}
+				break;
+			case FLYBY_OPT_PREDICT_HOURS: //length of prediction window
+				batch_predict_hours = strtod(optarg, &endptr);
+				if ((endptr == optarg) || (*endptr != '\0') || !(batch_predict_hours > 0)) {
+					fprintf(stderr, "Invalid prediction window %s, expected a positive number of hours.\n", optarg);
+					return 1;
+				}
+				break;
+			case FLYBY_OPT_PREDICT_MIN_ELEVATION: //elevation threshold
+				min_elevation = strtod(optarg, &endptr);
+				if ((endptr == optarg) || (*endptr != '\0') || !((min_elevation >= 0) && (min_elevation <= 90))) {
+					fprintf(stderr, "Invalid minimum elevation %s, expected degrees between 0 and 90.\n", optarg);
+					return 1;
+				}
+				batch_predict_options.min_elevation = min_elevation*M_PI/180.0;
+				break;
+			case FLYBY_OPT_PREDICT_FORMAT: //output format
+				if (batch_predict_parse_format(optarg, &(batch_predict_options.format)) != 0) {
+					fprintf(stderr, "Unknown output format %s, expected csv or json.\n", optarg);
+					return 1;
+				}
+				break;
+			case FLYBY_OPT_PREDICT_OUTPUT: //output file
+				strncpy(batch_predict_filename, optarg, MAX_NUM_CHARS-1);
+				break;
+			case FLYBY_OPT_PREDICT_STEP: //tabulation of each pass
+				if (pass_tabulation_parse_step(optarg, &(batch_predict_options.tabulation_mode), &(batch_predict_options.tabulation_step)) != 0) {
+					fprintf(stderr, "Invalid step %s, expected seconds (e.g. 60s), degrees (e.g. 10deg) or events.\n", optarg);
+					return 1;
+				}
+				break;
+			case FLYBY_OPT_BENCHMARK_PASS_SEARCH: //compare pass search against libpredict
+				use_pass_search_benchmark = true;
+				break;
 			case 'h': //help
 				show_help(argv[0], long_options, short_options);
 				return 0;
@@ -170,25 +248,10 @@ int main(int argc, char **argv)
 		return 0;
 	}
 
-	//connect to rotctld
-	rotctld_info_t rotctld = {0};
-	if (use_rotctl) {
-		rotctld_connect(rotctld_host, rotctld_port, rotctld_update_interval, tracking_horizon, &rotctld);
-	}
-
-	//connect to rigctld
-	rigctld_info_t uplink = {0};
-	if (use_rigctld_uplink) {
-		rigctld_connect(rigctld_uplink_host, rigctld_uplink_port, rigctld_uplink_vfo, &uplink);
-	}
-	rigctld_info_t downlink = {0};
-	if (use_rigctld_downlink) {
-		rigctld_connect(rigctld_downlink_host, rigctld_downlink_port, rigctld_downlink_vfo, &downlink);
-	}
-
 	//read flyby config files
 	predict_observer_t *observer = predict_create_observer("", 0, 0, 0);
 	bool is_new_user = false;
+	bool qth_found = true;
 
 	if (qth_cmd_filename_set) {
 		int retval = qth_from_file(qth_filename, observer);
@@ -197,12 +260,71 @@ int main(int argc, char **argv)
 			return 1;
 		}
 	} else {
-		is_new_user = qth_from_search_paths(observer) != QTH_FILE_HOME;
+		enum qth_file_state qth_state = qth_from_search_paths(observer);
+		is_new_user = qth_state != QTH_FILE_HOME;
+		qth_found = qth_state != QTH_FILE_NOTFOUND;
 		char *temp = qth_default_writepath();
 		strncpy(qth_filename, temp, MAX_NUM_CHARS);
 		free(temp);
 	}
 
+	//predict passes without user interface
+	if (use_batch_predict || use_pass_search_benchmark) {
+		//the placeholder location is only good for prompting new users for their QTH in the user interface
+		if (!qth_found) {
+			fprintf(stderr, "No QTH file found, specify the ground station using --qth-file or run flyby interactively first.\n");
+			return 1;
+		}
+
+		batch_predict_options.end_time = batch_predict_options.start_time + batch_predict_hours/24.0;
+		output_sink_t *output = NULL;
+		if (strlen(batch_predict_filename) > 0) {
+			output = output_sink_create_file(batch_predict_filename);
+			if (output == NULL) {
+				fprintf(stderr, "Output file %s could not be opened.\n", batch_predict_filename);
+				return 1;
+			}
+		} else {
+			output = output_sink_create_stdout();
+		}
+
+		int retval = 0;
+		if (use_pass_search_benchmark) {
+			int *tle_indices = NULL;
+			int num_selected = batch_predict_select_satellites(&batch_predict_options, tle_db, &tle_indices);
+			if (num_selected >= 0) {
+				retval = pass_search_benchmark_run(observer, tle_db, tle_indices, num_selected, batch_predict_options.start_time, batch_predict_options.end_time, output);
+			} else {
+				retval = -1;
+			}
+			free(tle_indices);
+		} else {
+			retval = batch_predict_run(&batch_predict_options, observer, tle_db, output);
+		}
+		output_sink_destroy(&output);
+
+		string_array_free(&(batch_predict_options.satellites));
+		predict_destroy_observer(observer);
+		tle_db_destroy(&tle_db);
+		return (retval == 0) ? 0 : 1;
+	}
+
+	//connect to rotctld
+	rotctld_info_t rotctld = {0};
+	if (use_rotctl) {
+		rotctld_connect(rotctld_host, rotctld_port, rotctld_update_interval, tracking_horizon, &rotctld);
+	}
+
+	//connect to rigctld
+	rigctld_info_t uplink = {0};
+	if (use_rigctld_uplink) {
+		rigctld_connect(rigctld_uplink_host, rigctld_uplink_port, rigctld_uplink_vfo, &uplink);
+	}
+	rigctld_info_t downlink = {0};
+	if (use_rigctld_downlink) {
+		rigctld_connect(rigctld_downlink_host, rigctld_downlink_port, rigctld_downlink_vfo, &downlink);
+	}
+
 	struct transponder_db *transponder_db = transponder_db_create();
 	transponder_db_from_search_paths(tle_db, transponder_db);
 
@@ -299,6 +421,33 @@ void show_help(const char *name, struct option long_options[], const char *short
 			case FLYBY_OPT_DOWNLINK_VFO:
 				printf("=VFO_NAME\tspecify rigctld downlink VFO");
 				break;
+			case FLYBY_OPT_PREDICT:
+				printf("\t\t\tpredict passes without user interface and write them to stdout or the file given by --predict-output. %s will exit afterwards", name);
+				break;
+			case FLYBY_OPT_PREDICT_SATELLITE:
+				printf("=SATELLITE\tpredict satellite with satellite number or name SATELLITE. Multiple satellites can be specified using this option multiple times (e.g. --predict-satellite 25544 --predict-satellite 40069). Defaults to all enabled satellites");
+				break;
+			case FLYBY_OPT_PREDICT_START:
+				printf("=TIME\t\tstart prediction at UTC time TIME (YYYY-MM-DD or YYYY-MM-DDTHH:MM:SS). Defaults to now");
+				break;
+			case FLYBY_OPT_PREDICT_HOURS:
+				printf("=HOURS\t\tlength of prediction time window. Defaults to %.0f hours", BATCH_PREDICT_DEFAULT_HOURS);
+				break;
+			case FLYBY_OPT_PREDICT_MIN_ELEVATION:
+				printf("=DEG\tleave out passes with lower maximum elevation");
+				break;
+			case FLYBY_OPT_PREDICT_FORMAT:
+				printf("=FORMAT\t\toutput format of predicted passes, csv or json");
+				break;
+			case FLYBY_OPT_PREDICT_OUTPUT:
+				printf("=FILE\t\twrite predicted passes to FILE instead of stdout");
+				break;
+			case FLYBY_OPT_PREDICT_STEP:
+				printf("=STEP\t\ttabulate each predicted pass at fixed time steps (e.g. 60s) or at angular steps along the track of the satellite across the sky (e.g. 10deg). Defaults to events, i.e. only AOS, TCA and LOS");
+				break;
+			case FLYBY_OPT_BENCHMARK_PASS_SEARCH:
+				printf("\t\ttime the pass search against libpredict's predict_next_aos/predict_next_los over the satellites and time window selected by the --predict options, and write a summary to stdout or the file given by --predict-output. %s will exit afterwards", name);
+				break;
 			case 'h':
 				printf("\t\t\t\tShow help");
 				break;
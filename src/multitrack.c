@@ -5,6 +5,7 @@
 #include <stdio.h>
 #include <curses.h>
 #include <stdlib.h>
+#include <float.h>
 #include "tle_db.h"
 #include "multitrack.h"
 #include "ui.h"
@@ -18,16 +19,27 @@
 //marker of menu item
 #define MULTITRACK_SELECTED_MARKER '-'
 
+//entries further away from AOS than this are propagated at a lower rate (days, 15 minutes)
+#define MULTITRACK_SLOW_PROPAGATION_AOS_DISTANCE (15.0/1440.0)
+
+//propagation interval of entries far from AOS, never visible or decayed (days, 30 seconds)
+#define MULTITRACK_SLOW_PROPAGATION_INTERVAL (30.0/86400.0)
+
+//maximum number of out-of-order entries for which the previous sort order is repaired by insertion instead of sorting from scratch
+#define MULTITRACK_SORT_REPAIR_LIMIT 16
+
 /** Private multitrack satellite listing prototypes. **/
 
 /**
  * Create entry in multitrack satellite listing.
  *
  * \param name Satellite name
+ * \param qth QTH coordinates
  * \param orbital_elements Orbital elements of satellite, created from TLE
+ * \param aos_los_orbital_elements Separate copy of orbital elements, used for the AOS/LOS calculation in the background
  * \return Multitrack entry
  **/
-multitrack_entry_t *multitrack_create_entry(const char *name, predict_orbital_elements_t *orbital_elements);
+multitrack_entry_t *multitrack_create_entry(const char *name, predict_observer_t *qth, predict_orbital_elements_t *orbital_elements, predict_orbital_elements_t *aos_los_orbital_elements);
 
 /**
  * Print scrollbar for satellite listing.
@@ -43,25 +55,138 @@ void multitrack_print_scrollbar(multitrack_listing_t *listing);
  * \param row Row
  * \param col Column
  * \param entry Satellite entry
+ * \param selected Whether entry is selected in the listing, and should be highlighted
  **/
-void multitrack_display_entry(WINDOW *window, int row, int col, multitrack_entry_t *entry);
+void multitrack_display_entry(WINDOW *window, int row, int col, multitrack_entry_t *entry, bool selected);
 
 /**
- * Update display strings and status in satellite entry.
+ * Update status of satellite entry. Calculates `entry->next_state`, and can be called from a worker thread.
+ * Requests calculation of AOS/LOS times when they are outdated. The display string is not formatted here,
+ * see multitrack_format_entry().
  *
- * \param qth QTH coordinates
+ * Full propagation is only done on every call for satellites above or close to the horizon. Satellites with AOS
+ * far away, and satellites that never will be visible, keep their previous status until
+ * MULTITRACK_SLOW_PROPAGATION_INTERVAL has passed, so that the cost of an update scales with the number of
+ * satellites of interest rather than with the size of the listing.
+ *
+ * \param listing Satellite listing
  * \param entry Multitrack entry
  * \param time Time at which satellite status should be calculated
  **/
-void multitrack_update_entry(predict_observer_t *qth, multitrack_entry_t *entry, predict_julian_date_t time);
+void multitrack_update_entry(multitrack_listing_t *listing, multitrack_entry_t *entry, predict_julian_date_t time);
+
+/**
+ * Check whether satellite entry is due for propagation, see multitrack_update_entry().
+ *
+ * \param entry Multitrack entry
+ * \param time Time of update
+ * \return True if the entry should be propagated, false if it should keep its previous status
+ **/
+bool multitrack_entry_due(const multitrack_entry_t *entry, predict_julian_date_t time);
+
+/**
+ * Update status of satellite entry from its propagated orbit and observation. Used by multitrack_update_entry(),
+ * and for entries propagated as part of the batch of the listing.
+ *
+ * \param listing Satellite listing
+ * \param entry Multitrack entry
+ * \param time Time of update
+ * \param orbit Propagated orbit
+ * \param obs Observation of propagated orbit
+ **/
+void multitrack_update_entry_state(multitrack_listing_t *listing, multitrack_entry_t *entry, predict_julian_date_t time, const struct predict_orbit *orbit, const struct predict_observation *obs);
+
+/**
+ * Get number of worker tasks used for updating the listing: one task per block of batched satellites, followed by
+ * one task per satellite propagated using libpredict. See multitrack_update_entry_task().
+ *
+ * \param listing Satellite listing
+ * \return Number of tasks
+ **/
+int multitrack_num_update_tasks(multitrack_listing_t *listing);
+
+/**
+ * Format display string and attributes of satellite entry from its displayed status. Only done for the
+ * entries that actually are drawn, since formatting all entries on every update is costly for large listings.
+ *
+ * \param entry Multitrack entry
+ * \param ret_string Returned display string, of size MAX_NUM_CHARS
+ * \param ret_attributes Returned formatting attributes (input to wattrset())
+ **/
+void multitrack_format_entry(const multitrack_entry_t *entry, char *ret_string, NCURSES_ATTR_T *ret_attributes);
+
+/**
+ * Start background calculation of AOS/LOS times for entries where this has been requested, unless a calculation already is running.
+ *
+ * \param listing Satellite listing
+ **/
+void multitrack_dispatch_aos_los(multitrack_listing_t *listing);
+
+/**
+ * Copy calculated status of all entries to the displayed status.
+ *
+ * \param listing Satellite listing
+ **/
+void multitrack_publish_entries(multitrack_listing_t *listing);
 
 /**
  * Sort satellite listing in different categories: Currently above horizon, below horizon but will rise, will never rise above horizon, decayed satellites. The satellites below the horizon are sorted internally according to AOS times.
+ * The order from the previous call is repaired rather than sorted from scratch, since only few entries change between updates.
  *
  * \param listing Satellite listing
  **/
 void multitrack_sort_listing(multitrack_listing_t *listing);
 
+/**
+ * Get time by which entry should be sorted in the satellite listing. Entries below the horizon
+ * with AOS times still being calculated are placed after the others.
+ *
+ * \param entry Multitrack entry
+ * \return Sort key
+ **/
+double multitrack_sort_key(const multitrack_entry_t *entry);
+
+/**
+ * Sort categories of satellite listing, in the order they are listed.
+ **/
+enum multitrack_sort_category {
+	///Satellites above the horizon, or that will eventually rise above the horizon
+	MULTITRACK_CATEGORY_VISIBLE,
+	///Satellites that will never be visible
+	MULTITRACK_CATEGORY_NEVER_VISIBLE,
+	///Satellites with decayed orbits
+	MULTITRACK_CATEGORY_DECAYED
+};
+
+/**
+ * Get sort category of entry.
+ *
+ * \param entry Multitrack entry
+ * \return Sort category
+ **/
+int multitrack_sort_category(const multitrack_entry_t *entry);
+
+/**
+ * Compare entries by their position in the sorted satellite listing. Defines a total order: Entries are
+ * ordered by sort category, then by AOS/LOS, with ties broken by entry index.
+ *
+ * \param listing Satellite listing
+ * \param index_1 Index of first entry
+ * \param index_2 Index of second entry
+ * \return Negative if the first entry is listed before the second, positive if after, 0 if they are the same entry
+ **/
+int multitrack_compare_entries(multitrack_listing_t *listing, int index_1, int index_2);
+
+/**
+ * Sort entry indices from scratch using bottom-up merge sort. Used when the previous order is too far off
+ * to be repaired efficiently.
+ *
+ * \param listing Satellite listing
+ * \param index Entry indices to sort, sorted in place
+ * \param num_indices Number of entry indices
+ **/
+void multitrack_merge_sort_index(multitrack_listing_t *listing, int *index, int num_indices);
+
 /**
  * Apply search information in the search field, and construct match array for matches found in the satellite list.
  * Match state is saved to listing->search_field.
@@ -220,17 +345,18 @@ void multitrack_search_field_clear_matches(multitrack_search_field_t *search_fie
 
 /** Multitrack satellite listing function implementations. **/
 
-multitrack_entry_t *multitrack_create_entry(const char *name, predict_orbital_elements_t *orbital_elements)
+multitrack_entry_t *multitrack_create_entry(const char *name, predict_observer_t *qth, predict_orbital_elements_t *orbital_elements, predict_orbital_elements_t *aos_los_orbital_elements)
 {
 	multitrack_entry_t *entry = (multitrack_entry_t*)malloc(sizeof(multitrack_entry_t));
 	entry->orbital_elements = orbital_elements;
 	entry->name = strdup(name);
-	entry->next_aos = 0;
-	entry->next_los = 0;
-	entry->above_horizon = 0;
-	entry->geostationary = 0;
-	entry->never_visible = 0;
-	entry->decayed = 0;
+	memset(&(entry->next_state), 0, sizeof(multitrack_entry_state_t));
+	entry->state = entry->next_state;
+	entry->next_propagation_time = 0;
+	entry->batch_index = -1;
+	memset(&(entry->aos_los), 0, sizeof(multitrack_aos_los_cache_t));
+	entry->aos_los.orbital_elements = aos_los_orbital_elements;
+	entry->aos_los.passes = pass_table_create(qth, aos_los_orbital_elements);
 	return entry;
 }
 
@@ -257,6 +383,16 @@ multitrack_listing_t* multitrack_create_listing(WINDOW *window, predict_observer
 	listing->qth = observer;
 	listing->displayed_entries_per_page = window_height;
 
+	listing->update_pool = thread_pool_create(0);
+	listing->update_pending = false;
+	listing->batch = NULL;
+	listing->batch_entries = NULL;
+	listing->unbatched_entries = NULL;
+	listing->num_unbatched_entries = 0;
+	listing->aos_los_pool = thread_pool_create(0);
+	listing->aos_los_tasks = NULL;
+	pthread_mutex_init(&(listing->aos_los_mutex), NULL);
+
 	multitrack_refresh_tles(listing, tle_db);
 
 	listing->option_selector = multitrack_option_selector_create();
@@ -296,6 +432,8 @@ void multitrack_listing_next_match(multitrack_listing_t *listing)
 void multitrack_free_entry(multitrack_entry_t **entry)
 {
 	predict_destroy_orbital_elements((*entry)->orbital_elements);
+	pass_table_destroy(&((*entry)->aos_los.passes));
+	predict_destroy_orbital_elements((*entry)->aos_los.orbital_elements);
 	free((*entry)->name);
 	free(*entry);
 	*entry = NULL;
@@ -303,6 +441,25 @@ void multitrack_free_entry(multitrack_entry_t **entry)
 
 void multitrack_free_entries(multitrack_listing_t *listing)
 {
+	//entries might still be in use by the worker threads
+	if (listing->update_pool != NULL) {
+		thread_pool_wait(listing->update_pool);
+	}
+	if (listing->aos_los_pool != NULL) {
+		thread_pool_wait(listing->aos_los_pool);
+	}
+	listing->update_pending = false;
+	free(listing->aos_los_tasks);
+	listing->aos_los_tasks = NULL;
+	if (listing->batch != NULL) {
+		sgp4_batch_destroy(&(listing->batch));
+	}
+	free(listing->batch_entries);
+	listing->batch_entries = NULL;
+	free(listing->unbatched_entries);
+	listing->unbatched_entries = NULL;
+	listing->num_unbatched_entries = 0;
+
 	if (listing->entries != NULL) {
 		for (int i=0; i < listing->num_entries; i++) {
 			multitrack_free_entry(&(listing->entries[i]));
@@ -339,17 +496,33 @@ void multitrack_refresh_tles(multitrack_listing_t *listing, struct tle_db *tle_d
 		listing->entries = (multitrack_entry_t**)malloc(sizeof(multitrack_entry_t*)*num_enabled_tles);
 		listing->tle_db_mapping = (int*)calloc(num_enabled_tles, sizeof(int));
 		listing->sorted_index = (int*)calloc(tle_db->num_tles, sizeof(int));
+		listing->aos_los_tasks = (int*)calloc(num_enabled_tles, sizeof(int));
 
 		int j=0;
 		for (int i=0; i < tle_db->num_tles; i++) {
 			if (tle_db_entry_enabled(tle_db, i)) {
 				predict_orbital_elements_t *orbital_elements = tle_db_entry_to_orbital_elements(tle_db, i);
-				listing->entries[j] = multitrack_create_entry(tle_db_entry_name(tle_db, i), orbital_elements);
+				predict_orbital_elements_t *aos_los_orbital_elements = tle_db_entry_to_orbital_elements(tle_db, i);
+				listing->entries[j] = multitrack_create_entry(tle_db_entry_name(tle_db, i), listing->qth, orbital_elements, aos_los_orbital_elements);
 				listing->tle_db_mapping[j] = i;
 				listing->sorted_index[j] = j;
 				j++;
 			}
 		}
+
+		//propagate near-earth satellites in batches, and the rest using libpredict
+		listing->batch = sgp4_batch_create(listing->qth);
+		listing->batch_entries = (int*)calloc(num_enabled_tles, sizeof(int));
+		listing->unbatched_entries = (int*)calloc(num_enabled_tles, sizeof(int));
+		for (int i=0; i < num_enabled_tles; i++) {
+			int batch_index = sgp4_batch_add(listing->batch, listing->entries[i]->orbital_elements);
+			listing->entries[i]->batch_index = batch_index;
+			if (batch_index >= 0) {
+				listing->batch_entries[batch_index] = i;
+			} else {
+				listing->unbatched_entries[listing->num_unbatched_entries++] = i;
+			}
+		}
 	}
 
 	listing->selected_entry_index = 0;
@@ -389,53 +562,123 @@ NCURSES_ATTR_T multitrack_colors(double range, double elevation)
 		return (COLOR_PAIR(2)|A_REVERSE); /* reverse */
 }
 
-void multitrack_update_entry(predict_observer_t *qth, multitrack_entry_t *entry, predict_julian_date_t time)
+bool multitrack_entry_due(const multitrack_entry_t *entry, predict_julian_date_t time)
 {
-	entry->geostationary = false;
+	//keep previous status of entries that are not due for propagation (unless time has jumped backwards)
+	return !((time < entry->next_propagation_time) && (entry->next_propagation_time - time <= MULTITRACK_SLOW_PROPAGATION_INTERVAL));
+}
+
+void multitrack_update_entry(multitrack_listing_t *listing, multitrack_entry_t *entry, predict_julian_date_t time)
+{
+	if (!multitrack_entry_due(entry, time)) {
+		return;
+	}
 
 	struct predict_observation obs;
 	struct predict_orbit orbit;
 	predict_orbit(entry->orbital_elements, &orbit, time);
-	predict_observe_orbit(qth, &orbit, &obs);
+	predict_observe_orbit(listing->qth, &orbit, &obs);
+	multitrack_update_entry_state(listing, entry, time, &orbit, &obs);
+}
+
+void multitrack_update_entry_state(multitrack_listing_t *listing, multitrack_entry_t *entry, predict_julian_date_t time, const struct predict_orbit *orbit, const struct predict_observation *obs)
+{
+	predict_observer_t *qth = listing->qth;
+	multitrack_entry_state_t *state = &(entry->next_state);
 
 	//sun status
-	char sunstat;
-	if (!orbit.eclipsed) {
-		if (obs.visible) {
-			sunstat='V';
+	if (!orbit->eclipsed) {
+		if (obs->visible) {
+			state->sunstat='V';
 		} else {
-			sunstat='D';
+			state->sunstat='D';
 		}
 	} else {
-		sunstat='N';
+		state->sunstat='N';
 	}
 
 	//satellite approaching status
-	char rangestat;
-	if (fabs(obs.range_rate) < 0.1) {
-		rangestat = '=';
-	} else if (obs.range_rate < 0.0) {
-		rangestat = '/';
-	} else if (obs.range_rate > 0.0) {
-		rangestat = '\\';
+	if (fabs(obs->range_rate) < 0.1) {
+		state->rangestat = '=';
+	} else if (obs->range_rate < 0.0) {
+		state->rangestat = '/';
+	} else if (obs->range_rate > 0.0) {
+		state->rangestat = '\\';
 	}
 
+	bool can_predict = !predict_is_geostationary(entry->orbital_elements) && predict_aos_happens(entry->orbital_elements, qth->latitude) && !(orbit->decayed);
+
+	/* Get Next Event (AOS/LOS) Times, request calculation in the background if they are outdated */
+	state->computing_aos_los = false;
+	if (can_predict) {
+		pthread_mutex_lock(&(listing->aos_los_mutex));
+		multitrack_aos_los_cache_t *cache = &(entry->aos_los);
+		if ((obs->elevation > 0) && (!(cache->los_calculated) || (time > cache->next_los))) {
+			if (!(cache->los_requested)) {
+				cache->los_requested = true;
+				cache->request_time = time;
+			}
+			state->computing_aos_los = true;
+		}
+		if ((obs->elevation < 0) && (!(cache->aos_calculated) || (time > cache->next_aos))) {
+			if (!(cache->aos_requested)) {
+				cache->aos_requested = true;
+				cache->request_time = time;
+			}
+			state->computing_aos_los = true;
+		}
+		state->next_aos = cache->next_aos;
+		state->next_los = cache->next_los;
+		pthread_mutex_unlock(&(listing->aos_los_mutex));
+	}
+
+	//keep what is needed for formatting the entry when it is displayed
+	state->time = time;
+	state->azimuth = obs->azimuth;
+	state->elevation = obs->elevation;
+	state->range = obs->range;
+	state->latitude = orbit->latitude;
+	state->longitude = orbit->longitude;
+	state->altitude = orbit->altitude;
+	state->can_predict = can_predict;
+	state->geostationary = predict_is_geostationary(entry->orbital_elements);
+
+	state->above_horizon = obs->elevation > 0;
+	state->decayed = orbit->decayed;
+
+	state->never_visible = !predict_aos_happens(entry->orbital_elements, qth->latitude) || (predict_is_geostationary(entry->orbital_elements) && (obs->elevation <= 0.0));
+
+	//decide when the entry should be propagated next
+	bool far_from_aos = can_predict && (obs->elevation < 0) && !(state->computing_aos_los) && (state->next_aos - time > MULTITRACK_SLOW_PROPAGATION_AOS_DISTANCE);
+	bool never_rises = state->decayed || state->never_visible;
+	if (far_from_aos || never_rises) {
+		entry->next_propagation_time = time + MULTITRACK_SLOW_PROPAGATION_INTERVAL;
+	} else {
+		entry->next_propagation_time = time;
+	}
+}
+
+void multitrack_format_entry(const multitrack_entry_t *entry, char *ret_string, NCURSES_ATTR_T *ret_attributes)
+{
+	const multitrack_entry_state_t *state = &(entry->state);
+	predict_julian_date_t time = state->time;
+
 	//set text formatting attributes according to satellite state, set AOS/LOS string
-	bool can_predict = !predict_is_geostationary(entry->orbital_elements) && predict_aos_happens(entry->orbital_elements, qth->latitude) && !(orbit.decayed);
 	char aos_los[MAX_NUM_CHARS] = {0};
-	if (obs.elevation >= 0) {
+	if (state->elevation >= 0) {
 		//different colours according to range and elevation
-		entry->display_attributes = multitrack_colors(obs.range, obs.elevation*180/M_PI);
+		*ret_attributes = multitrack_colors(state->range, state->elevation*180/M_PI);
 
-		if (predict_is_geostationary(entry->orbital_elements)){
+		if (state->geostationary){
 			sprintf(aos_los, "*GeoS*");
-			entry->geostationary = true;
+		} else if (state->computing_aos_los) {
+			sprintf(aos_los, "computing");
 		} else {
-			time_t epoch = predict_from_julian(entry->next_los - time);
+			time_t epoch = predict_from_julian(state->next_los - time);
 			struct tm timeval;
 			gmtime_r(&epoch, &timeval);
-			if ((entry->next_los - time) > 1.0) {
-				int num_days = (entry->next_los - time);
+			if ((state->next_los - time) > 1.0) {
+				int num_days = (state->next_los - time);
 				snprintf(aos_los, MAX_NUM_CHARS, "%d days", num_days);
 			} else if (timeval.tm_hour > 0) {
 				strftime(aos_los, MAX_NUM_CHARS, "%H:%M:%S", &timeval);
@@ -444,16 +687,21 @@ void multitrack_update_entry(predict_observer_t *qth, multitrack_entry_t *entry,
 			}
 
 		}
-	} else if ((obs.elevation < 0) && can_predict) {
-		if ((entry->next_aos-time) < 0.00694) {
+	} else if ((state->elevation < 0) && state->can_predict) {
+		if (state->computing_aos_los) {
+			*ret_attributes = COLOR_PAIR(4);
+			sprintf(aos_los, "computing");
+		} else if ((state->next_aos-time) < 0.00694) {
 			//satellite is close, set bold
-			entry->display_attributes = COLOR_PAIR(2);
-			time_t epoch = predict_from_julian(entry->next_aos - time);
-			strftime(aos_los, MAX_NUM_CHARS, "%M:%S", gmtime(&epoch)); //minutes and seconds left until AOS
+			*ret_attributes = COLOR_PAIR(2);
+			time_t epoch = predict_from_julian(state->next_aos - time);
+			struct tm timeval;
+			gmtime_r(&epoch, &timeval);
+			strftime(aos_los, MAX_NUM_CHARS, "%M:%S", &timeval); //minutes and seconds left until AOS
 		} else {
 			//satellite is far, set normal coloring
-			entry->display_attributes = COLOR_PAIR(4);
-			time_t aoslos_epoch = predict_from_julian(entry->next_aos);
+			*ret_attributes = COLOR_PAIR(4);
+			time_t aoslos_epoch = predict_from_julian(state->next_aos);
 			time_t curr_epoch = predict_from_julian(time);
 			struct tm aostime, currtime;
 			gmtime_r(&aoslos_epoch, &aostime);
@@ -467,60 +715,197 @@ void multitrack_update_entry(predict_observer_t *qth, multitrack_entry_t *entry,
 				snprintf(aos_los, MAX_NUM_CHARS, "+%dd %s", aostime.tm_yday, temp);
 			}
 		}
-	} else if (!can_predict) {
-		entry->display_attributes = COLOR_PAIR(3);
+	} else {
+		*ret_attributes = COLOR_PAIR(3);
 		sprintf(aos_los, "*GeoS-NoAOS*");
 	}
 
 	char abs_pos_string[MAX_NUM_CHARS] = {0};
-	sprintf(abs_pos_string, "%3.0f  %3.0f", orbit.latitude*180.0/M_PI, orbit.longitude*180.0/M_PI);
+	sprintf(abs_pos_string, "%3.0f  %3.0f", state->latitude*180.0/M_PI, state->longitude*180.0/M_PI);
+
+	//set string to display
+	sprintf(ret_string, " %-10.8s%5.1f  %5.1f %8s%6.0f %6.0f %c %c %12s ", entry->name, state->azimuth*180.0/M_PI, state->elevation*180.0/M_PI, abs_pos_string, state->altitude, state->range, state->sunstat, state->rangestat, aos_los);
+
+	//overwrite everything if orbit was decayed
+	if (state->decayed) {
+		*ret_attributes = COLOR_PAIR(2);
+		sprintf(ret_string, " %-10s ----------------     Decayed       --------------- ", entry->name);
+	}
+}
+
+int multitrack_num_update_tasks(multitrack_listing_t *listing)
+{
+	int num_blocks = (listing->batch != NULL) ? sgp4_batch_num_blocks(listing->batch) : 0;
+	return num_blocks + listing->num_unbatched_entries;
+}
 
-	/* Calculate Next Event (AOS/LOS) Times */
-	if (can_predict && (time > entry->next_los) && (obs.elevation > 0)) {
-		entry->next_los= predict_next_los(qth, entry->orbital_elements, time);
+/**
+ * Update block of batched entries, or single entry propagated using libpredict. Task function for the worker threads.
+ * The batch has to be prepared for `update_time` of the listing before the tasks are run.
+ *
+ * \param task_index Index of block in the batch, or number of blocks + index in `unbatched_entries`
+ * \param worker_index Worker index (unused)
+ * \param data Satellite listing
+ **/
+void multitrack_update_entry_task(int task_index, int worker_index, void *data)
+{
+	multitrack_listing_t *listing = (multitrack_listing_t*)data;
+	predict_julian_date_t time = listing->update_time;
+	int num_blocks = sgp4_batch_num_blocks(listing->batch);
+	if (task_index >= num_blocks) {
+		multitrack_update_entry(listing, listing->entries[listing->unbatched_entries[task_index - num_blocks]], time);
+		return;
 	}
 
-	if (can_predict && (time > entry->next_aos)) {
-		if (obs.elevation < 0) {
-			entry->next_aos = predict_next_aos(qth, entry->orbital_elements, time);
+	//propagate the block only if any of its entries is due
+	int start_index = task_index*SGP4_BATCH_LANES;
+	int end_index = start_index + SGP4_BATCH_LANES;
+	if (end_index > listing->batch->num_sats) {
+		end_index = listing->batch->num_sats;
+	}
+	bool due = false;
+	for (int i=start_index; i < end_index; i++) {
+		due = due || multitrack_entry_due(listing->entries[listing->batch_entries[i]], time);
+	}
+	if (!due) {
+		return;
+	}
+	sgp4_batch_propagate_block(listing->batch, task_index);
+
+	for (int i=start_index; i < end_index; i++) {
+		multitrack_entry_t *entry = listing->entries[listing->batch_entries[i]];
+		if (multitrack_entry_due(entry, time)) {
+			struct predict_orbit orbit;
+			struct predict_observation obs;
+			sgp4_batch_get(listing->batch, i, &orbit, &obs);
+			multitrack_update_entry_state(listing, entry, time, &orbit, &obs);
 		}
 	}
+}
 
-	//altitude and range in km/miles
-	double disp_altitude = orbit.altitude;
-	double disp_range = obs.range;
+/**
+ * Prepare update of all entries to given time, before the update tasks are run.
+ *
+ * \param listing Satellite listing
+ * \param time Time
+ **/
+void multitrack_prepare_update(multitrack_listing_t *listing, predict_julian_date_t time)
+{
+	listing->update_time = time;
+	if (listing->batch != NULL) {
+		sgp4_batch_prepare(listing->batch, time);
+	}
+}
 
-	//set string to display
-	char disp_string[MAX_NUM_CHARS];
-	sprintf(disp_string, " %-10.8s%5.1f  %5.1f %8s%6.0f %6.0f %c %c %12s ", entry->name, obs.azimuth*180.0/M_PI, obs.elevation*180.0/M_PI, abs_pos_string, disp_altitude, disp_range, sunstat, rangestat, aos_los);
+/**
+ * Calculate requested AOS/LOS times for single entry. Task function for the AOS/LOS worker threads.
+ *
+ * \param task_index Index in `aos_los_tasks` of listing
+ * \param worker_index Worker index (unused)
+ * \param data Satellite listing
+ **/
+void multitrack_aos_los_task(int task_index, int worker_index, void *data)
+{
+	multitrack_listing_t *listing = (multitrack_listing_t*)data;
+	multitrack_aos_los_cache_t *cache = &(listing->entries[listing->aos_los_tasks[task_index]]->aos_los);
+
+	pthread_mutex_lock(&(listing->aos_los_mutex));
+	bool aos_requested = cache->aos_requested;
+	bool los_requested = cache->los_requested;
+	predict_julian_date_t time = cache->request_time;
+	pthread_mutex_unlock(&(listing->aos_los_mutex));
+
+	//the pass table of the cache is only used from here, no locking necessary during calculation
+	double next_aos = 0;
+	double next_los = 0;
+	if (aos_requested) {
+		const struct pass_table_pass *pass = pass_table_next_aos(cache->passes, time);
+		if (pass != NULL) {
+			next_aos = pass->aos;
+		}
+	}
+	if (los_requested) {
+		const struct pass_table_pass *pass = pass_table_next_pass(cache->passes, time);
+		if (pass != NULL) {
+			next_los = pass->los;
+		}
+	}
 
-	//overwrite everything if orbit was decayed
-	if (orbit.decayed) {
-		entry->display_attributes = COLOR_PAIR(2);
-		sprintf(disp_string, " %-10s ----------------     Decayed       --------------- ", entry->name);
+	pthread_mutex_lock(&(listing->aos_los_mutex));
+	if (aos_requested) {
+		cache->next_aos = next_aos;
+		cache->aos_calculated = true;
+		cache->aos_requested = false;
 	}
+	if (los_requested) {
+		cache->next_los = next_los;
+		cache->los_calculated = true;
+		cache->los_requested = false;
+	}
+	pthread_mutex_unlock(&(listing->aos_los_mutex));
 
-	memcpy(entry->display_string, disp_string, sizeof(char)*MAX_NUM_CHARS);
+	//tabulate a few more passes while we are at it, so that the following AOS/LOS times are readily available
+	pass_table_extend(cache->passes, time, PASS_TABLE_DEFAULT_NUM_PASSES);
+}
 
-	entry->above_horizon = obs.elevation > 0;
-	entry->decayed = orbit.decayed;
+void multitrack_dispatch_aos_los(multitrack_listing_t *listing)
+{
+	if ((listing->aos_los_pool == NULL) || !thread_pool_done(listing->aos_los_pool)) {
+		return;
+	}
 
-	entry->never_visible = !predict_aos_happens(entry->orbital_elements, qth->latitude) || (predict_is_geostationary(entry->orbital_elements) && (obs.elevation <= 0.0));
+	int num_tasks = 0;
+	pthread_mutex_lock(&(listing->aos_los_mutex));
+	for (int i=0; i < listing->num_entries; i++) {
+		if (listing->entries[i]->aos_los.aos_requested || listing->entries[i]->aos_los.los_requested) {
+			listing->aos_los_tasks[num_tasks++] = i;
+		}
+	}
+	pthread_mutex_unlock(&(listing->aos_los_mutex));
+
+	if (num_tasks > 0) {
+		thread_pool_dispatch(listing->aos_los_pool, num_tasks, multitrack_aos_los_task, listing);
+	}
 }
 
-void multitrack_update_listing(multitrack_listing_t *listing, predict_julian_date_t time)
+void multitrack_publish_entries(multitrack_listing_t *listing)
 {
 	for (int i=0; i < listing->num_entries; i++) {
-		if (listing->not_displayed) {
-			//display progress information when this is the first time entries are displayed
-			wattrset(listing->window, COLOR_PAIR(1));
-			mvwprintw(listing->window, 0, 1, "Preparing entry %d of %d\n", i, listing->num_entries);
-			wrefresh(listing->window);
+		listing->entries[i]->state = listing->entries[i]->next_state;
+	}
+}
+
+void multitrack_update_listing(multitrack_listing_t *listing, predict_julian_date_t time)
+{
+	if (listing->update_pool == NULL) {
+		//no worker threads available, update in the main thread
+		multitrack_prepare_update(listing, time);
+		int num_tasks = multitrack_num_update_tasks(listing);
+		for (int i=0; i < num_tasks; i++) {
+			multitrack_update_entry_task(i, 0, listing);
+		}
+		multitrack_publish_entries(listing);
+	} else if (listing->not_displayed) {
+		//nothing to display yet, wait for the first update to finish
+		wattrset(listing->window, COLOR_PAIR(1));
+		mvwprintw(listing->window, 0, 1, "Preparing %d entries\n", listing->num_entries);
+		wrefresh(listing->window);
+
+		multitrack_prepare_update(listing, time);
+		thread_pool_run(listing->update_pool, multitrack_num_update_tasks(listing), multitrack_update_entry_task, listing);
+		multitrack_publish_entries(listing);
+	} else if (thread_pool_done(listing->update_pool)) {
+		//publish results from previous update, and start calculating the next one
+		if (listing->update_pending) {
+			multitrack_publish_entries(listing);
 		}
-		multitrack_entry_t *entry = listing->entries[i];
-		multitrack_update_entry(listing->qth, entry, time);
+		multitrack_prepare_update(listing, time);
+		listing->update_pending = true;
+		thread_pool_dispatch(listing->update_pool, multitrack_num_update_tasks(listing), multitrack_update_entry_task, listing);
 	}
 
+	multitrack_dispatch_aos_los(listing);
+
 	if (!multitrack_option_selector_visible(listing->option_selector) && !multitrack_search_field_visible(listing->search_field)) {
 		multitrack_sort_listing(listing); //freeze sorting when option selector is hovering over a satellite
 	}
@@ -528,61 +913,146 @@ void multitrack_update_listing(multitrack_listing_t *listing, predict_julian_dat
 	listing->not_displayed = false;
 }
 
-void multitrack_sort_listing(multitrack_listing_t *listing)
+double multitrack_sort_key(const multitrack_entry_t *entry)
 {
-	int num_orbits = listing->num_entries;
+	if (entry->state.computing_aos_los && !(entry->state.above_horizon)) {
+		return DBL_MAX;
+	}
+	return entry->state.next_aos;
+}
 
-	//those with elevation > 0 at the top
-	int above_horizon_counter = 0;
-	for (int i=0; i < num_orbits; i++){
-		if (listing->entries[i]->above_horizon && !(listing->entries[i]->decayed)) {
-			listing->sorted_index[above_horizon_counter] = i;
-			above_horizon_counter++;
+int multitrack_sort_category(const multitrack_entry_t *entry)
+{
+	if (entry->state.decayed) {
+		return MULTITRACK_CATEGORY_DECAYED;
+	} else if (entry->state.never_visible && !(entry->state.above_horizon)) {
+		return MULTITRACK_CATEGORY_NEVER_VISIBLE;
+	}
+	return MULTITRACK_CATEGORY_VISIBLE;
+}
+
+int multitrack_compare_entries(multitrack_listing_t *listing, int index_1, int index_2)
+{
+	const multitrack_entry_t *entry_1 = listing->entries[index_1];
+	const multitrack_entry_t *entry_2 = listing->entries[index_2];
+
+	int category_1 = multitrack_sort_category(entry_1);
+	int category_2 = multitrack_sort_category(entry_2);
+	if (category_1 != category_2) {
+		return (category_1 < category_2) ? -1 : 1;
+	}
+
+	if (category_1 == MULTITRACK_CATEGORY_VISIBLE) {
+		double key_1 = multitrack_sort_key(entry_1);
+		double key_2 = multitrack_sort_key(entry_2);
+		if (key_1 != key_2) {
+			return (key_1 < key_2) ? -1 : 1;
 		}
+	} else if (category_1 == MULTITRACK_CATEGORY_DECAYED) {
+		//decayed satellites are listed in reverse order
+		return index_2 - index_1;
 	}
-	listing->num_above_horizon = above_horizon_counter;
+	return index_1 - index_2;
+}
 
-	//satellites that will eventually rise above the horizon
-	int below_horizon_counter = 0;
-	for (int i=0; i < num_orbits; i++){
-		if (!(listing->entries[i]->above_horizon) && !(listing->entries[i]->never_visible) && !(listing->entries[i]->decayed)) {
-			listing->sorted_index[below_horizon_counter + above_horizon_counter] = i;
-			below_horizon_counter++;
+void multitrack_merge_sort_index(multitrack_listing_t *listing, int *index, int num_indices)
+{
+	int *buffer = (int*)malloc(sizeof(int)*num_indices);
+	int *source = index;
+	int *destination = buffer;
+
+	for (int width=1; width < num_indices; width *= 2) {
+		for (int start=0; start < num_indices; start += 2*width) {
+			int middle = (start + width < num_indices) ? start + width : num_indices;
+			int end = (start + 2*width < num_indices) ? start + 2*width : num_indices;
+			int i = start;
+			int j = middle;
+			for (int k=start; k < end; k++) {
+				if ((i < middle) && ((j >= end) || (multitrack_compare_entries(listing, source[i], source[j]) <= 0))) {
+					destination[k] = source[i++];
+				} else {
+					destination[k] = source[j++];
+				}
+			}
 		}
+		int *swap = source;
+		source = destination;
+		destination = swap;
 	}
-	listing->num_below_horizon = below_horizon_counter;
-
-	//satellites that will never be visible, with decayed orbits last
-	int nevervisible_counter = 0;
-	int decayed_counter = 0;
-	for (int i=0; i < num_orbits; i++){
-		if (listing->entries[i]->never_visible && !(listing->entries[i]->decayed)) {
-			listing->sorted_index[below_horizon_counter + above_horizon_counter + nevervisible_counter] = i;
-			nevervisible_counter++;
-		} else if (listing->entries[i]->decayed) {
-			listing->sorted_index[num_orbits - 1 - decayed_counter] = i;
-			decayed_counter++;
+
+	if (source != index) {
+		memcpy(index, source, sizeof(int)*num_indices);
+	}
+	free(buffer);
+}
+
+void multitrack_sort_listing(multitrack_listing_t *listing)
+{
+	int num_orbits = listing->num_entries;
+	int *sorted_index = listing->sorted_index;
+
+	//count satellites in each category, and check how far the order from the previous sort is off
+	listing->num_above_horizon = 0;
+	listing->num_below_horizon = 0;
+	listing->num_nevervisible = 0;
+	listing->num_decayed = 0;
+	int num_out_of_order = 0;
+	for (int i=0; i < num_orbits; i++) {
+		const multitrack_entry_t *entry = listing->entries[sorted_index[i]];
+		switch (multitrack_sort_category(entry)) {
+			case MULTITRACK_CATEGORY_VISIBLE:
+				if (entry->state.above_horizon) {
+					listing->num_above_horizon++;
+				} else {
+					listing->num_below_horizon++;
+				}
+				break;
+			case MULTITRACK_CATEGORY_NEVER_VISIBLE:
+				listing->num_nevervisible++;
+				break;
+			case MULTITRACK_CATEGORY_DECAYED:
+				listing->num_decayed++;
+				break;
+		}
+
+		if ((i > 0) && (multitrack_compare_entries(listing, sorted_index[i-1], sorted_index[i]) > 0)) {
+			num_out_of_order++;
 		}
 	}
-	listing->num_nevervisible = nevervisible_counter;
-	listing->num_decayed = decayed_counter;
 
-	//sort internally according to AOS/LOS
-	for (int i=0; i < above_horizon_counter + below_horizon_counter; i++) {
-		for (int j=0; j < above_horizon_counter + below_horizon_counter - 1; j++){
-			if (listing->entries[listing->sorted_index[j]]->next_aos > listing->entries[listing->sorted_index[j+1]]->next_aos) {
-				int x = listing->sorted_index[j];
-				listing->sorted_index[j] = listing->sorted_index[j+1];
-				listing->sorted_index[j+1] = x;
-			}
+	if (num_out_of_order == 0) {
+		return;
+	} else if (num_out_of_order > MULTITRACK_SORT_REPAIR_LIMIT) {
+		//too many changes for repairing the order one entry at a time
+		multitrack_merge_sort_index(listing, sorted_index, num_orbits);
+		return;
+	}
+
+	//repair order by insertion, moving only the entries that have changed category or AOS/LOS since the last sort
+	for (int i=1; i < num_orbits; i++) {
+		int index = sorted_index[i];
+		int j = i-1;
+		while ((j >= 0) && (multitrack_compare_entries(listing, sorted_index[j], index) > 0)) {
+			sorted_index[j+1] = sorted_index[j];
+			j--;
 		}
+		sorted_index[j+1] = index;
 	}
 }
 
-void multitrack_display_entry(WINDOW *window, int row, int col, multitrack_entry_t *entry)
+void multitrack_display_entry(WINDOW *window, int row, int col, multitrack_entry_t *entry, bool selected)
 {
-	wattrset(window, entry->display_attributes);
-	mvwprintw(window, row, col, "%s", entry->display_string);
+	char display_string[MAX_NUM_CHARS];
+	NCURSES_ATTR_T display_attributes = 0;
+	multitrack_format_entry(entry, display_string, &display_attributes);
+
+	if (selected) {
+		wattrset(window, MULTITRACK_SELECTED_ATTRIBUTE);
+		mvwprintw(window, row, col, "%c%s", MULTITRACK_SELECTED_MARKER, display_string + 1);
+	} else {
+		wattrset(window, display_attributes);
+		mvwprintw(window, row, col, "%s", display_string);
+	}
 }
 
 void multitrack_print_scrollbar(multitrack_listing_t *listing)
@@ -616,15 +1086,11 @@ void multitrack_display_listing(multitrack_listing_t *listing)
 
 	//show entries
 	if (listing->num_entries > 0) {
-		int selected_index = listing->sorted_index[listing->selected_entry_index];
-		listing->entries[selected_index]->display_attributes = MULTITRACK_SELECTED_ATTRIBUTE;
-		listing->entries[selected_index]->display_string[0] = MULTITRACK_SELECTED_MARKER;
-
 		int line = 0;
 		int col = 1;
 
 		for (int i=listing->top_index; ((i <= listing->bottom_index) && (i < listing->num_entries)); i++) {
-			multitrack_display_entry(listing->window, line++, col, listing->entries[listing->sorted_index[i]]);
+			multitrack_display_entry(listing->window, line++, col, listing->entries[listing->sorted_index[i]], i == listing->selected_entry_index);
 		}
 
 		if (listing->num_entries > listing->displayed_entries_per_page) {
@@ -758,6 +1224,19 @@ int multitrack_selected_entry(multitrack_listing_t *listing)
 	return listing->tle_db_mapping[index];
 }
 
+pass_table_t *multitrack_pass_table(multitrack_listing_t *listing, int tle_index)
+{
+	for (int i=0; i < listing->num_entries; i++) {
+		if (listing->tle_db_mapping[i] == tle_index) {
+			if (listing->aos_los_pool != NULL) {
+				thread_pool_wait(listing->aos_los_pool);
+			}
+			return listing->entries[i]->aos_los.passes;
+		}
+	}
+	return NULL;
+}
+
 int multitrack_selected_window_row(multitrack_listing_t *listing)
 {
 	return listing->selected_entry_index - listing->top_index;
@@ -766,6 +1245,13 @@ int multitrack_selected_window_row(multitrack_listing_t *listing)
 void multitrack_destroy_listing(multitrack_listing_t **listing)
 {
 	multitrack_free_entries(*listing);
+	if ((*listing)->update_pool != NULL) {
+		thread_pool_destroy(&((*listing)->update_pool));
+	}
+	if ((*listing)->aos_los_pool != NULL) {
+		thread_pool_destroy(&((*listing)->aos_los_pool));
+	}
+	pthread_mutex_destroy(&((*listing)->aos_los_mutex));
 	multitrack_option_selector_destroy(&((*listing)->option_selector));
 	multitrack_search_field_destroy(&((*listing)->search_field));
 	delwin((*listing)->header_window);
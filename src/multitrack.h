@@ -4,19 +4,18 @@
 #include "ncurses.h"
 #include "form.h"
 #include "menu.h"
+#include "thread_pool.h"
+#include "pass_table.h"
+#include "sgp4_batch.h"
 
 /**
  * Structs and functions used for showing a navigateable real-time satellite listing.
  **/
 
 /**
- * Entry in satellite listing.
+ * Calculated status of a satellite in the satellite listing.
  **/
 typedef struct {
-	///Satellite name
-	char *name;
-	///Orbital elements for satellite
-	predict_orbital_elements_t *orbital_elements;
 	///Time for next AOS
 	double next_aos;
 	///Time for next LOS
@@ -29,10 +28,72 @@ typedef struct {
 	bool never_visible;
 	///Whether satellite has decayed
 	bool decayed;
-	///String used for information displaying in the satellite listing
-	char display_string[MAX_NUM_CHARS];
-	///Formatting attributes (input to wattrset())
-	int display_attributes;
+	///Whether AOS/LOS times can be predicted for the satellite
+	bool can_predict;
+	///Time at which the status was calculated
+	predict_julian_date_t time;
+	///Azimuth (radians)
+	double azimuth;
+	///Elevation (radians)
+	double elevation;
+	///Range (km)
+	double range;
+	///Latitude of subsatellite point (radians)
+	double latitude;
+	///Longitude of subsatellite point (radians)
+	double longitude;
+	///Altitude (km)
+	double altitude;
+	///Sun status: 'V' visible, 'D' in daylight, 'N' in eclipse
+	char sunstat;
+	///Range status: '=' constant range, '/' approaching, '\\' receding
+	char rangestat;
+	///Whether next AOS/LOS currently is being calculated in the background, and `next_aos`/`next_los` are outdated
+	bool computing_aos_los;
+} multitrack_entry_state_t;
+
+/**
+ * AOS/LOS times of a satellite, calculated in the background. Protected by `aos_los_mutex` in the satellite listing.
+ **/
+typedef struct {
+	///Orbital elements used for the calculation. Separate copy from the one used in the propagation of the entry, since it is used from another thread
+	predict_orbital_elements_t *orbital_elements;
+	///Upcoming passes of the satellite, from which AOS/LOS times are taken
+	pass_table_t *passes;
+	///Whether next AOS should be calculated
+	bool aos_requested;
+	///Whether next LOS should be calculated
+	bool los_requested;
+	///Time from which AOS/LOS should be searched for
+	predict_julian_date_t request_time;
+	///Whether `next_aos` has been calculated
+	bool aos_calculated;
+	///Whether `next_los` has been calculated
+	bool los_calculated;
+	///Time for next AOS
+	double next_aos;
+	///Time for next LOS
+	double next_los;
+} multitrack_aos_los_cache_t;
+
+/**
+ * Entry in satellite listing.
+ **/
+typedef struct {
+	///Satellite name
+	char *name;
+	///Orbital elements for satellite
+	predict_orbital_elements_t *orbital_elements;
+	///Status displayed in the listing. Only accessed from the main thread
+	multitrack_entry_state_t state;
+	///Status under calculation. Only accessed from the worker thread updating the entry, copied to `state` when all entries have been updated
+	multitrack_entry_state_t next_state;
+	///Time at which the entry should be propagated next. Entries far from AOS are propagated at a lower rate. Only accessed from the worker thread updating the entry
+	predict_julian_date_t next_propagation_time;
+	///Index of satellite in the batched propagation of the listing, -1 if the entry is propagated using libpredict
+	int batch_index;
+	///AOS/LOS times, calculated in the background
+	multitrack_aos_los_cache_t aos_los;
 } multitrack_entry_t;
 
 /**
@@ -127,6 +188,26 @@ typedef struct {
 	multitrack_option_selector_t *option_selector;
 	///Search field
 	multitrack_search_field_t *search_field;
+	///Worker threads used for calculating entry statuses
+	thread_pool_t *update_pool;
+	///Time at which entry statuses currently are being calculated by the worker threads
+	predict_julian_date_t update_time;
+	///Whether entry statuses currently are being calculated by the worker threads, and should be published when they are finished
+	bool update_pending;
+	///Batched propagation of the near-earth satellites in the listing
+	sgp4_batch_t *batch;
+	///Mapping from indices in the batch to indices in the `entries`-array
+	int *batch_entries;
+	///Indices in the `entries`-array of entries that are not part of the batch
+	int *unbatched_entries;
+	///Number of entries that are not part of the batch
+	int num_unbatched_entries;
+	///Worker threads used for calculating AOS/LOS times in the background
+	thread_pool_t *aos_los_pool;
+	///Protects the AOS/LOS caches of all entries
+	pthread_mutex_t aos_los_mutex;
+	///Indices of entries for which AOS/LOS times currently are being calculated in the background
+	int *aos_los_tasks;
 } multitrack_listing_t;
 
 /**
@@ -148,7 +229,23 @@ multitrack_listing_t* multitrack_create_listing(WINDOW *window, predict_observer
 void multitrack_refresh_tles(multitrack_listing_t *listing, struct tle_db *tle_db);
 
 /**
- * Update satellite listing.
+ * Get pass table of a satellite in the listing, so that passes already calculated for the listing can be reused
+ * by other screens. Waits for any running background AOS/LOS calculation to finish. The pass table can be used
+ * until the next call to multitrack_update_listing() or multitrack_refresh_tles().
+ *
+ * \param listing Satellite listing
+ * \param tle_index Index of satellite in the TLE database
+ * \return Pass table, NULL if the satellite is not part of the listing
+ **/
+pass_table_t *multitrack_pass_table(multitrack_listing_t *listing, int tle_index);
+
+/**
+ * Update satellite listing. The entries are updated in the background on the worker threads of the listing, and the
+ * results are published to the displayed listing all at once on the next call after the workers are finished.
+ * The first update after (re)creation of the listing is run to completion before returning.
+ *
+ * AOS/LOS times are searched for on a separate set of background threads, since the search can be slow. Entries
+ * are shown as computing until their AOS/LOS times are available.
  *
  * \param listing Multitrack satellite listing
  * \param time Time at which satellite listing should be calculated
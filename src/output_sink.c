@@ -0,0 +1,287 @@
+#include "output_sink.h"
+#include <stdlib.h>
+#include <string.h>
+#include <stdarg.h>
+#include <ctype.h>
+#include <curses.h>
+
+//initial size of text buffers
+#define OUTPUT_SINK_INITIAL_SIZE 4096
+
+//number of screen rows not available for data in the pager backend
+#define OUTPUT_SINK_PAGER_RESERVED_LINES 8
+
+/**
+ * Create output sink with the given backend.
+ *
+ * \param backend Output backend
+ * \return Output sink
+ **/
+output_sink_t *output_sink_create(enum output_sink_backend backend)
+{
+	output_sink_t *sink = (output_sink_t*)calloc(1, sizeof(output_sink_t));
+	sink->backend = backend;
+	return sink;
+}
+
+output_sink_t *output_sink_create_pager(const char *title, const char *type, const char *header)
+{
+	output_sink_t *sink = output_sink_create(OUTPUT_SINK_PAGER);
+	strncpy(sink->title, title, MAX_NUM_CHARS-1);
+	strncpy(sink->type, type, MAX_NUM_CHARS-1);
+	strncpy(sink->header, header, MAX_NUM_CHARS-1);
+	return sink;
+}
+
+output_sink_t *output_sink_create_file(const char *filename)
+{
+	FILE *file = fopen(filename, "w");
+	if (file == NULL) {
+		return NULL;
+	}
+	output_sink_t *sink = output_sink_create(OUTPUT_SINK_FILE);
+	sink->file = file;
+	return sink;
+}
+
+output_sink_t *output_sink_create_stdout()
+{
+	output_sink_t *sink = output_sink_create(OUTPUT_SINK_STDOUT);
+	sink->file = stdout;
+	return sink;
+}
+
+/**
+ * Free memory in text buffer.
+ *
+ * \param buffer Text buffer
+ **/
+void output_sink_buffer_free(struct output_sink_buffer *buffer)
+{
+	free(buffer->data);
+	buffer->data = NULL;
+	buffer->available_size = 0;
+	buffer->length = 0;
+}
+
+void output_sink_destroy(output_sink_t **sink)
+{
+	if (*sink == NULL) {
+		return;
+	}
+
+	//held back output is discarded, while incomplete pages of the pager are not displayed after the user is done
+	if ((*sink)->backend != OUTPUT_SINK_PAGER) {
+		output_sink_flush(*sink);
+	}
+	if ((*sink)->backend == OUTPUT_SINK_FILE) {
+		fclose((*sink)->file);
+	}
+
+	output_sink_buffer_free(&((*sink)->page));
+	output_sink_buffer_free(&((*sink)->held));
+	free(*sink);
+	*sink = NULL;
+}
+
+/**
+ * Append text to text buffer. Reallocates available space to twice the size when current available size is exceeded.
+ *
+ * \param buffer Text buffer
+ * \param string Text
+ * \param length Length of text
+ * \return 0 on success, -1 on failure
+ **/
+int output_sink_buffer_append(struct output_sink_buffer *buffer, const char *string, int length)
+{
+	if (buffer->length + length + 1 > buffer->available_size) {
+		int available_size = (buffer->available_size > 0) ? buffer->available_size : OUTPUT_SINK_INITIAL_SIZE;
+		while (buffer->length + length + 1 > available_size) {
+			available_size *= 2;
+		}
+		char *data = (char*)realloc(buffer->data, available_size);
+		if (data == NULL) {
+			return -1;
+		}
+		buffer->data = data;
+		buffer->available_size = available_size;
+	}
+	memcpy(buffer->data + buffer->length, string, length);
+	buffer->length += length;
+	buffer->data[buffer->length] = '\0';
+	return 0;
+}
+
+int output_sink_page_lines()
+{
+	return LINES - OUTPUT_SINK_PAGER_RESERVED_LINES;
+}
+
+/**
+ * Display current page on the screen and wait for the user to either continue or quit.
+ *
+ * \param sink Output sink
+ **/
+void output_sink_display_page(output_sink_t *sink)
+{
+	attrset(COLOR_PAIR(6)|A_REVERSE|A_BOLD);
+	clear();
+	mvprintw(0,0,"                                                                                ");
+	mvprintw(1,0,"  flyby Calendar :                                                              ");
+	mvprintw(1,21,"%-24s", sink->type);
+	mvprintw(2,0,"                                                                                ");
+	int title_col = 79-strlen(sink->title);
+	mvprintw(1,title_col, "%s", sink->title);
+	attrset(COLOR_PAIR(2)|A_REVERSE|A_BOLD);
+	mvprintw(3,0,"%s",sink->header);
+
+	attrset(COLOR_PAIR(2)|A_BOLD);
+	mvprintw(4,0,"\n");
+
+	if (sink->page.data != NULL) {
+		addstr(sink->page.data);
+	}
+	attrset(COLOR_PAIR(4)|A_BOLD);
+
+	mvprintw(LINES-2,6,"More? [y/n] >> ");
+	curs_set(1);
+	refresh();
+
+	while (true) {
+		int key=toupper(getch());
+
+		if (key=='Y' || key=='\n' || key==' ') {
+			sink->quit = false;
+			break;
+		}
+
+		if (key=='N' || key=='Q' || key==27) {
+			sink->quit = true;
+			break;
+		}
+	}
+
+	sink->page.length = 0;
+	if (sink->page.data != NULL) {
+		sink->page.data[0] = '\0';
+	}
+	sink->num_page_lines = 0;
+	curs_set(0);
+}
+
+/**
+ * Add text to the pager, displaying the page each time the screen has been filled.
+ *
+ * \param sink Output sink
+ * \param string Text
+ * \param length Length of text
+ **/
+void output_sink_page(output_sink_t *sink, const char *string, int length)
+{
+	int page_lines = output_sink_page_lines();
+	int line_start = 0;
+	for (int i=0; (i < length) && !(sink->quit); i++) {
+		if (string[i] == '\n') {
+			output_sink_buffer_append(&(sink->page), string + line_start, i + 1 - line_start);
+			line_start = i + 1;
+			sink->num_page_lines++;
+			if (sink->num_page_lines >= page_lines) {
+				output_sink_display_page(sink);
+			}
+		}
+	}
+
+	//keep incomplete line until the rest of it is written
+	if (!(sink->quit) && (line_start < length)) {
+		output_sink_buffer_append(&(sink->page), string + line_start, length - line_start);
+	}
+}
+
+/**
+ * Write text to the backend, bypassing any holding.
+ *
+ * \param sink Output sink
+ * \param string Text
+ * \param length Length of text
+ **/
+void output_sink_emit(output_sink_t *sink, const char *string, int length)
+{
+	switch (sink->backend) {
+		case OUTPUT_SINK_PAGER:
+			output_sink_page(sink, string, length);
+			break;
+		case OUTPUT_SINK_FILE:
+		case OUTPUT_SINK_STDOUT:
+			fwrite(string, 1, length, sink->file);
+			break;
+	}
+}
+
+bool output_sink_write(output_sink_t *sink, const char *string)
+{
+	if (sink->quit) {
+		return true;
+	}
+
+	int length = strlen(string);
+	if (sink->holding) {
+		output_sink_buffer_append(&(sink->held), string, length);
+	} else {
+		output_sink_emit(sink, string, length);
+	}
+	return sink->quit;
+}
+
+bool output_sink_printf(output_sink_t *sink, const char *format, ...)
+{
+	char string[MAX_NUM_CHARS];
+	va_list args;
+	va_start(args, format);
+	int length = vsnprintf(string, MAX_NUM_CHARS, format, args);
+	va_end(args);
+
+	if (length < MAX_NUM_CHARS) {
+		return output_sink_write(sink, string);
+	}
+
+	//too long for the stack buffer
+	char *long_string = (char*)malloc(length + 1);
+	va_start(args, format);
+	vsnprintf(long_string, length + 1, format, args);
+	va_end(args);
+	bool quit = output_sink_write(sink, long_string);
+	free(long_string);
+	return quit;
+}
+
+void output_sink_hold(output_sink_t *sink)
+{
+	sink->holding = true;
+	sink->held.length = 0;
+}
+
+bool output_sink_release(output_sink_t *sink, bool write)
+{
+	sink->holding = false;
+	if (write && !(sink->quit) && (sink->held.length > 0)) {
+		output_sink_emit(sink, sink->held.data, sink->held.length);
+	}
+	sink->held.length = 0;
+	return sink->quit;
+}
+
+bool output_sink_flush(output_sink_t *sink)
+{
+	switch (sink->backend) {
+		case OUTPUT_SINK_PAGER:
+			if (!(sink->quit) && (sink->page.length > 0)) {
+				output_sink_display_page(sink);
+			}
+			break;
+		case OUTPUT_SINK_FILE:
+		case OUTPUT_SINK_STDOUT:
+			fflush(sink->file);
+			break;
+	}
+	return sink->quit;
+}
@@ -0,0 +1,150 @@
+#ifndef OUTPUT_SINK_H_DEFINED
+#define OUTPUT_SINK_H_DEFINED
+
+#include <stdio.h>
+#include <stdbool.h>
+#include "defines.h"
+
+/**
+ * Destination for line-oriented text output, e.g. pass predictions. Text is either paged on the ncurses screen
+ * or written to a file or stdout, so that the same prediction code can be used for all of them.
+ *
+ * Output can be held back, e.g. for the duration of a pass, and afterwards either written or discarded as a
+ * whole. This allows filtering of passes based on the tabulated data without buffering formatted text in the
+ * prediction code.
+ **/
+
+/**
+ * Output backend.
+ **/
+enum output_sink_backend {
+	///Paged display on the ncurses screen, with a prompt for each full page
+	OUTPUT_SINK_PAGER,
+	///File opened by the sink
+	OUTPUT_SINK_FILE,
+	///Standard output
+	OUTPUT_SINK_STDOUT
+};
+
+/**
+ * Growable text buffer.
+ **/
+struct output_sink_buffer {
+	///Available size of `data`
+	int available_size;
+	///Length of text currently in buffer, excluding null terminator
+	int length;
+	///Null-terminated text
+	char *data;
+};
+
+/**
+ * Output sink.
+ **/
+typedef struct {
+	///Output backend
+	enum output_sink_backend backend;
+	///Output stream, for the file and stdout backends
+	FILE *file;
+	///Text of the page currently being filled, for the pager backend
+	struct output_sink_buffer page;
+	///Number of complete lines in the current page
+	int num_page_lines;
+	///Whether output is currently held back
+	bool holding;
+	///Held back output
+	struct output_sink_buffer held;
+	///Title to show on top of the screen, for the pager backend
+	char title[MAX_NUM_CHARS];
+	///Type of data, shown on top of the screen for the pager backend
+	char type[MAX_NUM_CHARS];
+	///Column header, shown above the data for the pager backend
+	char header[MAX_NUM_CHARS];
+	///Whether the user has asked to quit, for the pager backend
+	bool quit;
+} output_sink_t;
+
+/**
+ * Create output sink for paged display on the ncurses screen.
+ *
+ * \param title Title to show on top of the screen
+ * \param type Type of data, e.g. "Satellite Passes"
+ * \param header Column header to show above the data
+ * \return Output sink
+ **/
+output_sink_t *output_sink_create_pager(const char *title, const char *type, const char *header);
+
+/**
+ * Create output sink writing to a file.
+ *
+ * \param filename Filename. Existing file is overwritten
+ * \return Output sink, or NULL if the file could not be opened
+ **/
+output_sink_t *output_sink_create_file(const char *filename);
+
+/**
+ * Create output sink writing to stdout.
+ *
+ * \return Output sink
+ **/
+output_sink_t *output_sink_create_stdout();
+
+/**
+ * Write any remaining output, and destroy output sink. Closes the file of the file backend.
+ *
+ * \param sink Output sink to destroy, set to NULL on return
+ **/
+void output_sink_destroy(output_sink_t **sink);
+
+/**
+ * Write text to the output sink. For the pager backend, the page is displayed and the user prompted
+ * each time the screen has been filled.
+ *
+ * \param sink Output sink
+ * \param string Text
+ * \return True if the user wants to quit, false otherwise
+ **/
+bool output_sink_write(output_sink_t *sink, const char *string);
+
+/**
+ * Write formatted text to the output sink, see output_sink_write().
+ *
+ * \param sink Output sink
+ * \param format printf format string
+ * \return True if the user wants to quit, false otherwise
+ **/
+bool output_sink_printf(output_sink_t *sink, const char *format, ...) __attribute__((format(printf, 2, 3)));
+
+/**
+ * Start holding back output. Subsequent writes are buffered until output_sink_release() is called.
+ *
+ * \param sink Output sink
+ **/
+void output_sink_hold(output_sink_t *sink);
+
+/**
+ * Stop holding back output, and write or discard the output held back since output_sink_hold().
+ *
+ * \param sink Output sink
+ * \param write Whether to write the held back output
+ * \return True if the user wants to quit, false otherwise
+ **/
+bool output_sink_release(output_sink_t *sink, bool write);
+
+/**
+ * Write out incomplete page or buffered file output. For the pager backend, the remaining lines are displayed
+ * and the user is prompted.
+ *
+ * \param sink Output sink
+ * \return True if the user wants to quit, false otherwise
+ **/
+bool output_sink_flush(output_sink_t *sink);
+
+/**
+ * Get number of data lines fitting on one page of the pager backend.
+ *
+ * \return Number of lines
+ **/
+int output_sink_page_lines();
+
+#endif
@@ -0,0 +1,226 @@
+#include "pass_prediction.h"
+#include <stdlib.h>
+#include <string.h>
+#include "pass_tabulation.h"
+
+//initial number of entries in pass list
+#define PASS_PREDICTION_INITIAL_SIZE 64
+
+/**
+ * Worker state. Only accessed by the worker thread it belongs to while predicting.
+ **/
+struct pass_prediction_worker {
+	///Copy of the ground station
+	predict_observer_t *observer;
+	///Passes found by this worker
+	pass_prediction_list_t passes;
+	///Whether memory allocation failed
+	bool failed;
+};
+
+/**
+ * Prediction in progress, shared with the worker threads.
+ **/
+struct pass_prediction_batch {
+	///TLE database
+	const struct tle_db *tle_db;
+	///Indices of the satellites to predict in the TLE database
+	const int *tle_indices;
+	///Number of satellites to predict
+	int num_satellites;
+	///Number of satellites per chunk
+	int chunk_size;
+	///Start of time window
+	predict_julian_date_t start_time;
+	///End of time window
+	predict_julian_date_t end_time;
+	///Elevation threshold (radians)
+	double min_elevation;
+	///Worker states, one per worker thread
+	struct pass_prediction_worker *workers;
+};
+
+/**
+ * Add pass to pass list. Reallocates available space to twice the size when current available size is exceeded.
+ *
+ * \param passes Pass list
+ * \param pass Pass
+ * \return 0 on success, -1 on failure
+ **/
+int pass_prediction_list_add(pass_prediction_list_t *passes, const struct pass_prediction *pass)
+{
+	if (passes->num_passes >= passes->available_size) {
+		int available_size = (passes->available_size > 0) ? passes->available_size*2 : PASS_PREDICTION_INITIAL_SIZE;
+		struct pass_prediction *new_passes = (struct pass_prediction*)realloc(passes->passes, sizeof(struct pass_prediction)*available_size);
+		if (new_passes == NULL) {
+			return -1;
+		}
+		passes->passes = new_passes;
+		passes->available_size = available_size;
+	}
+	passes->passes[passes->num_passes] = *pass;
+	passes->num_passes++;
+	return 0;
+}
+
+void pass_prediction_list_free(pass_prediction_list_t *passes)
+{
+	free(passes->passes);
+	passes->passes = NULL;
+	passes->available_size = 0;
+	passes->num_passes = 0;
+}
+
+/**
+ * Predict passes of a single satellite within the time window.
+ *
+ * \param batch Prediction in progress
+ * \param worker State of the worker thread
+ * \param tle_index Index of satellite in the TLE database
+ **/
+void pass_prediction_satellite(const struct pass_prediction_batch *batch, struct pass_prediction_worker *worker, int tle_index)
+{
+	predict_orbital_elements_t *orbital_elements = tle_db_entry_to_orbital_elements(batch->tle_db, tle_index);
+	if (orbital_elements == NULL) {
+		return;
+	}
+	pass_table_t *pass_table = pass_table_create(worker->observer, orbital_elements);
+
+	//start with the pass in progress at the start of the window, if any
+	const struct pass_table_pass *next_pass = pass_table_next_pass(pass_table, batch->start_time);
+	while ((next_pass != NULL) && (next_pass->aos < batch->end_time)) {
+		struct pass_prediction pass = {.tle_index = tle_index, .pass = *next_pass};
+		if (pass.pass.max_elevation >= batch->min_elevation) {
+			//azimuths at AOS, TCA and LOS
+			pass_tabulation_t tabulation;
+			pass_tabulation_start(&tabulation, worker->observer, orbital_elements, &(pass.pass), PASS_TABULATION_EVENTS, 0);
+			struct pass_tabulation_row row;
+			while (pass_tabulation_next(&tabulation, &row)) {
+				switch (row.event) {
+					case PASS_TABULATION_AOS:
+						pass.aos_azimuth = row.observation.azimuth;
+						break;
+					case PASS_TABULATION_TCA:
+						pass.tca_azimuth = row.observation.azimuth;
+						break;
+					case PASS_TABULATION_LOS:
+						pass.los_azimuth = row.observation.azimuth;
+						break;
+					default:
+						break;
+				}
+			}
+			if (pass_prediction_list_add(&(worker->passes), &pass) != 0) {
+				worker->failed = true;
+			}
+		}
+
+		//pointer into the pass table is invalidated by the next lookup
+		next_pass = pass_table_next_aos(pass_table, pass.pass.los);
+	}
+
+	pass_table_destroy(&pass_table);
+	predict_destroy_orbital_elements(orbital_elements);
+}
+
+/**
+ * Predict passes of a chunk of satellites. Task function for the worker threads.
+ *
+ * \param task_index Chunk index
+ * \param worker_index Worker index
+ * \param data Prediction in progress
+ **/
+void pass_prediction_chunk_task(int task_index, int worker_index, void *data)
+{
+	struct pass_prediction_batch *batch = (struct pass_prediction_batch*)data;
+	struct pass_prediction_worker *worker = &(batch->workers[worker_index]);
+
+	int start = task_index*batch->chunk_size;
+	int end = start + batch->chunk_size;
+	if (end > batch->num_satellites) {
+		end = batch->num_satellites;
+	}
+	for (int i=start; i < end; i++) {
+		pass_prediction_satellite(batch, worker, batch->tle_indices[i]);
+	}
+}
+
+/**
+ * Compare passes by AOS, for sorting with qsort(). Passes with equal AOS are ordered by TLE index.
+ *
+ * \param a First pass
+ * \param b Second pass
+ * \return Negative if a comes before b, positive if a comes after b, 0 otherwise
+ **/
+int pass_prediction_compare(const void *a, const void *b)
+{
+	const struct pass_prediction *pass_a = (const struct pass_prediction*)a;
+	const struct pass_prediction *pass_b = (const struct pass_prediction*)b;
+	if (pass_a->pass.aos < pass_b->pass.aos) {
+		return -1;
+	} else if (pass_a->pass.aos > pass_b->pass.aos) {
+		return 1;
+	}
+	return pass_a->tle_index - pass_b->tle_index;
+}
+
+int pass_prediction_run(const struct tle_db *tle_db, const int *tle_indices, int num_satellites, const predict_observer_t *observer, predict_julian_date_t start_time, predict_julian_date_t end_time, double min_elevation, thread_pool_t *pool, pass_prediction_list_t *ret_passes)
+{
+	ret_passes->num_passes = 0;
+
+	int num_workers = (pool != NULL) ? pool->num_workers : 1;
+	int num_chunks = num_workers*PASS_PREDICTION_CHUNKS_PER_WORKER;
+	if (num_chunks > num_satellites) {
+		num_chunks = num_satellites;
+	}
+	if (num_chunks < 1) {
+		return 0;
+	}
+
+	struct pass_prediction_batch batch;
+	batch.tle_db = tle_db;
+	batch.tle_indices = tle_indices;
+	batch.num_satellites = num_satellites;
+	batch.chunk_size = (num_satellites + num_chunks - 1)/num_chunks;
+	batch.start_time = start_time;
+	batch.end_time = end_time;
+	batch.min_elevation = min_elevation;
+	batch.workers = (struct pass_prediction_worker*)calloc(num_workers, sizeof(struct pass_prediction_worker));
+	if (batch.workers == NULL) {
+		return -1;
+	}
+	for (int i=0; i < num_workers; i++) {
+		batch.workers[i].observer = predict_create_observer(observer->name, observer->latitude, observer->longitude, observer->altitude);
+	}
+	num_chunks = (num_satellites + batch.chunk_size - 1)/batch.chunk_size;
+
+	if (pool != NULL) {
+		thread_pool_run(pool, num_chunks, pass_prediction_chunk_task, &batch);
+	} else {
+		for (int i=0; i < num_chunks; i++) {
+			pass_prediction_chunk_task(i, 0, &batch);
+		}
+	}
+
+	//merge the passes found by each worker
+	int retval = 0;
+	for (int i=0; i < num_workers; i++) {
+		struct pass_prediction_worker *worker = &(batch.workers[i]);
+		if (worker->failed) {
+			retval = -1;
+		}
+		for (int j=0; (j < worker->passes.num_passes) && (retval == 0); j++) {
+			if (pass_prediction_list_add(ret_passes, &(worker->passes.passes[j])) != 0) {
+				retval = -1;
+			}
+		}
+		pass_prediction_list_free(&(worker->passes));
+		predict_destroy_observer(worker->observer);
+	}
+	free(batch.workers);
+
+	if (ret_passes->num_passes > 0) {
+		qsort(ret_passes->passes, ret_passes->num_passes, sizeof(struct pass_prediction), pass_prediction_compare);
+	}
+	return retval;
+}
@@ -0,0 +1,71 @@
+#ifndef PASS_PREDICTION_H_DEFINED
+#define PASS_PREDICTION_H_DEFINED
+
+#include <predict/predict.h>
+#include "pass_table.h"
+#include "tle_db.h"
+#include "thread_pool.h"
+
+/**
+ * Pass prediction for many satellites at once, e.g. all enabled satellites in the TLE database over the next
+ * couple of days. The satellites are partitioned into chunks which are predicted in parallel on a thread pool.
+ * Each worker thread has its own copy of the ground station, and creates orbital elements and pass tables
+ * only for the satellites it is predicting, so that workers share nothing but the read-only TLE database.
+ * The passes found by all workers are merged into a single list sorted by AOS.
+ **/
+
+//number of chunks per worker thread the satellites are partitioned into, for balancing the load between the workers
+#define PASS_PREDICTION_CHUNKS_PER_WORKER 8
+
+/**
+ * Predicted pass of a satellite.
+ **/
+struct pass_prediction {
+	///Index of satellite in the TLE database
+	int tle_index;
+	///AOS, TCA, LOS and maximum elevation
+	struct pass_table_pass pass;
+	///Azimuth at AOS (radians)
+	double aos_azimuth;
+	///Azimuth at TCA (radians)
+	double tca_azimuth;
+	///Azimuth at LOS (radians)
+	double los_azimuth;
+};
+
+/**
+ * List of predicted passes.
+ **/
+typedef struct {
+	///Available size of `passes`
+	int available_size;
+	///Number of passes
+	int num_passes;
+	///Passes
+	struct pass_prediction *passes;
+} pass_prediction_list_t;
+
+/**
+ * Predict all passes of the given satellites starting within a time window.
+ *
+ * \param tle_db TLE database
+ * \param tle_indices Indices of the satellites to predict in the TLE database
+ * \param num_satellites Number of satellites to predict
+ * \param observer Ground station
+ * \param start_time Start of time window. A pass in progress at the start of the window is included
+ * \param end_time End of time window
+ * \param min_elevation Passes with lower maximum elevation are left out (radians)
+ * \param pool Thread pool to predict on. Satellites are predicted in the calling thread when NULL
+ * \param ret_passes Returned passes, sorted by AOS. Has to be freed using pass_prediction_list_free()
+ * \return 0 on success, -1 on failure
+ **/
+int pass_prediction_run(const struct tle_db *tle_db, const int *tle_indices, int num_satellites, const predict_observer_t *observer, predict_julian_date_t start_time, predict_julian_date_t end_time, double min_elevation, thread_pool_t *pool, pass_prediction_list_t *ret_passes);
+
+/**
+ * Free memory in pass list.
+ *
+ * \param passes Pass list
+ **/
+void pass_prediction_list_free(pass_prediction_list_t *passes);
+
+#endif
@@ -0,0 +1,360 @@
+#include "pass_search.h"
+#include "solver.h"
+#include <math.h>
+
+//equatorial radius of the earth (km)
+#define PASS_SEARCH_EARTH_RADIUS_EQUATOR 6378.137
+
+//polar radius of the earth (km)
+#define PASS_SEARCH_EARTH_RADIUS_POLE 6356.752
+
+//rotation rate of the earth (radians per day)
+#define PASS_SEARCH_EARTH_ROTATION (2.0*M_PI*1.00273790934)
+
+//surface velocity of the earth at the equator (km per day)
+#define PASS_SEARCH_EARTH_SURFACE_VELOCITY (PASS_SEARCH_EARTH_ROTATION*PASS_SEARCH_EARTH_RADIUS_EQUATOR)
+
+//gravitational parameter of the earth (km^3/s^2)
+#define PASS_SEARCH_GM 398600.8
+
+//number of seconds per day
+#define PASS_SEARCH_SECONDS_PER_DAY 86400.0
+
+//margin on the altitude range derived from the mean elements, covering periodic perturbations (km)
+#define PASS_SEARCH_ALTITUDE_MARGIN 50.0
+
+//margin on the horizon distance, covering the difference between geodetic and geocentric coordinates (radians, one degree)
+#define PASS_SEARCH_ANGLE_MARGIN (M_PI/180.0)
+
+//relative margin on the maximum rates
+#define PASS_SEARCH_RATE_MARGIN 0.1
+
+//number of coarse steps per orbit, used where the bounds cannot rule out a pass
+#define PASS_SEARCH_STEPS_PER_ORBIT 30
+
+/**
+ * Bounds on the motion of the satellite relative to the ground station, derived from the orbital elements.
+ **/
+struct pass_search_bounds {
+	///Angular distance between sub-satellite point and ground station beyond which the satellite cannot be above the horizon (radians)
+	double max_horizon_distance;
+	///Angular distance between sub-satellite point and ground station below which the satellite is always above the horizon (radians). Can be negative
+	double min_horizon_distance;
+	///Maximum angular rate of the sub-satellite point over the ground (radians per day)
+	double max_ground_track_rate;
+	///Maximum velocity of the satellite relative to the ground station (km per day)
+	double max_relative_velocity;
+	///Coarse time step (days)
+	double coarse_step;
+};
+
+/**
+ * State of satellite at a given time.
+ **/
+struct pass_search_sample {
+	///Time
+	predict_julian_date_t time;
+	///Elevation (radians)
+	double elevation;
+	///Elevation rate, as returned by predict_observe_orbit()
+	double elevation_rate;
+	///Range (km)
+	double range;
+	///Angular distance between sub-satellite point and ground station (radians)
+	double ground_distance;
+	///Whether the satellite has decayed
+	bool decayed;
+};
+
+/**
+ * Derive bounds on the motion of the satellite from the orbital elements.
+ *
+ * \param observer Ground station
+ * \param orbital_elements Orbital elements
+ * \param ret_bounds Returned bounds
+ **/
+void pass_search_calculate_bounds(const predict_observer_t *observer, const predict_orbital_elements_t *orbital_elements, struct pass_search_bounds *ret_bounds)
+{
+	double eccentricity = orbital_elements->eccentricity;
+	double semi_major_axis = 331.25*pow(1440.0/orbital_elements->mean_motion, 2.0/3.0);
+	double max_altitude = semi_major_axis*(1.0 + eccentricity) - PASS_SEARCH_EARTH_RADIUS_POLE + PASS_SEARCH_ALTITUDE_MARGIN;
+	double min_altitude = semi_major_axis*(1.0 - eccentricity) - PASS_SEARCH_EARTH_RADIUS_EQUATOR - PASS_SEARCH_ALTITUDE_MARGIN;
+	if (min_altitude < 0) {
+		min_altitude = 0;
+	}
+
+	//horizon distance, extended by the dip of the horizon for ground stations above sea level
+	double observer_altitude = (observer->altitude > 0) ? observer->altitude/1000.0 : 0;
+	ret_bounds->max_horizon_distance = acos(PASS_SEARCH_EARTH_RADIUS_POLE/(PASS_SEARCH_EARTH_RADIUS_POLE + max_altitude)) + acos(PASS_SEARCH_EARTH_RADIUS_POLE/(PASS_SEARCH_EARTH_RADIUS_POLE + observer_altitude)) + PASS_SEARCH_ANGLE_MARGIN;
+	ret_bounds->min_horizon_distance = acos(PASS_SEARCH_EARTH_RADIUS_EQUATOR/(PASS_SEARCH_EARTH_RADIUS_EQUATOR + min_altitude)) - PASS_SEARCH_ANGLE_MARGIN;
+
+	//angular rate and velocity are highest at perigee
+	double mean_motion = orbital_elements->mean_motion*2.0*M_PI;
+	double perigee_rate = mean_motion*pow(1.0 + eccentricity, 2.0)/pow(1.0 - eccentricity*eccentricity, 1.5);
+	ret_bounds->max_ground_track_rate = (perigee_rate + PASS_SEARCH_EARTH_ROTATION)*(1.0 + PASS_SEARCH_RATE_MARGIN);
+
+	double perigee_velocity = sqrt(PASS_SEARCH_GM*(1.0 + eccentricity)/(semi_major_axis*(1.0 - eccentricity)))*PASS_SEARCH_SECONDS_PER_DAY;
+	ret_bounds->max_relative_velocity = (perigee_velocity + PASS_SEARCH_EARTH_SURFACE_VELOCITY)*(1.0 + PASS_SEARCH_RATE_MARGIN);
+
+	ret_bounds->coarse_step = 1.0/(orbital_elements->mean_motion*PASS_SEARCH_STEPS_PER_ORBIT);
+}
+
+/**
+ * Propagate satellite and observe it from the ground station.
+ *
+ * \param observer Ground station
+ * \param orbital_elements Orbital elements
+ * \param time Time
+ * \param ret_sample Returned sample
+ **/
+void pass_search_sample(const predict_observer_t *observer, const predict_orbital_elements_t *orbital_elements, predict_julian_date_t time, struct pass_search_sample *ret_sample)
+{
+	struct predict_orbit orbit;
+	struct predict_observation obs;
+	predict_orbit(orbital_elements, &orbit, time);
+	predict_observe_orbit(observer, &orbit, &obs);
+
+	double cos_distance = sin(observer->latitude)*sin(orbit.latitude) + cos(observer->latitude)*cos(orbit.latitude)*cos(orbit.longitude - observer->longitude);
+	if (cos_distance > 1.0) {
+		cos_distance = 1.0;
+	} else if (cos_distance < -1.0) {
+		cos_distance = -1.0;
+	}
+
+	ret_sample->time = time;
+	ret_sample->elevation = obs.elevation;
+	ret_sample->elevation_rate = obs.elevation_rate;
+	ret_sample->range = obs.range;
+	ret_sample->ground_distance = acos(cos_distance);
+	ret_sample->decayed = orbit.decayed;
+}
+
+/**
+ * Calculate how far ahead the satellite is guaranteed to stay on the same side of the horizon.
+ *
+ * \param bounds Bounds on the motion of the satellite
+ * \param sample Current state of the satellite
+ * \return Time step (days), 0 if the satellite might cross the horizon at any time
+ **/
+double pass_search_safe_step(const struct pass_search_bounds *bounds, const struct pass_search_sample *sample)
+{
+	bool above_horizon = sample->elevation >= 0;
+
+	//time until the sub-satellite point can come within (or leave) the horizon distance
+	double ground_step = 0;
+	if (above_horizon) {
+		ground_step = (bounds->min_horizon_distance - sample->ground_distance)/bounds->max_ground_track_rate;
+	} else {
+		ground_step = (sample->ground_distance - bounds->max_horizon_distance)/bounds->max_ground_track_rate;
+	}
+
+	//time until the elevation can reach zero. The angular rate across the sky is at most the maximum relative
+	//velocity divided by the range, and the range shrinks at most with the maximum relative velocity, which
+	//integrates to a change in elevation of at most log(range/(range - velocity*step)). The local vertical of the
+	//ground station turns with the rotation of the earth, adding earth_rotation*step. The sum is convex in the
+	//step, so it stays below the chord through the step solving the first term alone, which gives a safe step
+	double elevation = fabs(sample->elevation);
+	double range_step = sample->range/bounds->max_relative_velocity*(1.0 - exp(-elevation));
+	double elevation_step = 0;
+	if (elevation > 0) {
+		elevation_step = range_step*elevation/(elevation + PASS_SEARCH_EARTH_ROTATION*range_step);
+	}
+
+	double step = (ground_step > elevation_step) ? ground_step : elevation_step;
+	if (!(step > 0)) {
+		step = 0;
+	}
+	return step;
+}
+
+/**
+ * Data passed to the elevation function and the stop check during the search for crossings and grazing passes.
+ **/
+struct pass_search_function_data {
+	///Ground station
+	const predict_observer_t *observer;
+	///Orbital elements
+	const predict_orbital_elements_t *orbital_elements;
+	///Bounds on the motion of the satellite
+	const struct pass_search_bounds *bounds;
+	///Last two evaluated samples, which are the two inner points of the golden-section search
+	struct pass_search_sample samples[2];
+	///Index in samples of the next sample to overwrite
+	int next_sample;
+};
+
+/**
+ * Elevation of the satellite as a function of time. Keeps the evaluated sample for the stop check.
+ *
+ * \param time Time
+ * \param data Pointer to struct pass_search_function_data
+ * \return Elevation (radians)
+ **/
+double pass_search_elevation(predict_julian_date_t time, void *data)
+{
+	struct pass_search_function_data *function_data = (struct pass_search_function_data*)data;
+	struct pass_search_sample *sample = &(function_data->samples[function_data->next_sample]);
+	pass_search_sample(function_data->observer, function_data->orbital_elements, time, sample);
+	function_data->next_sample = (function_data->next_sample + 1) % 2;
+	return sample->elevation;
+}
+
+/**
+ * Stop the search for a grazing pass as soon as a point above the horizon is found, or as soon as the bounds rule out
+ * that the satellite rises within the remaining interval.
+ *
+ * \param time Time of highest point found so far
+ * \param elevation Elevation at that time
+ * \param interval Length of the interval still searched
+ * \param data Pointer to struct pass_search_function_data
+ * \return True if the search should stop
+ **/
+bool pass_search_stop_grazing(predict_julian_date_t time, double elevation, double interval, void *data)
+{
+	if (elevation >= 0) {
+		return true;
+	}
+
+	//the bounds apply both forward and backward in time, so the highest sample rules out the whole interval
+	struct pass_search_function_data *function_data = (struct pass_search_function_data*)data;
+	for (int i=0; i < 2; i++) {
+		if (function_data->samples[i].time == time) {
+			return pass_search_safe_step(function_data->bounds, &(function_data->samples[i])) >= interval;
+		}
+	}
+	return false;
+}
+
+/**
+ * Search for a point above the horizon around a local maximum of the elevation below the horizon.
+ *
+ * \param function_data Elevation function data
+ * \param start Sample before the maximum, below the horizon
+ * \param end Sample after the maximum, below the horizon
+ * \param ret_time Returned time above the horizon
+ * \param ret_elevation Returned elevation at ret_time
+ * \return True if a point above the horizon was found, false if the satellite stays below the horizon between the samples
+ **/
+bool pass_search_find_grazing_pass(struct pass_search_function_data *function_data, const struct pass_search_sample *start, const struct pass_search_sample *end, predict_julian_date_t *ret_time, double *ret_elevation)
+{
+	*ret_elevation = solver_find_maximum(pass_search_elevation, pass_search_stop_grazing, (void*)function_data, start->time, end->time, PASS_SEARCH_TIME_TOLERANCE, ret_time);
+	return *ret_elevation >= 0;
+}
+
+/**
+ * Step forward from the given sample until the satellite is on the other side of the horizon, and find the crossing.
+ * Intervals in which the bounds rule out a crossing are skipped, and the remaining time is sampled at the coarse
+ * step. Local maxima of the elevation below the horizon are checked for grazing passes shorter than the coarse step.
+ *
+ * \param observer Ground station
+ * \param orbital_elements Orbital elements
+ * \param bounds Bounds on the motion of the satellite
+ * \param start Sample at start of search
+ * \param ret_time Returned time of crossing
+ * \return 0 on success, -1 if the satellite decays or does not cross the horizon within PASS_SEARCH_MAX_DAYS
+ **/
+int pass_search_next_crossing(const predict_observer_t *observer, const predict_orbital_elements_t *orbital_elements, const struct pass_search_bounds *bounds, const struct pass_search_sample *start, predict_julian_date_t *ret_time)
+{
+	struct pass_search_function_data function_data = {.observer = observer, .orbital_elements = orbital_elements, .bounds = bounds, .next_sample = 0};
+
+	bool above_horizon = start->elevation >= 0;
+	struct pass_search_sample before_previous = *start;
+	struct pass_search_sample previous = *start;
+	while (previous.time < start->time + PASS_SEARCH_MAX_DAYS) {
+		double safe_step = pass_search_safe_step(bounds, &previous);
+		double step = (safe_step > bounds->coarse_step) ? safe_step : bounds->coarse_step;
+
+		struct pass_search_sample current;
+		pass_search_sample(observer, orbital_elements, previous.time + step, &current);
+		if (current.decayed) {
+			return -1;
+		}
+
+		if ((current.elevation >= 0) != above_horizon) {
+			*ret_time = solver_find_root(pass_search_elevation, (void*)&function_data, previous.time, previous.elevation, current.time, current.elevation, PASS_SEARCH_TIME_TOLERANCE);
+			return 0;
+		}
+
+		//elevation peaks below the horizon at the samples, but the satellite might still rise briefly in between.
+		//Only checked when the bounds allow the satellite to reach the horizon from the peak sample
+		bool is_peak = (previous.time > before_previous.time) && (previous.elevation > before_previous.elevation) && (previous.elevation > current.elevation);
+		double peak_distance = ((current.time - previous.time) > (previous.time - before_previous.time)) ? current.time - previous.time : previous.time - before_previous.time;
+		const struct pass_search_sample *peak_start = &before_previous;
+
+		//no earlier sample in the first step, where a peak between the start and the first sample is found from the elevation rates
+		if (previous.time == before_previous.time) {
+			is_peak = (previous.elevation_rate > 0) && (current.elevation_rate < 0);
+			peak_distance = current.time - previous.time;
+			peak_start = &previous;
+		}
+
+		if (!above_horizon && is_peak && (safe_step < peak_distance)) {
+			predict_julian_date_t grazing_time;
+			double grazing_elevation;
+			if (pass_search_find_grazing_pass(&function_data, peak_start, &current, &grazing_time, &grazing_elevation)) {
+				*ret_time = solver_find_root(pass_search_elevation, (void*)&function_data, peak_start->time, peak_start->elevation, grazing_time, grazing_elevation, PASS_SEARCH_TIME_TOLERANCE);
+				return 0;
+			}
+		}
+
+		before_previous = previous;
+		previous = current;
+	}
+	return -1;
+}
+
+int pass_search_next_aos(const predict_observer_t *observer, const predict_orbital_elements_t *orbital_elements, predict_julian_date_t start_time, predict_julian_date_t *ret_aos)
+{
+	struct pass_search_bounds bounds;
+	pass_search_calculate_bounds(observer, orbital_elements, &bounds);
+
+	struct pass_search_sample sample;
+	pass_search_sample(observer, orbital_elements, start_time, &sample);
+	if (sample.decayed) {
+		return -1;
+	}
+
+	//skip ongoing pass
+	if (sample.elevation >= 0) {
+		predict_julian_date_t los;
+		if (pass_search_next_crossing(observer, orbital_elements, &bounds, &sample, &los) != 0) {
+			return -1;
+		}
+
+		//make sure to continue the search from below the horizon
+		pass_search_sample(observer, orbital_elements, los, &sample);
+		while ((sample.elevation >= 0) && !(sample.decayed)) {
+			pass_search_sample(observer, orbital_elements, sample.time + PASS_SEARCH_TIME_TOLERANCE, &sample);
+		}
+	}
+
+	return pass_search_next_crossing(observer, orbital_elements, &bounds, &sample, ret_aos);
+}
+
+int pass_search_next_los(const predict_observer_t *observer, const predict_orbital_elements_t *orbital_elements, predict_julian_date_t start_time, predict_julian_date_t *ret_los)
+{
+	struct pass_search_bounds bounds;
+	pass_search_calculate_bounds(observer, orbital_elements, &bounds);
+
+	struct pass_search_sample sample;
+	pass_search_sample(observer, orbital_elements, start_time, &sample);
+	if (sample.decayed) {
+		return -1;
+	}
+
+	//find the next pass first
+	if (sample.elevation < 0) {
+		predict_julian_date_t aos;
+		if (pass_search_next_crossing(observer, orbital_elements, &bounds, &sample, &aos) != 0) {
+			return -1;
+		}
+
+		//make sure to continue the search from above the horizon
+		pass_search_sample(observer, orbital_elements, aos, &sample);
+		while ((sample.elevation < 0) && !(sample.decayed)) {
+			pass_search_sample(observer, orbital_elements, sample.time + PASS_SEARCH_TIME_TOLERANCE, &sample);
+		}
+	}
+
+	return pass_search_next_crossing(observer, orbital_elements, &bounds, &sample, ret_los);
+}
@@ -0,0 +1,55 @@
+#ifndef PASS_SEARCH_H_DEFINED
+#define PASS_SEARCH_H_DEFINED
+
+#include <predict/predict.h>
+
+/**
+ * Search for AOS and LOS, replacing predict_next_aos() and predict_next_los().
+ *
+ * Most of the time, the satellite is far below the horizon, and no pass is possible for a good while. The search
+ * steps forward in time using two cheap upper bounds on how fast the satellite can approach the horizon, so that
+ * whole intervals in which the satellite cannot possibly be visible are skipped with a single propagation:
+ *
+ *  - Ground track bound: The satellite is only visible when the angular distance between the sub-satellite point
+ *    and the ground station is below the horizon distance for the highest possible altitude of the satellite. The
+ *    sub-satellite point moves at most with the angular rate of the satellite at perigee plus the rotation of the
+ *    earth, which gives the earliest time the satellite can come within the horizon distance.
+ *  - Elevation bound: Seen from the ground station, the satellite moves across the sky at most with its maximum
+ *    velocity relative to the ground station divided by its range, plus the rotation rate of the earth turning the
+ *    local horizon of the ground station, which gives the earliest time the elevation can reach zero.
+ *
+ * The longer of the two steps is taken, as both are safe. The crossing of the horizon is then bracketed between two
+ * propagations and refined using Brent's method. LOS is found the same way, with the bounds reversed.
+ **/
+
+//maximum time searched ahead for AOS (days)
+#define PASS_SEARCH_MAX_DAYS 30.0
+
+//time tolerance of AOS and LOS (days, one second)
+#define PASS_SEARCH_TIME_TOLERANCE (1.0/86400.0)
+
+/**
+ * Find next AOS after the given time. When the satellite is above the horizon at the given time, the AOS
+ * following the end of the ongoing pass is returned.
+ *
+ * \param observer Ground station
+ * \param orbital_elements Orbital elements of satellite
+ * \param start_time Start time of search
+ * \param ret_aos Returned AOS
+ * \return 0 on success, -1 if the satellite decays or does not rise within PASS_SEARCH_MAX_DAYS
+ **/
+int pass_search_next_aos(const predict_observer_t *observer, const predict_orbital_elements_t *orbital_elements, predict_julian_date_t start_time, predict_julian_date_t *ret_aos);
+
+/**
+ * Find next LOS after the given time. When the satellite is below the horizon at the given time, the LOS
+ * of the next pass is returned.
+ *
+ * \param observer Ground station
+ * \param orbital_elements Orbital elements of satellite
+ * \param start_time Start time of search
+ * \param ret_los Returned LOS
+ * \return 0 on success, -1 if the satellite decays or no LOS is found within PASS_SEARCH_MAX_DAYS
+ **/
+int pass_search_next_los(const predict_observer_t *observer, const predict_orbital_elements_t *orbital_elements, predict_julian_date_t start_time, predict_julian_date_t *ret_los);
+
+#endif
@@ -0,0 +1,180 @@
+#include "pass_search_benchmark.h"
+#include <stdlib.h>
+#include <math.h>
+#include <time.h>
+#include "pass_search.h"
+
+//number of seconds per day
+#define PASS_SEARCH_BENCHMARK_SECONDS_PER_DAY 86400.0
+
+//time after LOS at which the search for the next AOS is started, as in the pass table (days)
+#define PASS_SEARCH_BENCHMARK_LOS_MARGIN (1.0/86400.0)
+
+/**
+ * Passes found by one of the searches for a single satellite.
+ **/
+struct pass_search_benchmark_passes {
+	///Available size of `aos` and `los`
+	int available_size;
+	///Number of passes
+	int num_passes;
+	///AOS of each pass
+	predict_julian_date_t *aos;
+	///LOS of each pass
+	predict_julian_date_t *los;
+};
+
+/**
+ * Add pass to list of passes.
+ *
+ * \param passes List of passes
+ * \param aos AOS
+ * \param los LOS
+ **/
+void pass_search_benchmark_add_pass(struct pass_search_benchmark_passes *passes, predict_julian_date_t aos, predict_julian_date_t los)
+{
+	if (passes->num_passes >= passes->available_size) {
+		passes->available_size = (passes->available_size > 0) ? 2*passes->available_size : 16;
+		passes->aos = (predict_julian_date_t*)realloc(passes->aos, sizeof(predict_julian_date_t)*passes->available_size);
+		passes->los = (predict_julian_date_t*)realloc(passes->los, sizeof(predict_julian_date_t)*passes->available_size);
+	}
+	passes->aos[passes->num_passes] = aos;
+	passes->los[passes->num_passes] = los;
+	passes->num_passes++;
+}
+
+/**
+ * Get monotonic clock time.
+ *
+ * \return Time (seconds)
+ **/
+double pass_search_benchmark_clock()
+{
+	struct timespec now;
+	clock_gettime(CLOCK_MONOTONIC, &now);
+	return now.tv_sec + now.tv_nsec*1.0e-09;
+}
+
+/**
+ * Find all passes within the time window using libpredict.
+ *
+ * \param observer Ground station
+ * \param orbital_elements Orbital elements
+ * \param start_time Start of time window
+ * \param end_time End of time window
+ * \param passes Returned passes, appended to the list
+ **/
+void pass_search_benchmark_libpredict(const predict_observer_t *observer, const predict_orbital_elements_t *orbital_elements, predict_julian_date_t start_time, predict_julian_date_t end_time, struct pass_search_benchmark_passes *passes)
+{
+	predict_julian_date_t time = start_time;
+	while (time < end_time) {
+		predict_julian_date_t aos = predict_next_aos(observer, orbital_elements, time);
+		if ((aos <= time) || (aos >= end_time)) {
+			break;
+		}
+		predict_julian_date_t los = predict_next_los(observer, orbital_elements, aos);
+		if (los <= aos) {
+			break;
+		}
+		pass_search_benchmark_add_pass(passes, aos, los);
+		time = los + PASS_SEARCH_BENCHMARK_LOS_MARGIN;
+	}
+}
+
+/**
+ * Find all passes within the time window using the pass search.
+ *
+ * \param observer Ground station
+ * \param orbital_elements Orbital elements
+ * \param start_time Start of time window
+ * \param end_time End of time window
+ * \param passes Returned passes, appended to the list
+ **/
+void pass_search_benchmark_pass_search(const predict_observer_t *observer, const predict_orbital_elements_t *orbital_elements, predict_julian_date_t start_time, predict_julian_date_t end_time, struct pass_search_benchmark_passes *passes)
+{
+	predict_julian_date_t time = start_time;
+	while (time < end_time) {
+		predict_julian_date_t aos, los;
+		if ((pass_search_next_aos(observer, orbital_elements, time, &aos) != 0) || (aos >= end_time)) {
+			break;
+		}
+		if (pass_search_next_los(observer, orbital_elements, aos, &los) != 0) {
+			break;
+		}
+		pass_search_benchmark_add_pass(passes, aos, los);
+		time = los + PASS_SEARCH_BENCHMARK_LOS_MARGIN;
+	}
+}
+
+int pass_search_benchmark_run(const predict_observer_t *observer, const struct tle_db *tle_db, const int *tle_indices, int num_tles, predict_julian_date_t start_time, predict_julian_date_t end_time, output_sink_t *output)
+{
+	int num_satellites = 0;
+	int num_matched = 0;
+	double libpredict_time = 0;
+	double pass_search_time = 0;
+	double max_aos_difference = 0;
+	double max_los_difference = 0;
+	struct pass_search_benchmark_passes libpredict_passes = {0};
+	struct pass_search_benchmark_passes pass_search_passes = {0};
+
+	for (int i=0; i < num_tles; i++) {
+		predict_orbital_elements_t *orbital_elements = tle_db_entry_to_orbital_elements(tle_db, tle_indices[i]);
+		if (orbital_elements == NULL) {
+			free(libpredict_passes.aos);
+			free(libpredict_passes.los);
+			free(pass_search_passes.aos);
+			free(pass_search_passes.los);
+			return -1;
+		}
+
+		//same satellites as left out by the pass table
+		if (predict_is_geostationary(orbital_elements) || !predict_aos_happens(orbital_elements, observer->latitude)) {
+			predict_destroy_orbital_elements(orbital_elements);
+			continue;
+		}
+		num_satellites++;
+
+		int libpredict_start = libpredict_passes.num_passes;
+		double clock_start = pass_search_benchmark_clock();
+		pass_search_benchmark_libpredict(observer, orbital_elements, start_time, end_time, &libpredict_passes);
+		libpredict_time += pass_search_benchmark_clock() - clock_start;
+
+		int pass_search_start = pass_search_passes.num_passes;
+		clock_start = pass_search_benchmark_clock();
+		pass_search_benchmark_pass_search(observer, orbital_elements, start_time, end_time, &pass_search_passes);
+		pass_search_time += pass_search_benchmark_clock() - clock_start;
+
+		//match passes that overlap, libpredict can report grazing passes the pass search leaves out and vice versa
+		int j = libpredict_start;
+		int k = pass_search_start;
+		while ((j < libpredict_passes.num_passes) && (k < pass_search_passes.num_passes)) {
+			if (libpredict_passes.los[j] < pass_search_passes.aos[k]) {
+				j++;
+			} else if (pass_search_passes.los[k] < libpredict_passes.aos[j]) {
+				k++;
+			} else {
+				double aos_difference = fabs(libpredict_passes.aos[j] - pass_search_passes.aos[k]);
+				double los_difference = fabs(libpredict_passes.los[j] - pass_search_passes.los[k]);
+				max_aos_difference = (aos_difference > max_aos_difference) ? aos_difference : max_aos_difference;
+				max_los_difference = (los_difference > max_los_difference) ? los_difference : max_los_difference;
+				num_matched++;
+				j++;
+				k++;
+			}
+		}
+
+		predict_destroy_orbital_elements(orbital_elements);
+	}
+
+	output_sink_printf(output, "Satellites: %d, window: %.1f hours\n", num_satellites, (end_time - start_time)*24.0);
+	output_sink_printf(output, "predict_next_aos/los: %d passes in %.3f s\n", libpredict_passes.num_passes, libpredict_time);
+	output_sink_printf(output, "pass_search_next_aos/los: %d passes in %.3f s\n", pass_search_passes.num_passes, pass_search_time);
+	output_sink_printf(output, "Matched passes: %d, max AOS difference: %.1f s, max LOS difference: %.1f s\n", num_matched, max_aos_difference*PASS_SEARCH_BENCHMARK_SECONDS_PER_DAY, max_los_difference*PASS_SEARCH_BENCHMARK_SECONDS_PER_DAY);
+	output_sink_flush(output);
+
+	free(libpredict_passes.aos);
+	free(libpredict_passes.los);
+	free(pass_search_passes.aos);
+	free(pass_search_passes.los);
+	return 0;
+}
@@ -0,0 +1,30 @@
+#ifndef PASS_SEARCH_BENCHMARK_H_DEFINED
+#define PASS_SEARCH_BENCHMARK_H_DEFINED
+
+#include <predict/predict.h>
+#include "tle_db.h"
+#include "output_sink.h"
+
+/**
+ * Benchmark of the pass search against libpredict, used for the --benchmark-pass-search command line mode.
+ * All passes of the selected satellites within the time window are found twice, once with predict_next_aos()
+ * and predict_next_los() and once with pass_search_next_aos() and pass_search_next_los(), on a single thread.
+ * The number of passes, the time spent by each search and the largest difference in AOS and LOS between passes
+ * found by both searches are written to the output sink.
+ **/
+
+/**
+ * Time both pass searches over the given satellites and time window.
+ *
+ * \param observer Ground station
+ * \param tle_db TLE database
+ * \param tle_indices Indices of satellites in the TLE database
+ * \param num_tles Number of satellites
+ * \param start_time Start of time window
+ * \param end_time End of time window
+ * \param output Output sink
+ * \return 0 on success, -1 if the orbital elements of a satellite could not be created
+ **/
+int pass_search_benchmark_run(const predict_observer_t *observer, const struct tle_db *tle_db, const int *tle_indices, int num_tles, predict_julian_date_t start_time, predict_julian_date_t end_time, output_sink_t *output);
+
+#endif
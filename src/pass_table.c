@@ -0,0 +1,250 @@
+#include "pass_table.h"
+#include <stdlib.h>
+#include <string.h>
+#include "pass_search.h"
+#include "solver.h"
+
+//initial number of entries in pass array
+#define PASS_TABLE_INITIAL_SIZE 4
+
+//time resolution of the search for time of closest approach (days, one second)
+#define PASS_TABLE_TCA_TOLERANCE (1.0/86400.0)
+
+//time step past LOS before searching for the next AOS (days, one second)
+#define PASS_TABLE_LOS_MARGIN (1.0/86400.0)
+
+pass_table_t *pass_table_create(const predict_observer_t *observer, const predict_orbital_elements_t *orbital_elements)
+{
+	pass_table_t *table = (pass_table_t*)malloc(sizeof(pass_table_t));
+	memset(table, 0, sizeof(pass_table_t));
+	table->observer = observer;
+	table->orbital_elements = orbital_elements;
+	return table;
+}
+
+void pass_table_destroy(pass_table_t **table)
+{
+	ephemeris_cache_destroy(&((*table)->ephemeris));
+	free((*table)->passes);
+	free(*table);
+	*table = NULL;
+}
+
+bool pass_table_can_predict(const pass_table_t *table, predict_julian_date_t time)
+{
+	if (predict_is_geostationary(table->orbital_elements) || !predict_aos_happens(table->orbital_elements, table->observer->latitude)) {
+		return false;
+	}
+
+	struct predict_orbit orbit;
+	predict_orbit(table->orbital_elements, &orbit, time);
+	return !(orbit.decayed);
+}
+
+/**
+ * Calculate elevation of satellite. Uses the interpolated ephemeris, unless the satellite decays close to the given time.
+ * The ephemeris is allocated on first use.
+ *
+ * \param table Pass table
+ * \param time Time
+ * \return Elevation (radians)
+ **/
+double pass_table_elevation(pass_table_t *table, predict_julian_date_t time)
+{
+	if (table->ephemeris == NULL) {
+		table->ephemeris = ephemeris_cache_create(table->orbital_elements, EPHEMERIS_CACHE_DEFAULT_STEP);
+	}
+
+	struct predict_observation obs;
+	if (ephemeris_cache_observe(table->ephemeris, table->observer, time, &obs) == 0) {
+		return obs.elevation;
+	}
+
+	struct predict_orbit orbit;
+	predict_orbit(table->orbital_elements, &orbit, time);
+	predict_observe_orbit(table->observer, &orbit, &obs);
+	return obs.elevation;
+}
+
+/**
+ * Elevation of satellite, for the solver.
+ *
+ * \param time Time
+ * \param data Pass table
+ * \return Elevation (radians)
+ **/
+double pass_table_elevation_function(predict_julian_date_t time, void *data)
+{
+	return pass_table_elevation((pass_table_t*)data, time);
+}
+
+/**
+ * Find time of closest approach and maximum elevation of pass using golden-section search between AOS and LOS.
+ * Assumes elevation to have a single maximum within the pass.
+ *
+ * \param table Pass table
+ * \param pass Pass with AOS and LOS set. TCA and maximum elevation are set on return
+ **/
+void pass_table_find_tca(pass_table_t *table, struct pass_table_pass *pass)
+{
+	pass->max_elevation = solver_find_maximum(pass_table_elevation_function, NULL, (void*)table, pass->aos, pass->los, PASS_TABLE_TCA_TOLERANCE, &(pass->tca));
+}
+
+/**
+ * Clear tabulated passes and restart the search at the given time.
+ *
+ * \param table Pass table
+ * \param time New start time
+ **/
+void pass_table_restart(pass_table_t *table, predict_julian_date_t time)
+{
+	table->num_passes = 0;
+	table->start_time = time;
+	table->end_time = time;
+	table->started = true;
+}
+
+/**
+ * Search for the next pass after the last tabulated pass and add it to the table.
+ *
+ * \param table Pass table
+ * \return 0 on success, -1 if no further passes can be predicted
+ **/
+int pass_table_add_next_pass(pass_table_t *table)
+{
+	if (!pass_table_can_predict(table, table->end_time)) {
+		return -1;
+	}
+
+	struct pass_table_pass pass;
+	if ((table->num_passes == 0) && (pass_table_elevation(table, table->end_time) >= 0)) {
+		//table starts within a pass
+		pass.aos = table->end_time;
+	} else {
+		predict_julian_date_t search_time = table->end_time;
+		if (table->num_passes > 0) {
+			search_time += PASS_TABLE_LOS_MARGIN;
+		}
+		if (pass_search_next_aos(table->observer, table->orbital_elements, search_time, &(pass.aos)) != 0) {
+			return -1;
+		}
+		if (!pass_table_can_predict(table, pass.aos)) {
+			return -1;
+		}
+	}
+	if (pass_search_next_los(table->observer, table->orbital_elements, pass.aos, &(pass.los)) != 0) {
+		return -1;
+	}
+	pass_table_find_tca(table, &pass);
+
+	if (table->num_passes >= table->available_size) {
+		int available_size = (table->available_size > 0) ? table->available_size*2 : PASS_TABLE_INITIAL_SIZE;
+		struct pass_table_pass *passes = (struct pass_table_pass*)realloc(table->passes, sizeof(struct pass_table_pass)*available_size);
+		if (passes == NULL) {
+			return -1;
+		}
+		table->passes = passes;
+		table->available_size = available_size;
+	}
+	table->passes[table->num_passes] = pass;
+	table->num_passes++;
+	table->end_time = pass.los;
+	return 0;
+}
+
+/**
+ * Search for passes after the last tabulated pass until the given number of passes is tabulated. The interpolated
+ * ephemeris is freed when the search is done, so that idle tables do not hold on to it.
+ *
+ * \param table Pass table
+ * \param num_passes Number of passes
+ * \return Number of tabulated passes, less than `num_passes` if no further passes can be predicted
+ **/
+int pass_table_search(pass_table_t *table, int num_passes)
+{
+	while (table->num_passes < num_passes) {
+		if (pass_table_add_next_pass(table) != 0) {
+			break;
+		}
+	}
+	ephemeris_cache_destroy(&(table->ephemeris));
+	return table->num_passes;
+}
+
+int pass_table_extend(pass_table_t *table, predict_julian_date_t time, int num_passes)
+{
+	if (!(table->started) || (time < table->start_time)) {
+		pass_table_restart(table, time);
+	}
+
+	//drop passes that have ended
+	int num_ended = 0;
+	while ((num_ended < table->num_passes) && (table->passes[num_ended].los < time)) {
+		num_ended++;
+	}
+	if (num_ended > 0) {
+		memmove(table->passes, table->passes + num_ended, sizeof(struct pass_table_pass)*(table->num_passes - num_ended));
+		table->num_passes -= num_ended;
+		table->start_time = time;
+	}
+	if ((table->num_passes == 0) && (table->end_time < time)) {
+		pass_table_restart(table, time);
+	}
+
+	pass_table_search(table, num_passes);
+	return (table->num_passes < num_passes) ? table->num_passes : num_passes;
+}
+
+const struct pass_table_pass *pass_table_next_pass(pass_table_t *table, predict_julian_date_t time)
+{
+	if (pass_table_extend(table, time, 1) < 1) {
+		return NULL;
+	}
+	return &(table->passes[0]);
+}
+
+const struct pass_table_pass *pass_table_next_aos(pass_table_t *table, predict_julian_date_t time)
+{
+	if (pass_table_extend(table, time, 1) < 1) {
+		return NULL;
+	}
+	if (table->passes[0].aos > time) {
+		return &(table->passes[0]);
+	}
+
+	//ongoing pass, use the one following it
+	if (pass_table_extend(table, time, 2) < 2) {
+		return NULL;
+	}
+	return &(table->passes[1]);
+}
+
+bool pass_table_covers(const pass_table_t *table, predict_julian_date_t time)
+{
+	return table->started && (time >= table->start_time) && (time <= table->end_time);
+}
+
+int pass_table_find_pass(pass_table_t *table, predict_julian_date_t time, bool skip_ongoing)
+{
+	if (!pass_table_covers(table, time)) {
+		pass_table_restart(table, time);
+	}
+
+	for (int i=0; ; i++) {
+		const struct pass_table_pass *pass = pass_table_get_pass(table, i);
+		if (pass == NULL) {
+			return -1;
+		}
+		if ((pass->los >= time) && !(skip_ongoing && (pass->aos <= time))) {
+			return i;
+		}
+	}
+}
+
+const struct pass_table_pass *pass_table_get_pass(pass_table_t *table, int index)
+{
+	if ((index < 0) || (pass_table_search(table, index + 1) <= index)) {
+		return NULL;
+	}
+	return &(table->passes[index]);
+}
@@ -0,0 +1,150 @@
+#ifndef PASS_TABLE_H_DEFINED
+#define PASS_TABLE_H_DEFINED
+
+#include <predict/predict.h>
+#include <stdbool.h>
+#include "ephemeris_cache.h"
+
+/**
+ * Table of upcoming passes of a satellite over a ground station. Passes are found once and kept,
+ * so that all screens showing AOS/LOS times for the same satellite can reuse the same search results.
+ * The table is extended lazily forward in time when passes beyond the last tabulated pass are requested,
+ * and passes that have ended are dropped as time moves on.
+ *
+ * Screens that page through passes, or look up passes while the table is shared with other screens, use
+ * pass_table_find_pass() and pass_table_get_pass() instead. These extend the table without dropping passes.
+ *
+ * A pass table is not thread-safe, and should only be used from one thread at a time.
+ **/
+
+//default number of passes tabulated ahead of the current time
+#define PASS_TABLE_DEFAULT_NUM_PASSES 3
+
+/**
+ * Satellite pass.
+ **/
+struct pass_table_pass {
+	///Acquisition of signal. Set to the start time of the table when the table starts within the pass
+	predict_julian_date_t aos;
+	///Time of closest approach, i.e. time of maximum elevation
+	predict_julian_date_t tca;
+	///Loss of signal
+	predict_julian_date_t los;
+	///Maximum elevation during pass (radians)
+	double max_elevation;
+};
+
+/**
+ * Pass table.
+ **/
+typedef struct {
+	///Ground station. Not owned by the pass table
+	const predict_observer_t *observer;
+	///Orbital elements of satellite. Not owned by the pass table
+	const predict_orbital_elements_t *orbital_elements;
+	///Interpolated ephemeris, used for the many elevation evaluations within each pass. Only allocated while searching for passes, NULL otherwise
+	ephemeris_cache_t *ephemeris;
+	///Time from which the table is valid. Passes ending before this time have been dropped
+	predict_julian_date_t start_time;
+	///Time up to which passes have been searched for, i.e. LOS of the last tabulated pass
+	predict_julian_date_t end_time;
+	///Whether any passes have been searched for yet
+	bool started;
+	///Number of tabulated passes
+	int num_passes;
+	///Available size in `passes` array
+	int available_size;
+	///Tabulated passes, in chronological order
+	struct pass_table_pass *passes;
+} pass_table_t;
+
+/**
+ * Create empty pass table. No passes are searched for until requested.
+ *
+ * \param observer Ground station. Has to outlive the pass table
+ * \param orbital_elements Orbital elements. Has to outlive the pass table
+ * \return Pass table
+ **/
+pass_table_t *pass_table_create(const predict_observer_t *observer, const predict_orbital_elements_t *orbital_elements);
+
+/**
+ * Destroy pass table.
+ *
+ * \param table Pass table, set to NULL
+ **/
+void pass_table_destroy(pass_table_t **table);
+
+/**
+ * Check whether passes can be predicted for the satellite at all, i.e. the satellite is not geostationary,
+ * can rise above the horizon of the ground station and has not decayed.
+ *
+ * \param table Pass table
+ * \param time Time at which to check for decay
+ * \return True if passes can be predicted
+ **/
+bool pass_table_can_predict(const pass_table_t *table, predict_julian_date_t time);
+
+/**
+ * Make sure that at least the specified number of passes ending after the given time are tabulated,
+ * searching for new passes when necessary. Passes that have ended before the given time are dropped.
+ * Starts the table over when the given time lies before the start time of the table.
+ *
+ * \param table Pass table
+ * \param time Time
+ * \param num_passes Number of passes
+ * \return Number of passes available from the given time, less than `num_passes` if the satellite decays or passes cannot be predicted
+ **/
+int pass_table_extend(pass_table_t *table, predict_julian_date_t time, int num_passes);
+
+/**
+ * Get the pass that is ongoing at the given time, or the next pass if the satellite is below the horizon.
+ * Used for obtaining the next LOS.
+ *
+ * \param table Pass table
+ * \param time Time
+ * \return Pass, NULL if no pass can be predicted. Valid until the pass table is next extended
+ **/
+const struct pass_table_pass *pass_table_next_pass(pass_table_t *table, predict_julian_date_t time);
+
+/**
+ * Get the first pass starting after the given time, skipping any ongoing pass. Used for obtaining the next AOS.
+ *
+ * \param table Pass table
+ * \param time Time
+ * \return Pass, NULL if no pass can be predicted. Valid until the pass table is next extended
+ **/
+const struct pass_table_pass *pass_table_next_aos(pass_table_t *table, predict_julian_date_t time);
+
+/**
+ * Check whether the given time lies within the time span searched for passes so far, so that passes can be
+ * looked up from the given time without starting the table over.
+ *
+ * \param table Pass table
+ * \param time Time
+ * \return True if the table has been started and the time lies between its start time and the LOS of its last pass
+ **/
+bool pass_table_covers(const pass_table_t *table, predict_julian_date_t time);
+
+/**
+ * Get index of the pass that is ongoing at the given time or the next pass, without dropping passes that have
+ * ended. Starts the table over at the given time when the table has not been started, or when the given time
+ * lies outside the time span searched so far.
+ *
+ * \param table Pass table
+ * \param time Time
+ * \param skip_ongoing Whether to skip a pass that is ongoing at the given time, for obtaining the next AOS
+ * \return Index of pass for pass_table_get_pass(), -1 if no pass can be predicted
+ **/
+int pass_table_find_pass(pass_table_t *table, predict_julian_date_t time, bool skip_ongoing);
+
+/**
+ * Get pass by index, searching for further passes when necessary. Passes are not dropped, so that indices stay
+ * valid until the table is next started over or extended using pass_table_extend().
+ *
+ * \param table Pass table
+ * \param index Index of pass, as obtained from pass_table_find_pass() and counted onwards
+ * \return Pass, NULL if no pass can be predicted. Valid until the pass table is next extended
+ **/
+const struct pass_table_pass *pass_table_get_pass(pass_table_t *table, int index);
+
+#endif
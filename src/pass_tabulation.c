@@ -0,0 +1,220 @@
+#include "pass_tabulation.h"
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+//number of seconds per day
+#define PASS_TABULATION_SECONDS_PER_DAY 86400.0
+
+//shortest time between rows (days, one second)
+#define PASS_TABULATION_MIN_STEP (1.0/PASS_TABULATION_SECONDS_PER_DAY)
+
+//longest time between rows in the angular step mode (days, ten minutes)
+#define PASS_TABULATION_MAX_STEP (600.0/PASS_TABULATION_SECONDS_PER_DAY)
+
+//rows closer than this to the next event are replaced by the event (days, one second)
+#define PASS_TABULATION_EVENT_MARGIN (1.0/PASS_TABULATION_SECONDS_PER_DAY)
+
+//maximum angular distance between rows in the angular step mode, relative to the requested step
+#define PASS_TABULATION_MAX_STEP_RATIO 1.5
+
+//maximum number of times a step is shortened in the angular step mode
+#define PASS_TABULATION_MAX_REJECTIONS 5
+
+//time after AOS at which the initial angular rate is measured (days, one second)
+#define PASS_TABULATION_RATE_PROBE (1.0/PASS_TABULATION_SECONDS_PER_DAY)
+
+void pass_tabulation_start(pass_tabulation_t *tabulation, const predict_observer_t *observer, const predict_orbital_elements_t *orbital_elements, const struct pass_table_pass *pass, enum pass_tabulation_mode mode, double step)
+{
+	tabulation->observer = observer;
+	tabulation->orbital_elements = orbital_elements;
+	tabulation->mode = mode;
+	tabulation->pass = *pass;
+	tabulation->num_rows = 0;
+	tabulation->next_event = PASS_TABULATION_AOS;
+	tabulation->finished = false;
+	tabulation->previous_time = pass->aos;
+	tabulation->previous_azimuth = 0;
+	tabulation->previous_elevation = 0;
+	tabulation->angular_rate = 0;
+
+	switch (mode) {
+		case PASS_TABULATION_FIXED_STEP:
+			tabulation->step = step/PASS_TABULATION_SECONDS_PER_DAY;
+			break;
+		case PASS_TABULATION_ANGULAR_STEP:
+			tabulation->step = step*M_PI/180.0;
+			break;
+		case PASS_TABULATION_EVENTS:
+			tabulation->step = 0;
+			break;
+	}
+}
+
+/**
+ * Calculate angle between two directions on the sky.
+ *
+ * \param azimuth_1 Azimuth of first direction (radians)
+ * \param elevation_1 Elevation of first direction (radians)
+ * \param azimuth_2 Azimuth of second direction (radians)
+ * \param elevation_2 Elevation of second direction (radians)
+ * \return Angle (radians)
+ **/
+double pass_tabulation_angular_distance(double azimuth_1, double elevation_1, double azimuth_2, double elevation_2)
+{
+	double cos_distance = sin(elevation_1)*sin(elevation_2) + cos(elevation_1)*cos(elevation_2)*cos(azimuth_1 - azimuth_2);
+	if (cos_distance > 1.0) {
+		cos_distance = 1.0;
+	} else if (cos_distance < -1.0) {
+		cos_distance = -1.0;
+	}
+	return acos(cos_distance);
+}
+
+/**
+ * Get time of event.
+ *
+ * \param tabulation Tabulation
+ * \param event Event
+ * \return Time of event
+ **/
+predict_julian_date_t pass_tabulation_event_time(const pass_tabulation_t *tabulation, enum pass_tabulation_event event)
+{
+	switch (event) {
+		case PASS_TABULATION_AOS:
+			return tabulation->pass.aos;
+		case PASS_TABULATION_TCA:
+			return tabulation->pass.tca;
+		default:
+			return tabulation->pass.los;
+	}
+}
+
+/**
+ * Propagate satellite and observe it from the ground station.
+ *
+ * \param tabulation Tabulation
+ * \param time Time
+ * \param ret_orbit Returned orbit
+ * \param ret_observation Returned observation
+ **/
+void pass_tabulation_observe(const pass_tabulation_t *tabulation, predict_julian_date_t time, struct predict_orbit *ret_orbit, struct predict_observation *ret_observation)
+{
+	predict_orbit(tabulation->orbital_elements, ret_orbit, time);
+	predict_observe_orbit(tabulation->observer, ret_orbit, ret_observation);
+}
+
+bool pass_tabulation_next(pass_tabulation_t *tabulation, struct pass_tabulation_row *ret_row)
+{
+	//LOS is always the last row
+	if (tabulation->finished) {
+		return false;
+	}
+
+	//skip events coinciding with the previous row, e.g. TCA at AOS for passes starting at maximum elevation
+	predict_julian_date_t event_time = pass_tabulation_event_time(tabulation, tabulation->next_event);
+	while ((tabulation->num_rows > 0) && (tabulation->next_event != PASS_TABULATION_LOS) && (event_time <= tabulation->previous_time)) {
+		tabulation->next_event++;
+		event_time = pass_tabulation_event_time(tabulation, tabulation->next_event);
+	}
+
+	//time of next row according to the tabulation mode
+	predict_julian_date_t time = event_time;
+	if (tabulation->num_rows > 0) {
+		double step = 0;
+		switch (tabulation->mode) {
+			case PASS_TABULATION_FIXED_STEP:
+				step = tabulation->step;
+				break;
+			case PASS_TABULATION_ANGULAR_STEP:
+				step = (tabulation->angular_rate > 0) ? tabulation->step/tabulation->angular_rate : PASS_TABULATION_MAX_STEP;
+				if (step > PASS_TABULATION_MAX_STEP) {
+					step = PASS_TABULATION_MAX_STEP;
+				}
+				break;
+			case PASS_TABULATION_EVENTS:
+				step = event_time - tabulation->previous_time;
+				break;
+		}
+		if (step < PASS_TABULATION_MIN_STEP) {
+			step = PASS_TABULATION_MIN_STEP;
+		}
+		time = tabulation->previous_time + step;
+	}
+
+	//snap to the next event when the row would pass or come close to it
+	enum pass_tabulation_event event = PASS_TABULATION_STEP;
+	if (time >= event_time - PASS_TABULATION_EVENT_MARGIN) {
+		time = event_time;
+		event = tabulation->next_event;
+	}
+	pass_tabulation_observe(tabulation, time, &(ret_row->orbit), &(ret_row->observation));
+
+	//reject steps that went too far along the track when the angular rate picks up, and retry with a shorter step
+	if ((tabulation->mode == PASS_TABULATION_ANGULAR_STEP) && (tabulation->num_rows > 0)) {
+		for (int i=0; i < PASS_TABULATION_MAX_REJECTIONS; i++) {
+			double distance = pass_tabulation_angular_distance(ret_row->observation.azimuth, ret_row->observation.elevation, tabulation->previous_azimuth, tabulation->previous_elevation);
+			double step = time - tabulation->previous_time;
+			if ((distance <= PASS_TABULATION_MAX_STEP_RATIO*tabulation->step) || (step <= PASS_TABULATION_MIN_STEP)) {
+				break;
+			}
+			step = step*tabulation->step/distance;
+			if (step < PASS_TABULATION_MIN_STEP) {
+				step = PASS_TABULATION_MIN_STEP;
+			}
+			time = tabulation->previous_time + step;
+			event = PASS_TABULATION_STEP;
+			pass_tabulation_observe(tabulation, time, &(ret_row->orbit), &(ret_row->observation));
+		}
+	}
+
+	if (event == PASS_TABULATION_LOS) {
+		tabulation->finished = true;
+	} else if (event != PASS_TABULATION_STEP) {
+		tabulation->next_event++;
+	}
+	ret_row->time = time;
+	ret_row->event = event;
+
+	//angular rate across the sky, used for choosing the next step
+	if (tabulation->mode == PASS_TABULATION_ANGULAR_STEP) {
+		if (tabulation->num_rows == 0) {
+			struct predict_orbit probe_orbit;
+			struct predict_observation probe;
+			pass_tabulation_observe(tabulation, time + PASS_TABULATION_RATE_PROBE, &probe_orbit, &probe);
+			tabulation->angular_rate = pass_tabulation_angular_distance(ret_row->observation.azimuth, ret_row->observation.elevation, probe.azimuth, probe.elevation)/PASS_TABULATION_RATE_PROBE;
+		} else if (time > tabulation->previous_time) {
+			tabulation->angular_rate = pass_tabulation_angular_distance(ret_row->observation.azimuth, ret_row->observation.elevation, tabulation->previous_azimuth, tabulation->previous_elevation)/(time - tabulation->previous_time);
+		}
+	}
+
+	tabulation->previous_time = time;
+	tabulation->previous_azimuth = ret_row->observation.azimuth;
+	tabulation->previous_elevation = ret_row->observation.elevation;
+	tabulation->num_rows++;
+	return true;
+}
+
+int pass_tabulation_parse_step(const char *string, enum pass_tabulation_mode *ret_mode, double *ret_step)
+{
+	if (strcmp(string, "events") == 0) {
+		*ret_mode = PASS_TABULATION_EVENTS;
+		*ret_step = 0;
+		return 0;
+	}
+
+	char *unit = NULL;
+	double step = strtod(string, &unit);
+	if ((unit == string) || !(step > 0)) {
+		return -1;
+	}
+	if (strcmp(unit, "s") == 0) {
+		*ret_mode = PASS_TABULATION_FIXED_STEP;
+	} else if (strcmp(unit, "deg") == 0) {
+		*ret_mode = PASS_TABULATION_ANGULAR_STEP;
+	} else {
+		return -1;
+	}
+	*ret_step = step;
+	return 0;
+}
@@ -0,0 +1,127 @@
+#ifndef PASS_TABULATION_H_DEFINED
+#define PASS_TABULATION_H_DEFINED
+
+#include <predict/predict.h>
+#include <stdbool.h>
+#include "pass_table.h"
+
+/**
+ * Tabulation of the satellite state through a single pass, for printing pass predictions. Rows are produced
+ * one at a time, always including AOS, TCA and LOS, and in between according to the tabulation mode.
+ *
+ * In the fixed step mode, rows are spaced evenly in time, and each row costs a single propagation. In the angular
+ * step mode, the time to the next row is chosen from the angular rate of the satellite across the sky between the
+ * two previous rows, so that rows are spread evenly along the track of the satellite rather than in time. A row
+ * usually costs a single propagation there as well, but the first row costs an extra propagation for measuring the
+ * initial angular rate, and a row that lands too far along the track is propagated again with a shorter step, up
+ * to a few times.
+ **/
+
+//default angular distance between rows in the angular step mode (degrees)
+#define PASS_TABULATION_DEFAULT_ANGULAR_STEP 10.0
+
+//default time between rows in the fixed step mode (seconds)
+#define PASS_TABULATION_DEFAULT_TIME_STEP 60.0
+
+/**
+ * Which rows to tabulate in addition to AOS, TCA and LOS.
+ **/
+enum pass_tabulation_mode {
+	///Rows at fixed time steps
+	PASS_TABULATION_FIXED_STEP,
+	///Rows at fixed angular distance along the track of the satellite across the sky
+	PASS_TABULATION_ANGULAR_STEP,
+	///Only AOS, TCA and LOS
+	PASS_TABULATION_EVENTS
+};
+
+/**
+ * Event at which a row was tabulated.
+ **/
+enum pass_tabulation_event {
+	///Acquisition of signal
+	PASS_TABULATION_AOS,
+	///Time of closest approach, i.e. maximum elevation
+	PASS_TABULATION_TCA,
+	///Loss of signal
+	PASS_TABULATION_LOS,
+	///Intermediate row, according to the tabulation mode
+	PASS_TABULATION_STEP
+};
+
+/**
+ * Tabulated row.
+ **/
+struct pass_tabulation_row {
+	///Time of row
+	predict_julian_date_t time;
+	///Event at which the row was tabulated
+	enum pass_tabulation_event event;
+	///Satellite orbit at the time of the row
+	struct predict_orbit orbit;
+	///Observation of satellite at the time of the row
+	struct predict_observation observation;
+};
+
+/**
+ * Tabulation of a pass in progress.
+ **/
+typedef struct {
+	///Ground station. Not owned by the tabulation
+	const predict_observer_t *observer;
+	///Orbital elements of satellite. Not owned by the tabulation
+	const predict_orbital_elements_t *orbital_elements;
+	///Tabulation mode
+	enum pass_tabulation_mode mode;
+	///Distance between rows, in days for the fixed step mode and radians for the angular step mode
+	double step;
+	///Pass to tabulate
+	struct pass_table_pass pass;
+	///Number of rows produced so far
+	int num_rows;
+	///Next event to tabulate
+	enum pass_tabulation_event next_event;
+	///Whether LOS has been tabulated
+	bool finished;
+	///Time of previous row
+	predict_julian_date_t previous_time;
+	///Azimuth and elevation of previous row (radians)
+	double previous_azimuth, previous_elevation;
+	///Angular rate of the satellite across the sky at the previous row (radians per day)
+	double angular_rate;
+} pass_tabulation_t;
+
+/**
+ * Start tabulation of a pass.
+ *
+ * \param tabulation Tabulation to initialize
+ * \param observer Ground station. Has to outlive the tabulation
+ * \param orbital_elements Orbital elements of satellite. Have to outlive the tabulation
+ * \param pass Pass to tabulate, as found in a pass table
+ * \param mode Tabulation mode
+ * \param step Distance between rows, in seconds for PASS_TABULATION_FIXED_STEP and degrees for PASS_TABULATION_ANGULAR_STEP. Unused for PASS_TABULATION_EVENTS
+ **/
+void pass_tabulation_start(pass_tabulation_t *tabulation, const predict_observer_t *observer, const predict_orbital_elements_t *orbital_elements, const struct pass_table_pass *pass, enum pass_tabulation_mode mode, double step);
+
+/**
+ * Parse tabulation mode and step, as given on the command line or in the user interface. Accepts a time step in
+ * seconds with suffix "s" (e.g. "60s"), an angular step in degrees with suffix "deg" (e.g. "10deg"), or "events"
+ * for only AOS, TCA and LOS.
+ *
+ * \param string Input string
+ * \param ret_mode Returned tabulation mode
+ * \param ret_step Returned step, in seconds or degrees, for use with pass_tabulation_start()
+ * \return 0 on success, -1 if the string could not be parsed or the step is not positive
+ **/
+int pass_tabulation_parse_step(const char *string, enum pass_tabulation_mode *ret_mode, double *ret_step);
+
+/**
+ * Get next row of the tabulated pass.
+ *
+ * \param tabulation Tabulation
+ * \param ret_row Returned row
+ * \return True if a row was returned, false if the pass has been tabulated until LOS
+ **/
+bool pass_tabulation_next(pass_tabulation_t *tabulation, struct pass_tabulation_row *ret_row);
+
+#endif
@@ -0,0 +1,922 @@
+#include "sgp4_batch.h"
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+#if defined(__x86_64__) || defined(__i386__)
+#define SGP4_BATCH_X86
+#endif
+
+//SGP4 model constants, same as in libpredict
+#define SGP4_BATCH_XKE 7.43669161E-2
+#define SGP4_BATCH_CK2 5.413079E-4
+#define SGP4_BATCH_CK4 6.209887E-7
+#define SGP4_BATCH_XJ3 -2.53881E-6
+#define SGP4_BATCH_QOMS2T 1.880279E-09
+#define SGP4_BATCH_S 1.012229
+#define SGP4_BATCH_AE 1.0
+#define SGP4_BATCH_E6A 1.0E-6
+#define SGP4_BATCH_TWO_THIRD (2.0/3.0)
+#define SGP4_BATCH_MINUTES_PER_DAY 1440.0
+#define SGP4_BATCH_SECONDS_PER_DAY 86400.0
+
+//earth and sun constants, same as in libpredict
+#define SGP4_BATCH_EARTH_RADIUS_KM 6.378137E3
+#define SGP4_BATCH_FLATTENING 3.35281066474748E-3
+#define SGP4_BATCH_EARTH_ROTATIONS_PER_SIDERIAL_DAY 1.00273790934
+#define SGP4_BATCH_SOLAR_RADIUS_KM 6.96000E5
+#define SGP4_BATCH_ASTRONOMICAL_UNIT_KM 1.49597870691E8
+
+//difference between julian dates and the libpredict time scale
+#define SGP4_BATCH_JULIAN_TIME_DIFF 2444238.5
+
+//maximum number of iterations in the Kepler equation solver, same as in libpredict
+#define SGP4_BATCH_MAX_KEPLER_ITERATIONS 10
+
+//convergence criterion of geodetic latitude (radians)
+#define SGP4_BATCH_LATITUDE_TOLERANCE 1.0E-10
+
+//maximum number of iterations for the geodetic latitude
+#define SGP4_BATCH_MAX_LATITUDE_ITERATIONS 20
+
+//sun elevation below which satellites can be visible (degrees)
+#define SGP4_BATCH_NAUTICAL_TWILIGHT_SUN_ELEVATION -12.0
+
+//time since epoch at which added satellites are checked against libpredict (days)
+#define SGP4_BATCH_CHECK_TIME_1 0.0
+#define SGP4_BATCH_CHECK_TIME_2 0.5
+
+/**
+ * Vector of one mask (all bits set or cleared) for each lane.
+ **/
+typedef long long sgp4_batch_mask_t __attribute__((vector_size(SGP4_BATCH_LANES*sizeof(long long))));
+
+//select lanes from a where mask is set, from b otherwise
+#define SGP4_BATCH_SELECT(mask, a, b) ((sgp4_batch_vector_t)(((mask) & (sgp4_batch_mask_t)(a)) | (~(mask) & (sgp4_batch_mask_t)(b))))
+
+//vector with the same value in all lanes
+#define SGP4_BATCH_BROADCAST(value) (((sgp4_batch_vector_t){0}) + (value))
+
+/** Vector math. Helpers take their arguments by pointer, so that vectors are not passed by value between
+ * functions compiled for different instruction sets. **/
+
+/**
+ * Round lanes down to integer.
+ *
+ * \param x Input
+ * \param ret Returned floor of each lane
+ **/
+void sgp4_batch_floor(const sgp4_batch_vector_t *x, sgp4_batch_vector_t *ret)
+{
+	sgp4_batch_vector_t truncated = __builtin_convertvector(__builtin_convertvector(*x, sgp4_batch_mask_t), sgp4_batch_vector_t);
+	*ret = SGP4_BATCH_SELECT(truncated > *x, truncated - 1.0, truncated);
+}
+
+/**
+ * Square root of each lane.
+ *
+ * \param x Input
+ * \param ret Returned square roots
+ **/
+void sgp4_batch_sqrt(const sgp4_batch_vector_t *x, sgp4_batch_vector_t *ret)
+{
+	for (int i=0; i < SGP4_BATCH_LANES; i++) {
+		(*ret)[i] = sqrt((*x)[i]);
+	}
+}
+
+/**
+ * Sine and cosine of each lane. Cody-Waite argument reduction to [-pi/4, pi/4] followed by the minimax
+ * polynomials from the Cephes library, accurate to about one unit in the last place for arguments below 1e8.
+ *
+ * \param x Input (radians)
+ * \param ret_sin Returned sine
+ * \param ret_cos Returned cosine
+ **/
+void sgp4_batch_sincos(const sgp4_batch_vector_t *x, sgp4_batch_vector_t *ret_sin, sgp4_batch_vector_t *ret_cos)
+{
+	sgp4_batch_mask_t negative = *x < 0.0;
+	sgp4_batch_vector_t abs_x = SGP4_BATCH_SELECT(negative, -*x, *x);
+
+	//octant, rounded up to an even number
+	sgp4_batch_vector_t scaled = abs_x*(4.0/M_PI);
+	sgp4_batch_vector_t y;
+	sgp4_batch_floor(&scaled, &y);
+	sgp4_batch_mask_t octant = __builtin_convertvector(y, sgp4_batch_mask_t);
+	sgp4_batch_mask_t odd = octant & 1;
+	octant = (octant + odd) & 7;
+	y = y + __builtin_convertvector(odd, sgp4_batch_vector_t);
+
+	//extended precision modular arithmetic
+	sgp4_batch_vector_t z = ((abs_x - y*7.85398125648498535156E-1) - y*3.77489470793079817668E-8) - y*2.69515142907905952645E-15;
+	sgp4_batch_vector_t zz = z*z;
+
+	sgp4_batch_vector_t sin_poly = z + z*zz*(((((1.58962301576546568060E-10*zz - 2.50507477628578072866E-8)*zz + 2.75573136213857245213E-6)*zz - 1.98412698295895385996E-4)*zz + 8.33333333332211858878E-3)*zz - 1.66666666666666307295E-1);
+	sgp4_batch_vector_t cos_poly = 1.0 - 0.5*zz + zz*zz*(((((-1.13585365213876817300E-11*zz + 2.08757008419747316778E-9)*zz - 2.75573141792967388112E-7)*zz + 2.48015872888517045348E-5)*zz - 1.38888888888730564116E-3)*zz + 4.16666666666665929218E-2);
+
+	sgp4_batch_mask_t swap = (octant & 2) != 0;
+	sgp4_batch_mask_t upper = (octant & 4) != 0;
+
+	sgp4_batch_vector_t sin_value = SGP4_BATCH_SELECT(swap, cos_poly, sin_poly);
+	*ret_sin = SGP4_BATCH_SELECT(upper ^ negative, -sin_value, sin_value);
+
+	sgp4_batch_vector_t cos_value = SGP4_BATCH_SELECT(swap, sin_poly, cos_poly);
+	*ret_cos = SGP4_BATCH_SELECT(upper ^ swap, -cos_value, cos_value);
+}
+
+/**
+ * Arc tangent of each lane, using the rational approximation from the Cephes library.
+ *
+ * \param x Input
+ * \param ret Returned arc tangent, in [-pi/2, pi/2]
+ **/
+void sgp4_batch_atan(const sgp4_batch_vector_t *x, sgp4_batch_vector_t *ret)
+{
+	const double tan_3pi_8 = 2.41421356237309504880;
+	const double morebits = 6.123233995736765886130E-17;
+
+	sgp4_batch_mask_t negative = *x < 0.0;
+	sgp4_batch_vector_t abs_x = SGP4_BATCH_SELECT(negative, -*x, *x);
+
+	//reduce argument to [0, 0.66]
+	sgp4_batch_mask_t large = abs_x > tan_3pi_8;
+	sgp4_batch_mask_t medium = ~large & (abs_x > 0.66);
+	sgp4_batch_vector_t reduced = SGP4_BATCH_SELECT(large, -1.0/abs_x, SGP4_BATCH_SELECT(medium, (abs_x - 1.0)/(abs_x + 1.0), abs_x));
+	sgp4_batch_vector_t offset = SGP4_BATCH_SELECT(large, SGP4_BATCH_BROADCAST(M_PI_2), SGP4_BATCH_SELECT(medium, SGP4_BATCH_BROADCAST(M_PI_4), SGP4_BATCH_BROADCAST(0.0)));
+	sgp4_batch_vector_t correction = SGP4_BATCH_SELECT(large, SGP4_BATCH_BROADCAST(morebits), SGP4_BATCH_SELECT(medium, SGP4_BATCH_BROADCAST(0.5*morebits), SGP4_BATCH_BROADCAST(0.0)));
+
+	sgp4_batch_vector_t z = reduced*reduced;
+	sgp4_batch_vector_t p = (((-8.750608600031904122785E-1*z - 1.615753718733365076637E1)*z - 7.500855792314704667340E1)*z - 1.228866684490136173410E2)*z - 6.485021904942025371773E1;
+	sgp4_batch_vector_t q = ((((z + 2.485846490142306297962E1)*z + 1.650270098316988542046E2)*z + 4.328810604912902668951E2)*z + 4.853903996359136964868E2)*z + 1.945506571482613964425E2;
+	z = z*p/q;
+	z = reduced*z + reduced + correction;
+	sgp4_batch_vector_t result = offset + z;
+
+	*ret = SGP4_BATCH_SELECT(negative, -result, result);
+}
+
+/**
+ * Arc sine of each lane, for arguments in [-1, 1].
+ *
+ * \param x Input
+ * \param ret Returned arc sine
+ **/
+void sgp4_batch_asin(const sgp4_batch_vector_t *x, sgp4_batch_vector_t *ret)
+{
+	sgp4_batch_vector_t cos_value = 1.0 - (*x)*(*x);
+	sgp4_batch_sqrt(&cos_value, &cos_value);
+	sgp4_batch_vector_t tan_value = *x/cos_value;
+	sgp4_batch_atan(&tan_value, ret);
+}
+
+/**
+ * Four-quadrant arc tangent in [0, 2pi), same as AcTan() in libpredict.
+ *
+ * \param sin_value Sine part
+ * \param cos_value Cosine part
+ * \param ret Returned angle
+ **/
+void sgp4_batch_actan(const sgp4_batch_vector_t *sin_value, const sgp4_batch_vector_t *cos_value, sgp4_batch_vector_t *ret)
+{
+	sgp4_batch_vector_t tan_value = *sin_value / *cos_value;
+	sgp4_batch_vector_t angle;
+	sgp4_batch_atan(&tan_value, &angle);
+
+	sgp4_batch_vector_t right_half = SGP4_BATCH_SELECT(*sin_value > 0.0, angle, angle + 2*M_PI);
+	sgp4_batch_vector_t vertical = SGP4_BATCH_SELECT(*sin_value > 0.0, SGP4_BATCH_BROADCAST(M_PI_2), SGP4_BATCH_BROADCAST(3*M_PI_2));
+	*ret = SGP4_BATCH_SELECT(*cos_value == 0.0, vertical, SGP4_BATCH_SELECT(*cos_value > 0.0, right_half, angle + M_PI));
+}
+
+/**
+ * Reduce each lane to [0, 2pi).
+ *
+ * \param x Input (radians)
+ * \param ret Returned angle
+ **/
+void sgp4_batch_fmod2p(const sgp4_batch_vector_t *x, sgp4_batch_vector_t *ret)
+{
+	sgp4_batch_vector_t revolutions = *x/(2*M_PI);
+	sgp4_batch_floor(&revolutions, &revolutions);
+	*ret = *x - revolutions*(2*M_PI);
+}
+
+/** Scalar quantities shared by all satellites. **/
+
+/**
+ * Julian date of the start of given year, same as Julian_Date_of_Year() in libpredict.
+ *
+ * \param year Year
+ * \return Julian date
+ **/
+double sgp4_batch_julian_date_of_year(double year)
+{
+	year = year - 1;
+	long a = year/100;
+	long b = 2 - a + a/4;
+	long i = 365.25*year;
+	i += 30.6001*14;
+	return i + 1720994.5 + b;
+}
+
+/**
+ * Julian date of TLE epoch, same as Julian_Date_of_Epoch() in libpredict.
+ *
+ * \param orbital_elements Orbital elements
+ * \return Julian date
+ **/
+double sgp4_batch_julian_epoch(const predict_orbital_elements_t *orbital_elements)
+{
+	double epoch = 1000.0*orbital_elements->epoch_year + orbital_elements->epoch_day;
+	double year = floor(epoch*1E-3);
+	double day = fmod(epoch*1E-3, 1.0)*1E3;
+	if (year < 57) {
+		year += 2000;
+	} else if (year < 100) {
+		year += 1900;
+	}
+	return sgp4_batch_julian_date_of_year(year) + day;
+}
+
+/**
+ * Greenwich mean sidereal time, same as ThetaG_JD() in libpredict.
+ *
+ * \param jd Julian date
+ * \return Sidereal time (radians)
+ **/
+double sgp4_batch_theta_g(double jd)
+{
+	double ut = fmod(jd + 0.5, 1.0);
+	jd = jd - ut;
+	double tu = (jd - 2451545.0)/36525;
+	double gmst = 24110.54841 + tu*(8640184.812866 + tu*(0.093104 - tu*6.2E-6));
+	gmst = fmod(gmst + SGP4_BATCH_SECONDS_PER_DAY*SGP4_BATCH_EARTH_ROTATIONS_PER_SIDERIAL_DAY*ut, SGP4_BATCH_SECONDS_PER_DAY);
+	if (gmst < 0) {
+		gmst += SGP4_BATCH_SECONDS_PER_DAY;
+	}
+	return 2*M_PI*gmst/SGP4_BATCH_SECONDS_PER_DAY;
+}
+
+/**
+ * Floating point modulus with positive result.
+ *
+ * \param value Value
+ * \param modulus Modulus
+ * \return Value in [0, modulus)
+ **/
+double sgp4_batch_modulus(double value, double modulus)
+{
+	double ret = fmod(value, modulus);
+	if (ret < 0) {
+		ret += modulus;
+	}
+	return ret;
+}
+
+/**
+ * ECI position of the sun, same as sun_predict() in libpredict.
+ *
+ * \param jd Julian date
+ * \param ret_position Returned position (km)
+ **/
+void sgp4_batch_sun_position(double jd, double ret_position[3])
+{
+	double mjd = jd - 2415020.0;
+	double year = 1900 + mjd/365.25;
+	double delta_et = 26.465 + 0.747622*(year - 1950) + 1.886913*sin(2*M_PI*(year - 1975)/33);
+	double T = (mjd + delta_et/SGP4_BATCH_SECONDS_PER_DAY)/36525.0;
+	double M = sgp4_batch_modulus(358.47583 + sgp4_batch_modulus(35999.04975*T, 360.0) - (0.000150 + 0.0000033*T)*T*T, 360.0)*M_PI/180.0;
+	double L = sgp4_batch_modulus(279.69668 + sgp4_batch_modulus(36000.76892*T, 360.0) + 0.0003025*T*T, 360.0)*M_PI/180.0;
+	double e = 0.01675104 - (0.0000418 + 0.000000126*T)*T;
+	double C = ((1.919460 - (0.004789 + 0.000014*T)*T)*sin(M) + (0.020094 - 0.000100*T)*sin(2*M) + 0.000293*sin(3*M))*M_PI/180.0;
+	double O = sgp4_batch_modulus(259.18 - 1934.142*T, 360.0)*M_PI/180.0;
+	double Lsa = sgp4_batch_modulus(L + C - (0.00569 - 0.00479*sin(O))*M_PI/180.0, 2*M_PI);
+	double nu = sgp4_batch_modulus(M + C, 2*M_PI);
+	double R = 1.0000002*(1.0 - e*e)/(1.0 + e*cos(nu));
+	double eps = (23.452294 - (0.0130125 + (0.00000164 - 0.000000503*T)*T)*T + 0.00256*cos(O))*M_PI/180.0;
+	R = SGP4_BATCH_ASTRONOMICAL_UNIT_KM*R;
+	ret_position[0] = R*cos(Lsa);
+	ret_position[1] = R*sin(Lsa)*cos(eps);
+	ret_position[2] = R*sin(Lsa)*sin(eps);
+}
+
+void sgp4_batch_prepare(sgp4_batch_t *batch, predict_julian_date_t time)
+{
+	batch->time = time;
+	batch->julian_time = time + SGP4_BATCH_JULIAN_TIME_DIFF;
+	batch->theta_g = sgp4_batch_theta_g(batch->julian_time);
+	sgp4_batch_sun_position(batch->julian_time, batch->sun_position);
+
+	struct predict_observation sun;
+	predict_observe_sun(batch->observer, time, &sun);
+	batch->sun_elevation = sun.elevation;
+
+	//observer position and velocity, as in Calculate_User_PosVel() in libpredict
+	const predict_observer_t *observer = batch->observer;
+	double altitude = observer->altitude/1000.0;
+	double theta = sgp4_batch_modulus(batch->theta_g + observer->longitude, 2*M_PI);
+	double sin_lat = sin(observer->latitude);
+	double cos_lat = cos(observer->latitude);
+	double c = 1/sqrt(1 + SGP4_BATCH_FLATTENING*(SGP4_BATCH_FLATTENING - 2)*sin_lat*sin_lat);
+	double sq = (1 - SGP4_BATCH_FLATTENING)*(1 - SGP4_BATCH_FLATTENING)*c;
+	double achcp = (SGP4_BATCH_EARTH_RADIUS_KM*c + altitude)*cos_lat;
+	double mfactor = 2*M_PI*SGP4_BATCH_EARTH_ROTATIONS_PER_SIDERIAL_DAY/SGP4_BATCH_SECONDS_PER_DAY;
+	batch->observer_position[0] = achcp*cos(theta);
+	batch->observer_position[1] = achcp*sin(theta);
+	batch->observer_position[2] = (SGP4_BATCH_EARTH_RADIUS_KM*sq + altitude)*sin_lat;
+	batch->observer_velocity[0] = -mfactor*batch->observer_position[1];
+	batch->observer_velocity[1] = mfactor*batch->observer_position[0];
+	batch->observer_velocity[2] = 0;
+	batch->observer_sin_lat = sin_lat;
+	batch->observer_cos_lat = cos_lat;
+	batch->observer_sin_theta = sin(theta);
+	batch->observer_cos_theta = cos(theta);
+}
+
+/** Propagation kernel. **/
+
+/**
+ * Propagate block of satellites, see sgp4_predict() in libpredict. Compiled both for the baseline instruction set
+ * and for AVX2.
+ *
+ * \param batch Batch, prepared for the propagation time
+ * \param block Block to propagate
+ **/
+void sgp4_batch_kernel(const sgp4_batch_t *batch, struct sgp4_batch_block *block)
+{
+	sgp4_batch_vector_t tsince = (batch->julian_time - block->julian_epoch)*SGP4_BATCH_MINUTES_PER_DAY;
+
+	//update for secular gravity and atmospheric drag
+	sgp4_batch_vector_t xmdf = block->xmo + block->xmdot*tsince;
+	sgp4_batch_vector_t omgadf = block->omegao + block->omgdot*tsince;
+	sgp4_batch_vector_t xnoddf = block->xnodeo + block->xnodot*tsince;
+	sgp4_batch_vector_t tsq = tsince*tsince;
+	sgp4_batch_vector_t xnode = xnoddf + block->xnodcf*tsq;
+	sgp4_batch_vector_t tempa = 1.0 - block->c1*tsince;
+	sgp4_batch_vector_t tempe = block->bstar*block->c4*tsince;
+	sgp4_batch_vector_t templ = block->t2cof*tsq;
+
+	//higher order terms, which are zero for satellites using the simplified model
+	sgp4_batch_vector_t sin_xmdf, cos_xmdf;
+	sgp4_batch_sincos(&xmdf, &sin_xmdf, &cos_xmdf);
+	sgp4_batch_vector_t delomg = block->omgcof*tsince;
+	sgp4_batch_vector_t eta_term = 1.0 + block->eta*cos_xmdf;
+	sgp4_batch_vector_t delm = block->xmcof*(eta_term*eta_term*eta_term - block->delmo);
+	sgp4_batch_vector_t temp = delomg + delm;
+	sgp4_batch_vector_t xmp = xmdf + temp;
+	sgp4_batch_vector_t omega = omgadf - temp;
+	sgp4_batch_vector_t tcube = tsq*tsince;
+	sgp4_batch_vector_t tfour = tsince*tcube;
+	tempa = tempa - block->d2*tsq - block->d3*tcube - block->d4*tfour;
+	sgp4_batch_vector_t sin_xmp, cos_xmp;
+	sgp4_batch_sincos(&xmp, &sin_xmp, &cos_xmp);
+	tempe = tempe + block->bstar*block->c5*(sin_xmp - block->sinmo);
+	templ = templ + block->t3cof*tcube + tfour*(block->t4cof + tsince*block->t5cof);
+
+	sgp4_batch_vector_t a = block->aodp*tempa*tempa;
+	sgp4_batch_vector_t e = block->eo - tempe;
+	sgp4_batch_vector_t xl = xmp + omega + xnode + block->xnodp*templ;
+	sgp4_batch_vector_t beta = 1.0 - e*e;
+	sgp4_batch_sqrt(&beta, &beta);
+	sgp4_batch_vector_t sqrt_a;
+	sgp4_batch_sqrt(&a, &sqrt_a);
+	sgp4_batch_vector_t xn = SGP4_BATCH_XKE/(a*sqrt_a);
+
+	//long period periodics
+	sgp4_batch_vector_t sin_omega, cos_omega;
+	sgp4_batch_sincos(&omega, &sin_omega, &cos_omega);
+	sgp4_batch_vector_t axn = e*cos_omega;
+	temp = 1.0/(a*beta*beta);
+	sgp4_batch_vector_t xll = temp*block->xlcof*axn;
+	sgp4_batch_vector_t aynl = temp*block->aycof;
+	sgp4_batch_vector_t xlt = xl + xll;
+	sgp4_batch_vector_t ayn = e*sin_omega + aynl;
+
+	//solve Kepler's equation, freezing each lane when it has converged
+	sgp4_batch_vector_t capu = xlt - xnode;
+	sgp4_batch_fmod2p(&capu, &capu);
+	sgp4_batch_vector_t temp2 = capu;
+	sgp4_batch_vector_t sinepw = {0}, cosepw = {0}, temp3 = {0}, temp4 = {0}, temp5 = {0}, temp6 = {0};
+	sgp4_batch_mask_t active = SGP4_BATCH_BROADCAST(0.0) == 0.0;
+	for (int i=0; i <= SGP4_BATCH_MAX_KEPLER_ITERATIONS; i++) {
+		sgp4_batch_vector_t sin_value, cos_value;
+		sgp4_batch_sincos(&temp2, &sin_value, &cos_value);
+		sinepw = SGP4_BATCH_SELECT(active, sin_value, sinepw);
+		cosepw = SGP4_BATCH_SELECT(active, cos_value, cosepw);
+		temp3 = SGP4_BATCH_SELECT(active, axn*sin_value, temp3);
+		temp4 = SGP4_BATCH_SELECT(active, ayn*cos_value, temp4);
+		temp5 = SGP4_BATCH_SELECT(active, axn*cos_value, temp5);
+		temp6 = SGP4_BATCH_SELECT(active, ayn*sin_value, temp6);
+		sgp4_batch_vector_t epw = (capu - temp4 + temp3 - temp2)/(1.0 - temp5 - temp6) + temp2;
+		sgp4_batch_vector_t difference = epw - temp2;
+		sgp4_batch_vector_t abs_difference = SGP4_BATCH_SELECT(difference < 0.0, -difference, difference);
+		active = active & (abs_difference > SGP4_BATCH_E6A);
+		temp2 = SGP4_BATCH_SELECT(active, epw, temp2);
+
+		bool any_active = false;
+		for (int j=0; j < SGP4_BATCH_LANES; j++) {
+			any_active = any_active || active[j];
+		}
+		if (!any_active) {
+			break;
+		}
+	}
+
+	//short period preliminary quantities
+	sgp4_batch_vector_t ecose = temp5 + temp6;
+	sgp4_batch_vector_t esine = temp3 - temp4;
+	sgp4_batch_vector_t elsq = axn*axn + ayn*ayn;
+	temp = 1.0 - elsq;
+	sgp4_batch_vector_t pl = a*temp;
+	sgp4_batch_vector_t r = a*(1.0 - ecose);
+	sgp4_batch_vector_t temp1 = 1.0/r;
+	sgp4_batch_vector_t rdot = SGP4_BATCH_XKE*sqrt_a*esine*temp1;
+	sgp4_batch_vector_t sqrt_pl;
+	sgp4_batch_sqrt(&pl, &sqrt_pl);
+	sgp4_batch_vector_t rfdot = SGP4_BATCH_XKE*sqrt_pl*temp1;
+	temp2 = a*temp1;
+	sgp4_batch_vector_t betal;
+	sgp4_batch_sqrt(&temp, &betal);
+	temp3 = 1.0/(1.0 + betal);
+	sgp4_batch_vector_t cosu = temp2*(cosepw - axn + ayn*esine*temp3);
+	sgp4_batch_vector_t sinu = temp2*(sinepw - ayn - axn*esine*temp3);
+	sgp4_batch_vector_t u;
+	sgp4_batch_actan(&sinu, &cosu, &u);
+	sgp4_batch_vector_t sin2u = 2.0*sinu*cosu;
+	sgp4_batch_vector_t cos2u = 2.0*cosu*cosu - 1.0;
+	temp = 1.0/pl;
+	temp1 = SGP4_BATCH_CK2*temp;
+	temp2 = temp1*temp;
+
+	//update for short periodics
+	sgp4_batch_vector_t rk = r*(1.0 - 1.5*temp2*betal*block->x3thm1) + 0.5*temp1*block->x1mth2*cos2u;
+	sgp4_batch_vector_t uk = u - 0.25*temp2*block->x7thm1*sin2u;
+	sgp4_batch_vector_t xnodek = xnode + 1.5*temp2*block->cosio*sin2u;
+	sgp4_batch_vector_t xinck = block->xincl + 1.5*temp2*block->cosio*block->sinio*cos2u;
+	sgp4_batch_vector_t rdotk = rdot - xn*temp1*block->x1mth2*sin2u;
+	sgp4_batch_vector_t rfdotk = rfdot + xn*temp1*(block->x1mth2*cos2u + 1.5*block->x3thm1);
+
+	//orientation vectors
+	sgp4_batch_vector_t sinuk, cosuk, sinik, cosik, sinnok, cosnok;
+	sgp4_batch_sincos(&uk, &sinuk, &cosuk);
+	sgp4_batch_sincos(&xinck, &sinik, &cosik);
+	sgp4_batch_sincos(&xnodek, &sinnok, &cosnok);
+	sgp4_batch_vector_t xmx = -sinnok*cosik;
+	sgp4_batch_vector_t xmy = cosnok*cosik;
+	sgp4_batch_vector_t ux = xmx*sinuk + cosnok*cosuk;
+	sgp4_batch_vector_t uy = xmy*sinuk + sinnok*cosuk;
+	sgp4_batch_vector_t uz = sinik*sinuk;
+	sgp4_batch_vector_t vx = xmx*cosuk - cosnok*sinuk;
+	sgp4_batch_vector_t vy = xmy*cosuk - sinnok*sinuk;
+	sgp4_batch_vector_t vz = sinik*cosuk;
+
+	//position and velocity in km and km/s
+	const double velocity_scale = SGP4_BATCH_EARTH_RADIUS_KM*SGP4_BATCH_MINUTES_PER_DAY/SGP4_BATCH_SECONDS_PER_DAY;
+	block->position[0] = rk*ux*SGP4_BATCH_EARTH_RADIUS_KM;
+	block->position[1] = rk*uy*SGP4_BATCH_EARTH_RADIUS_KM;
+	block->position[2] = rk*uz*SGP4_BATCH_EARTH_RADIUS_KM;
+	block->velocity[0] = (rdotk*ux + rfdotk*vx)*velocity_scale;
+	block->velocity[1] = (rdotk*uy + rfdotk*vy)*velocity_scale;
+	block->velocity[2] = (rdotk*uz + rfdotk*vz)*velocity_scale;
+
+	//geodetic coordinates, see Calculate_LatLonAlt() in libpredict
+	sgp4_batch_vector_t *position = block->position;
+	sgp4_batch_vector_t theta;
+	sgp4_batch_actan(&position[1], &position[0], &theta);
+	sgp4_batch_vector_t longitude = theta - batch->theta_g;
+	sgp4_batch_fmod2p(&longitude, &longitude);
+	block->longitude = SGP4_BATCH_SELECT(longitude > M_PI, longitude - 2*M_PI, longitude);
+	sgp4_batch_vector_t r_xy = position[0]*position[0] + position[1]*position[1];
+	sgp4_batch_sqrt(&r_xy, &r_xy);
+	const double e2 = SGP4_BATCH_FLATTENING*(2 - SGP4_BATCH_FLATTENING);
+	sgp4_batch_vector_t tan_latitude = position[2]/r_xy;
+	sgp4_batch_vector_t latitude;
+	sgp4_batch_atan(&tan_latitude, &latitude);
+	sgp4_batch_vector_t c = {0};
+	active = SGP4_BATCH_BROADCAST(0.0) == 0.0;
+	for (int i=0; i < SGP4_BATCH_MAX_LATITUDE_ITERATIONS; i++) {
+		sgp4_batch_vector_t phi = latitude;
+		sgp4_batch_vector_t sinphi, cosphi;
+		sgp4_batch_sincos(&phi, &sinphi, &cosphi);
+		sgp4_batch_vector_t c_value = 1.0 - e2*sinphi*sinphi;
+		sgp4_batch_sqrt(&c_value, &c_value);
+		c_value = 1.0/c_value;
+		tan_latitude = (position[2] + SGP4_BATCH_EARTH_RADIUS_KM*c_value*e2*sinphi)/r_xy;
+		sgp4_batch_vector_t new_latitude;
+		sgp4_batch_atan(&tan_latitude, &new_latitude);
+		c = SGP4_BATCH_SELECT(active, c_value, c);
+		latitude = SGP4_BATCH_SELECT(active, new_latitude, latitude);
+
+		sgp4_batch_vector_t difference = new_latitude - phi;
+		sgp4_batch_vector_t abs_difference = SGP4_BATCH_SELECT(difference < 0.0, -difference, difference);
+		active = active & (abs_difference >= SGP4_BATCH_LATITUDE_TOLERANCE);
+
+		bool any_active = false;
+		for (int j=0; j < SGP4_BATCH_LANES; j++) {
+			any_active = any_active || active[j];
+		}
+		if (!any_active) {
+			break;
+		}
+	}
+	sgp4_batch_vector_t sin_latitude, cos_latitude;
+	sgp4_batch_sincos(&latitude, &sin_latitude, &cos_latitude);
+	block->latitude = latitude;
+	block->altitude = r_xy/cos_latitude - SGP4_BATCH_EARTH_RADIUS_KM*c;
+
+	//eclipse, see is_eclipsed() in libpredict
+	const double *sun = batch->sun_position;
+	sgp4_batch_vector_t position_length = position[0]*position[0] + position[1]*position[1] + position[2]*position[2];
+	sgp4_batch_sqrt(&position_length, &position_length);
+	sgp4_batch_vector_t rho_x = sun[0] - position[0];
+	sgp4_batch_vector_t rho_y = sun[1] - position[1];
+	sgp4_batch_vector_t rho_z = sun[2] - position[2];
+	sgp4_batch_vector_t rho_length = rho_x*rho_x + rho_y*rho_y + rho_z*rho_z;
+	sgp4_batch_sqrt(&rho_length, &rho_length);
+	double sun_length = sqrt(sun[0]*sun[0] + sun[1]*sun[1] + sun[2]*sun[2]);
+
+	sgp4_batch_vector_t sd_earth, sd_sun, delta;
+	sgp4_batch_vector_t ratio = SGP4_BATCH_EARTH_RADIUS_KM/position_length;
+	sgp4_batch_asin(&ratio, &sd_earth);
+	ratio = SGP4_BATCH_SOLAR_RADIUS_KM/rho_length;
+	sgp4_batch_asin(&ratio, &sd_sun);
+	ratio = -(sun[0]*position[0] + sun[1]*position[1] + sun[2]*position[2])/sun_length/position_length;
+	ratio = SGP4_BATCH_SELECT(ratio > 1.0, SGP4_BATCH_BROADCAST(1.0), SGP4_BATCH_SELECT(ratio < -1.0, SGP4_BATCH_BROADCAST(-1.0), ratio));
+	sgp4_batch_asin(&ratio, &delta);
+	delta = M_PI_2 - delta;
+	block->eclipse_depth = sd_earth - sd_sun - delta;
+	block->eclipsed = SGP4_BATCH_SELECT((sd_earth >= sd_sun) & (block->eclipse_depth >= 0.0), SGP4_BATCH_BROADCAST(1.0), SGP4_BATCH_BROADCAST(0.0));
+
+	//observation, see observer_calculate() in libpredict
+	sgp4_batch_vector_t range_x = position[0] - batch->observer_position[0];
+	sgp4_batch_vector_t range_y = position[1] - batch->observer_position[1];
+	sgp4_batch_vector_t range_z = position[2] - batch->observer_position[2];
+	sgp4_batch_vector_t rgvel_x = block->velocity[0] - batch->observer_velocity[0];
+	sgp4_batch_vector_t rgvel_y = block->velocity[1] - batch->observer_velocity[1];
+	sgp4_batch_vector_t rgvel_z = block->velocity[2] - batch->observer_velocity[2];
+	sgp4_batch_vector_t range = range_x*range_x + range_y*range_y + range_z*range_z;
+	sgp4_batch_sqrt(&range, &range);
+	block->range = range;
+	block->range_rate = (range_x*rgvel_x + range_y*rgvel_y + range_z*rgvel_z)/range;
+
+	double sin_lat = batch->observer_sin_lat;
+	double cos_lat = batch->observer_cos_lat;
+	double sin_theta = batch->observer_sin_theta;
+	double cos_theta = batch->observer_cos_theta;
+	sgp4_batch_vector_t top_s = sin_lat*cos_theta*range_x + sin_lat*sin_theta*range_y - cos_lat*range_z;
+	sgp4_batch_vector_t top_e = -sin_theta*range_x + cos_theta*range_y;
+	sgp4_batch_vector_t top_z = cos_lat*cos_theta*range_x + cos_lat*sin_theta*range_y + sin_lat*range_z;
+
+	sgp4_batch_vector_t azimuth = -top_e/top_s;
+	sgp4_batch_atan(&azimuth, &azimuth);
+	azimuth = SGP4_BATCH_SELECT(top_s > 0.0, azimuth + M_PI, azimuth);
+	block->azimuth = SGP4_BATCH_SELECT(azimuth < 0.0, azimuth + 2*M_PI, azimuth);
+	ratio = top_z/range;
+	sgp4_batch_asin(&ratio, &block->elevation);
+}
+
+#ifdef SGP4_BATCH_X86
+/**
+ * Propagate block of satellites using AVX2.
+ *
+ * \param batch Batch, prepared for the propagation time
+ * \param block Block to propagate
+ **/
+__attribute__((target("avx2"), flatten))
+void sgp4_batch_kernel_avx2(const sgp4_batch_t *batch, struct sgp4_batch_block *block)
+{
+	sgp4_batch_kernel(batch, block);
+}
+#endif
+
+void sgp4_batch_propagate_block(sgp4_batch_t *batch, int block_index)
+{
+#ifdef SGP4_BATCH_X86
+	if (__builtin_cpu_supports("avx2")) {
+		sgp4_batch_kernel_avx2(batch, &(batch->blocks[block_index]));
+		return;
+	}
+#endif
+	sgp4_batch_kernel(batch, &(batch->blocks[block_index]));
+}
+
+void sgp4_batch_propagate(sgp4_batch_t *batch, predict_julian_date_t time)
+{
+	sgp4_batch_prepare(batch, time);
+	int num_blocks = sgp4_batch_num_blocks(batch);
+	for (int i=0; i < num_blocks; i++) {
+		sgp4_batch_propagate_block(batch, i);
+	}
+}
+
+void sgp4_batch_get(const sgp4_batch_t *batch, int index, struct predict_orbit *ret_orbit, struct predict_observation *ret_observation)
+{
+	const struct sgp4_batch_block *block = &(batch->blocks[index/SGP4_BATCH_LANES]);
+	int lane = index % SGP4_BATCH_LANES;
+
+	memset(ret_orbit, 0, sizeof(struct predict_orbit));
+	ret_orbit->time = batch->time;
+	for (int i=0; i < 3; i++) {
+		ret_orbit->position[i] = block->position[i][lane];
+		ret_orbit->velocity[i] = block->velocity[i][lane];
+	}
+	ret_orbit->latitude = block->latitude[lane];
+	ret_orbit->longitude = block->longitude[lane];
+	ret_orbit->altitude = block->altitude[lane];
+	ret_orbit->eclipsed = block->eclipsed[lane] != 0.0;
+	ret_orbit->eclipse_depth = block->eclipse_depth[lane];
+	ret_orbit->decayed = predict_decayed(batch->orbital_elements[index], batch->time);
+
+	memset(ret_observation, 0, sizeof(struct predict_observation));
+	ret_observation->time = batch->time;
+	ret_observation->azimuth = block->azimuth[lane];
+	ret_observation->elevation = block->elevation[lane];
+	ret_observation->range = block->range[lane];
+	ret_observation->range_rate = block->range_rate[lane];
+	ret_observation->visible = !(ret_orbit->eclipsed) && (batch->sun_elevation*180.0/M_PI < SGP4_BATCH_NAUTICAL_TWILIGHT_SUN_ELEVATION) && (ret_observation->elevation*180.0/M_PI > 0);
+}
+
+/** Batch management. **/
+
+sgp4_batch_t *sgp4_batch_create(const predict_observer_t *observer)
+{
+	sgp4_batch_t *batch = (sgp4_batch_t*)malloc(sizeof(sgp4_batch_t));
+	memset(batch, 0, sizeof(sgp4_batch_t));
+	batch->observer = observer;
+	return batch;
+}
+
+void sgp4_batch_destroy(sgp4_batch_t **batch)
+{
+	free((*batch)->blocks);
+	free((*batch)->orbital_elements);
+	free(*batch);
+	*batch = NULL;
+}
+
+int sgp4_batch_num_blocks(const sgp4_batch_t *batch)
+{
+	return (batch->num_sats + SGP4_BATCH_LANES - 1)/SGP4_BATCH_LANES;
+}
+
+/**
+ * Make room for one more satellite.
+ *
+ * \param batch Batch
+ * \return 0 on success, -1 on allocation failure
+ **/
+int sgp4_batch_grow(sgp4_batch_t *batch)
+{
+	int num_blocks = (batch->num_sats + SGP4_BATCH_LANES)/SGP4_BATCH_LANES;
+	if (num_blocks <= batch->available_blocks) {
+		return 0;
+	}
+
+	int available_blocks = (batch->available_blocks > 0) ? batch->available_blocks*2 : 1;
+	struct sgp4_batch_block *blocks;
+	if (posix_memalign((void**)&blocks, sizeof(sgp4_batch_vector_t), sizeof(struct sgp4_batch_block)*available_blocks) != 0) {
+		return -1;
+	}
+	const predict_orbital_elements_t **orbital_elements = (const predict_orbital_elements_t**)realloc(batch->orbital_elements, sizeof(const predict_orbital_elements_t*)*available_blocks*SGP4_BATCH_LANES);
+	if (orbital_elements == NULL) {
+		free(blocks);
+		return -1;
+	}
+	if (batch->blocks != NULL) {
+		memcpy(blocks, batch->blocks, sizeof(struct sgp4_batch_block)*batch->available_blocks);
+		free(batch->blocks);
+	}
+	batch->blocks = blocks;
+	batch->orbital_elements = orbital_elements;
+	batch->available_blocks = available_blocks;
+	return 0;
+}
+
+/**
+ * Set one lane of a vector.
+ *
+ * \param vector Vector
+ * \param lane Lane
+ * \param value Value
+ **/
+void sgp4_batch_set_lane(sgp4_batch_vector_t *vector, int lane, double value)
+{
+	(*vector)[lane] = value;
+}
+
+/**
+ * Initialize SGP4 model constants of satellite in given lane, see sgp4_init() in libpredict.
+ *
+ * \param block Block
+ * \param lane Lane
+ * \param orbital_elements Orbital elements
+ **/
+void sgp4_batch_init_lane(struct sgp4_batch_block *block, int lane, const predict_orbital_elements_t *orbital_elements)
+{
+	double xmo = orbital_elements->mean_anomaly*M_PI/180.0;
+	double xnodeo = orbital_elements->right_ascension*M_PI/180.0;
+	double omegao = orbital_elements->argument_of_perigee*M_PI/180.0;
+	double xincl = orbital_elements->inclination*M_PI/180.0;
+	double eo = orbital_elements->eccentricity;
+	double xno = orbital_elements->mean_motion*2*M_PI/SGP4_BATCH_MINUTES_PER_DAY;
+	double bstar = orbital_elements->bstar_drag_term/SGP4_BATCH_AE;
+
+	//recover original mean motion and semimajor axis from input elements
+	double a1 = pow(SGP4_BATCH_XKE/xno, SGP4_BATCH_TWO_THIRD);
+	double cosio = cos(xincl);
+	double theta2 = cosio*cosio;
+	double x3thm1 = 3*theta2 - 1.0;
+	double eosq = eo*eo;
+	double betao2 = 1.0 - eosq;
+	double betao = sqrt(betao2);
+	double del1 = 1.5*SGP4_BATCH_CK2*x3thm1/(a1*a1*betao*betao2);
+	double ao = a1*(1.0 - del1*(0.5*SGP4_BATCH_TWO_THIRD + del1*(1.0 + 134.0/81.0*del1)));
+	double delo = 1.5*SGP4_BATCH_CK2*x3thm1/(ao*ao*betao*betao2);
+	double xnodp = xno/(1.0 + delo);
+	double aodp = ao/(1.0 - delo);
+
+	//use simplified model for perigee below 220 km
+	bool simple = (aodp*(1.0 - eo)/SGP4_BATCH_AE) < (220.0/SGP4_BATCH_EARTH_RADIUS_KM + SGP4_BATCH_AE);
+
+	//modified atmospheric density constants for perigee below 156 km
+	double s4 = SGP4_BATCH_S;
+	double qoms24 = SGP4_BATCH_QOMS2T;
+	double perigee = (aodp*(1.0 - eo) - SGP4_BATCH_AE)*SGP4_BATCH_EARTH_RADIUS_KM;
+	if (perigee < 156.0) {
+		if (perigee <= 98.0) {
+			s4 = 20.0;
+		} else {
+			s4 = perigee - 78.0;
+		}
+		qoms24 = pow((120.0 - s4)*SGP4_BATCH_AE/SGP4_BATCH_EARTH_RADIUS_KM, 4);
+		s4 = s4/SGP4_BATCH_EARTH_RADIUS_KM + SGP4_BATCH_AE;
+	}
+
+	double pinvsq = 1.0/(aodp*aodp*betao2*betao2);
+	double tsi = 1.0/(aodp - s4);
+	double eta = aodp*eo*tsi;
+	double etasq = eta*eta;
+	double eeta = eo*eta;
+	double psisq = fabs(1.0 - etasq);
+	double coef = qoms24*pow(tsi, 4);
+	double coef1 = coef/pow(psisq, 3.5);
+	double c2 = coef1*xnodp*(aodp*(1.0 + 1.5*etasq + eeta*(4.0 + etasq)) + 0.75*SGP4_BATCH_CK2*tsi/psisq*x3thm1*(8.0 + 3.0*etasq*(8.0 + etasq)));
+	double c1 = bstar*c2;
+	double sinio = sin(xincl);
+	double a3ovk2 = -SGP4_BATCH_XJ3/SGP4_BATCH_CK2*pow(SGP4_BATCH_AE, 3);
+	double c3 = 0.0;
+	if (eo > 1.0e-4) {
+		c3 = coef*tsi*a3ovk2*xnodp*SGP4_BATCH_AE*sinio/eo;
+	}
+	double x1mth2 = 1.0 - theta2;
+	double c4 = 2.0*xnodp*coef1*aodp*betao2*(eta*(2.0 + 0.5*etasq) + eo*(0.5 + 2.0*etasq) - 2.0*SGP4_BATCH_CK2*tsi/(aodp*psisq)*(-3.0*x3thm1*(1.0 - 2.0*eeta + etasq*(1.5 - 0.5*eeta)) + 0.75*x1mth2*(2.0*etasq - eeta*(1.0 + etasq))*cos(2.0*omegao)));
+	double c5 = 2.0*coef1*aodp*betao2*(1.0 + 2.75*(etasq + eeta) + eeta*etasq);
+	double theta4 = theta2*theta2;
+	double temp1 = 3.0*SGP4_BATCH_CK2*pinvsq*xnodp;
+	double temp2 = temp1*SGP4_BATCH_CK2*pinvsq;
+	double temp3 = 1.25*SGP4_BATCH_CK4*pinvsq*pinvsq*xnodp;
+	double xmdot = xnodp + 0.5*temp1*betao*x3thm1 + 0.0625*temp2*betao*(13.0 - 78.0*theta2 + 137.0*theta4);
+	double x1m5th = 1.0 - 5.0*theta2;
+	double omgdot = -0.5*temp1*x1m5th + 0.0625*temp2*(7.0 - 114.0*theta2 + 395.0*theta4) + temp3*(3.0 - 36.0*theta2 + 49.0*theta4);
+	double xhdot1 = -temp1*cosio;
+	double xnodot = xhdot1 + (0.5*temp2*(4.0 - 19.0*theta2) + 2.0*temp3*(3.0 - 7.0*theta2))*cosio;
+	double omgcof = bstar*c3*cos(omegao);
+	double xmcof = 0.0;
+	if (eo > 1.0e-4) {
+		xmcof = -SGP4_BATCH_TWO_THIRD*coef*bstar*SGP4_BATCH_AE/eeta;
+	}
+	double xnodcf = 3.5*betao2*xhdot1*c1;
+	double t2cof = 1.5*c1;
+	double xlcof;
+	if (fabs(cosio + 1.0) > 1.5e-12) {
+		xlcof = 0.125*a3ovk2*sinio*(3.0 + 5.0*cosio)/(1.0 + cosio);
+	} else {
+		xlcof = 0.125*a3ovk2*sinio*(3.0 + 5.0*cosio)/1.5e-12;
+	}
+	double aycof = 0.25*a3ovk2*sinio;
+	double delmo = pow(1.0 + eta*cos(xmo), 3);
+	double sinmo = sin(xmo);
+	double x7thm1 = 7.0*theta2 - 1.0;
+
+	double d2 = 0, d3 = 0, d4 = 0, t3cof = 0, t4cof = 0, t5cof = 0;
+	if (!simple) {
+		double c1sq = c1*c1;
+		d2 = 4.0*aodp*tsi*c1sq;
+		double temp = d2*tsi*c1/3.0;
+		d3 = (17.0*aodp + s4)*temp;
+		d4 = 0.5*temp*aodp*tsi*(221.0*aodp + 31.0*s4)*c1;
+		t3cof = d2 + 2.0*c1sq;
+		t4cof = 0.25*(3.0*d3 + c1*(12.0*d2 + 10.0*c1sq));
+		t5cof = 0.2*(3.0*d4 + 12.0*c1*d3 + 6.0*d2*d2 + 15.0*c1sq*(2.0*d2 + c1sq));
+	} else {
+		//terms only used by the full model are zeroed out, see struct sgp4_batch_block
+		omgcof = 0;
+		xmcof = 0;
+		c5 = 0;
+	}
+
+	sgp4_batch_set_lane(&block->xmo, lane, xmo);
+	sgp4_batch_set_lane(&block->xnodeo, lane, xnodeo);
+	sgp4_batch_set_lane(&block->omegao, lane, omegao);
+	sgp4_batch_set_lane(&block->eo, lane, eo);
+	sgp4_batch_set_lane(&block->xincl, lane, xincl);
+	sgp4_batch_set_lane(&block->bstar, lane, bstar);
+	sgp4_batch_set_lane(&block->julian_epoch, lane, sgp4_batch_julian_epoch(orbital_elements));
+	sgp4_batch_set_lane(&block->aodp, lane, aodp);
+	sgp4_batch_set_lane(&block->xnodp, lane, xnodp);
+	sgp4_batch_set_lane(&block->cosio, lane, cosio);
+	sgp4_batch_set_lane(&block->sinio, lane, sinio);
+	sgp4_batch_set_lane(&block->eta, lane, eta);
+	sgp4_batch_set_lane(&block->x3thm1, lane, x3thm1);
+	sgp4_batch_set_lane(&block->x1mth2, lane, x1mth2);
+	sgp4_batch_set_lane(&block->x7thm1, lane, x7thm1);
+	sgp4_batch_set_lane(&block->xmdot, lane, xmdot);
+	sgp4_batch_set_lane(&block->omgdot, lane, omgdot);
+	sgp4_batch_set_lane(&block->xnodot, lane, xnodot);
+	sgp4_batch_set_lane(&block->xnodcf, lane, xnodcf);
+	sgp4_batch_set_lane(&block->c1, lane, c1);
+	sgp4_batch_set_lane(&block->c4, lane, c4);
+	sgp4_batch_set_lane(&block->c5, lane, c5);
+	sgp4_batch_set_lane(&block->t2cof, lane, t2cof);
+	sgp4_batch_set_lane(&block->t3cof, lane, t3cof);
+	sgp4_batch_set_lane(&block->t4cof, lane, t4cof);
+	sgp4_batch_set_lane(&block->t5cof, lane, t5cof);
+	sgp4_batch_set_lane(&block->d2, lane, d2);
+	sgp4_batch_set_lane(&block->d3, lane, d3);
+	sgp4_batch_set_lane(&block->d4, lane, d4);
+	sgp4_batch_set_lane(&block->omgcof, lane, omgcof);
+	sgp4_batch_set_lane(&block->xmcof, lane, xmcof);
+	sgp4_batch_set_lane(&block->delmo, lane, delmo);
+	sgp4_batch_set_lane(&block->sinmo, lane, sinmo);
+	sgp4_batch_set_lane(&block->xlcof, lane, xlcof);
+	sgp4_batch_set_lane(&block->aycof, lane, aycof);
+}
+
+/**
+ * Check propagation of satellite against libpredict at given time.
+ *
+ * \param batch Batch
+ * \param index Index of satellite
+ * \param time Time
+ * \return True if the results agree within the tolerances
+ **/
+bool sgp4_batch_matches_libpredict(sgp4_batch_t *batch, int index, predict_julian_date_t time)
+{
+	const predict_orbital_elements_t *orbital_elements = batch->orbital_elements[index];
+	struct predict_orbit orbit;
+	struct predict_observation observation;
+	predict_orbit(orbital_elements, &orbit, time);
+	predict_observe_orbit(batch->observer, &orbit, &observation);
+
+	sgp4_batch_prepare(batch, time);
+	sgp4_batch_propagate_block(batch, index/SGP4_BATCH_LANES);
+	struct predict_orbit batch_orbit;
+	struct predict_observation batch_observation;
+	sgp4_batch_get(batch, index, &batch_orbit, &batch_observation);
+
+	if (orbit.decayed || batch_orbit.decayed) {
+		return false;
+	}
+
+	for (int i=0; i < 3; i++) {
+		if ((fabs(orbit.position[i] - batch_orbit.position[i]) > SGP4_BATCH_POSITION_TOLERANCE) || (fabs(orbit.velocity[i] - batch_orbit.velocity[i]) > SGP4_BATCH_VELOCITY_TOLERANCE)) {
+			return false;
+		}
+	}
+	return (fabs(orbit.latitude - batch_orbit.latitude) <= SGP4_BATCH_ANGLE_TOLERANCE) &&
+		(fabs(orbit.longitude - batch_orbit.longitude) <= SGP4_BATCH_ANGLE_TOLERANCE) &&
+		(fabs(orbit.altitude - batch_orbit.altitude) <= SGP4_BATCH_POSITION_TOLERANCE) &&
+		(fabs(orbit.eclipse_depth - batch_orbit.eclipse_depth) <= SGP4_BATCH_ANGLE_TOLERANCE) &&
+		(fabs(observation.azimuth - batch_observation.azimuth) <= SGP4_BATCH_ANGLE_TOLERANCE) &&
+		(fabs(observation.elevation - batch_observation.elevation) <= SGP4_BATCH_ANGLE_TOLERANCE) &&
+		(fabs(observation.range - batch_observation.range) <= SGP4_BATCH_POSITION_TOLERANCE) &&
+		(fabs(observation.range_rate - batch_observation.range_rate) <= SGP4_BATCH_VELOCITY_TOLERANCE);
+}
+
+int sgp4_batch_add(sgp4_batch_t *batch, const predict_orbital_elements_t *orbital_elements)
+{
+	if (orbital_elements->ephemeris != EPHEMERIS_SGP4) {
+		return -1;
+	}
+	if (sgp4_batch_grow(batch) != 0) {
+		return -1;
+	}
+
+	int index = batch->num_sats;
+	struct sgp4_batch_block *block = &(batch->blocks[index/SGP4_BATCH_LANES]);
+	int lane = index % SGP4_BATCH_LANES;
+	batch->orbital_elements[index] = orbital_elements;
+
+	//fill the unused lanes of a new block with the same satellite, so that they propagate to finite values
+	int num_lanes = (lane == 0) ? SGP4_BATCH_LANES : 1;
+	for (int i=0; i < num_lanes; i++) {
+		sgp4_batch_init_lane(block, lane + i, orbital_elements);
+	}
+	batch->num_sats++;
+
+	double epoch = sgp4_batch_julian_epoch(orbital_elements) - SGP4_BATCH_JULIAN_TIME_DIFF;
+	if (!sgp4_batch_matches_libpredict(batch, index, epoch + SGP4_BATCH_CHECK_TIME_1) || !sgp4_batch_matches_libpredict(batch, index, epoch + SGP4_BATCH_CHECK_TIME_2)) {
+		batch->num_sats--;
+		return -1;
+	}
+	return index;
+}
@@ -0,0 +1,192 @@
+#ifndef SGP4_BATCH_H_DEFINED
+#define SGP4_BATCH_H_DEFINED
+
+#include <predict/predict.h>
+#include <stdbool.h>
+
+/**
+ * Batched SGP4 propagation of near-earth satellites, for refreshing many satellites at the same time.
+ *
+ * The SGP4 model constants of each satellite are initialized once from its orbital elements, and stored
+ * in structure-of-arrays blocks of SGP4_BATCH_LANES satellites. All satellites are then propagated to a
+ * common time lane by lane, using AVX2 when available on the running CPU and SSE2 otherwise. The sun position
+ * and the observer position are calculated once per propagation and shared by all satellites.
+ *
+ * The propagation follows libpredict's SGP4 implementation. Each satellite is checked against predict_orbit()
+ * and predict_observe_orbit() when it is added, and is rejected if the results differ by more than
+ * SGP4_BATCH_POSITION_TOLERANCE, so that callers can fall back to libpredict for that satellite.
+ * Deep space satellites (SDP4) are not supported.
+ **/
+
+//number of satellites propagated together in one vector
+#define SGP4_BATCH_LANES 4
+
+//maximum accepted position difference against libpredict (km)
+#define SGP4_BATCH_POSITION_TOLERANCE 1.0e-3
+
+//maximum accepted velocity difference against libpredict (km/s)
+#define SGP4_BATCH_VELOCITY_TOLERANCE 1.0e-6
+
+//maximum accepted angle difference against libpredict (radians)
+#define SGP4_BATCH_ANGLE_TOLERANCE 1.0e-6
+
+/**
+ * Vector of one double for each lane.
+ **/
+typedef double sgp4_batch_vector_t __attribute__((vector_size(SGP4_BATCH_LANES*sizeof(double))));
+
+/**
+ * Block of SGP4_BATCH_LANES satellites, one lane per satellite.
+ **/
+struct sgp4_batch_block {
+	///Mean anomaly at epoch (radians)
+	sgp4_batch_vector_t xmo;
+	///Right ascension of ascending node at epoch (radians)
+	sgp4_batch_vector_t xnodeo;
+	///Argument of perigee at epoch (radians)
+	sgp4_batch_vector_t omegao;
+	///Eccentricity at epoch
+	sgp4_batch_vector_t eo;
+	///Inclination (radians)
+	sgp4_batch_vector_t xincl;
+	///Drag term
+	sgp4_batch_vector_t bstar;
+	///Epoch (julian date)
+	sgp4_batch_vector_t julian_epoch;
+
+	///SGP4 model constants, see libpredict's sgp4.c. Terms that are not used for simplified propagation of
+	///low perigee satellites are set to zero for those satellites, which gives the same result without branching
+	sgp4_batch_vector_t aodp, xnodp, cosio, sinio, eta, x3thm1, x1mth2, x7thm1, xmdot, omgdot, xnodot, xnodcf,
+		c1, c4, c5, t2cof, t3cof, t4cof, t5cof, d2, d3, d4, omgcof, xmcof, delmo, sinmo, xlcof, aycof;
+
+	///ECI position at last propagation (km)
+	sgp4_batch_vector_t position[3];
+	///ECI velocity at last propagation (km/s)
+	sgp4_batch_vector_t velocity[3];
+	///Geodetic latitude at last propagation (radians)
+	sgp4_batch_vector_t latitude;
+	///Geodetic longitude at last propagation, in [-pi, pi] as in libpredict (radians)
+	sgp4_batch_vector_t longitude;
+	///Altitude at last propagation (km)
+	sgp4_batch_vector_t altitude;
+	///Eclipse depth at last propagation (radians)
+	sgp4_batch_vector_t eclipse_depth;
+	///Whether satellite is eclipsed at last propagation (1 or 0)
+	sgp4_batch_vector_t eclipsed;
+	///Azimuth seen from observer at last propagation (radians)
+	sgp4_batch_vector_t azimuth;
+	///Elevation seen from observer at last propagation (radians)
+	sgp4_batch_vector_t elevation;
+	///Range from observer at last propagation (km)
+	sgp4_batch_vector_t range;
+	///Range rate seen from observer at last propagation (km/s)
+	sgp4_batch_vector_t range_rate;
+};
+
+/**
+ * Batch of near-earth satellites.
+ **/
+typedef struct {
+	///Ground station. Not owned by the batch
+	const predict_observer_t *observer;
+	///Number of satellites
+	int num_sats;
+	///Number of allocated blocks
+	int available_blocks;
+	///Satellite blocks, aligned for vector access. Lane i of block j holds satellite j*SGP4_BATCH_LANES + i
+	struct sgp4_batch_block *blocks;
+	///Orbital elements of each satellite. Not owned by the batch
+	const predict_orbital_elements_t **orbital_elements;
+	///Time of last propagation
+	predict_julian_date_t time;
+	///Julian date of last propagation
+	double julian_time;
+	///Greenwich sidereal time at last propagation (radians)
+	double theta_g;
+	///ECI sun position at last propagation (km)
+	double sun_position[3];
+	///Sun elevation seen from observer at last propagation (radians)
+	double sun_elevation;
+	///Sine and cosine of observer latitude
+	double observer_sin_lat, observer_cos_lat;
+	///Sine and cosine of local sidereal time of observer at last propagation
+	double observer_sin_theta, observer_cos_theta;
+	///ECI observer position at last propagation (km)
+	double observer_position[3];
+	///ECI observer velocity at last propagation (km/s)
+	double observer_velocity[3];
+} sgp4_batch_t;
+
+/**
+ * Create empty batch.
+ *
+ * \param observer Ground station at which satellites are observed. Has to outlive the batch
+ * \return Batch
+ **/
+sgp4_batch_t *sgp4_batch_create(const predict_observer_t *observer);
+
+/**
+ * Destroy batch.
+ *
+ * \param batch Batch, set to NULL
+ **/
+void sgp4_batch_destroy(sgp4_batch_t **batch);
+
+/**
+ * Add satellite to batch. Only near-earth satellites are accepted, and only when the batched propagation
+ * agrees with libpredict for the satellite. Overwrites the results of the last propagation, and should not be
+ * called while blocks are being propagated.
+ *
+ * \param batch Batch
+ * \param orbital_elements Orbital elements. Have to outlive the batch
+ * \return Index of satellite within the batch, -1 if the satellite cannot be propagated in the batch
+ **/
+int sgp4_batch_add(sgp4_batch_t *batch, const predict_orbital_elements_t *orbital_elements);
+
+/**
+ * Get number of blocks in use.
+ *
+ * \param batch Batch
+ * \return Number of blocks
+ **/
+int sgp4_batch_num_blocks(const sgp4_batch_t *batch);
+
+/**
+ * Prepare propagation of all satellites to given time: calculates the sidereal time, sun position and observer
+ * position shared by all satellites. Has to be called before sgp4_batch_propagate_block().
+ *
+ * \param batch Batch
+ * \param time Time
+ **/
+void sgp4_batch_prepare(sgp4_batch_t *batch, predict_julian_date_t time);
+
+/**
+ * Propagate one block of satellites to the time given in sgp4_batch_prepare(). Different blocks can be
+ * propagated in parallel.
+ *
+ * \param batch Batch
+ * \param block_index Block index
+ **/
+void sgp4_batch_propagate_block(sgp4_batch_t *batch, int block_index);
+
+/**
+ * Propagate all satellites to given time.
+ *
+ * \param batch Batch
+ * \param time Time
+ **/
+void sgp4_batch_propagate(sgp4_batch_t *batch, predict_julian_date_t time);
+
+/**
+ * Get propagation result of satellite, in the structures used by libpredict. Only the fields time, position,
+ * velocity, latitude, longitude, altitude, eclipsed, eclipse_depth and decayed of the orbit, and time, azimuth,
+ * elevation, range, range_rate and visible of the observation are set.
+ *
+ * \param batch Batch
+ * \param index Index of satellite within batch
+ * \param ret_orbit Returned orbit
+ * \param ret_observation Returned observation
+ **/
+void sgp4_batch_get(const sgp4_batch_t *batch, int index, struct predict_orbit *ret_orbit, struct predict_observation *ret_observation);
+
+#endif
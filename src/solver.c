@@ -0,0 +1,130 @@
+#include "solver.h"
+#include <math.h>
+#include <float.h>
+
+predict_julian_date_t solver_find_root(solver_function_t function, void *data, predict_julian_date_t start_time, double start_value, predict_julian_date_t end_time, double end_value, double tolerance)
+{
+	//times are taken relative to the start time, for precision
+	predict_julian_date_t origin = start_time;
+	double a = 0;
+	double b = end_time - origin;
+	double fa = start_value;
+	double fb = end_value;
+	double c = b;
+	double fc = fb;
+	double d = b - a;
+	double e = d;
+
+	for (int i=0; i < SOLVER_MAX_ROOT_ITERATIONS; i++) {
+		//keep the root bracketed between b and c
+		if ((fb >= 0) == (fc >= 0)) {
+			c = a;
+			fc = fa;
+			d = b - a;
+			e = d;
+		}
+
+		//b is the best estimate so far
+		if (fabs(fc) < fabs(fb)) {
+			a = b;
+			b = c;
+			c = a;
+			fa = fb;
+			fb = fc;
+			fc = fa;
+		}
+
+		double step_tolerance = 2.0*DBL_EPSILON*fabs(b) + 0.5*tolerance;
+		double half_interval = 0.5*(c - b);
+		if ((fabs(half_interval) <= step_tolerance) || (fb == 0)) {
+			break;
+		}
+
+		if ((fabs(e) >= step_tolerance) && (fabs(fa) > fabs(fb))) {
+			//attempt inverse quadratic interpolation, or the secant method when only two points are available
+			double p, q;
+			double s = fb/fa;
+			if (a == c) {
+				p = 2.0*half_interval*s;
+				q = 1.0 - s;
+			} else {
+				double r = fb/fc;
+				q = fa/fc;
+				p = s*(2.0*half_interval*q*(q - r) - (b - a)*(r - 1.0));
+				q = (q - 1.0)*(r - 1.0)*(s - 1.0);
+			}
+			if (p > 0) {
+				q = -q;
+			}
+			p = fabs(p);
+
+			//accept interpolation only if it stays well within the bracket and converges fast enough, bisect otherwise
+			double min_1 = 3.0*half_interval*q - fabs(step_tolerance*q);
+			double min_2 = fabs(e*q);
+			if (2.0*p < ((min_1 < min_2) ? min_1 : min_2)) {
+				e = d;
+				d = p/q;
+			} else {
+				d = half_interval;
+				e = d;
+			}
+		} else {
+			d = half_interval;
+			e = d;
+		}
+
+		a = b;
+		fa = fb;
+		if (fabs(d) > step_tolerance) {
+			b += d;
+		} else {
+			b += (half_interval > 0) ? step_tolerance : -step_tolerance;
+		}
+		fb = function(origin + b, data);
+	}
+
+	//return the end of the final bracket on the non-negative side
+	if ((fb < 0) && (fc >= 0)) {
+		return origin + c;
+	}
+	return origin + b;
+}
+
+double solver_find_maximum(solver_function_t function, solver_stop_t stop, void *data, predict_julian_date_t start_time, predict_julian_date_t end_time, double tolerance, predict_julian_date_t *ret_time)
+{
+	const double inv_phi = (sqrt(5.0) - 1.0)/2.0;
+	predict_julian_date_t a = start_time;
+	predict_julian_date_t b = end_time;
+	predict_julian_date_t c = b - inv_phi*(b - a);
+	predict_julian_date_t d = a + inv_phi*(b - a);
+	double value_c = function(c, data);
+	double value_d = function(d, data);
+
+	while (b - a > tolerance) {
+		bool c_highest = value_c > value_d;
+		if ((stop != NULL) && stop(c_highest ? c : d, c_highest ? value_c : value_d, b - a, data)) {
+			break;
+		}
+
+		if (c_highest) {
+			b = d;
+			d = c;
+			value_d = value_c;
+			c = b - inv_phi*(b - a);
+			value_c = function(c, data);
+		} else {
+			a = c;
+			c = d;
+			value_c = value_d;
+			d = a + inv_phi*(b - a);
+			value_d = function(d, data);
+		}
+	}
+
+	if (value_c > value_d) {
+		*ret_time = c;
+		return value_c;
+	}
+	*ret_time = d;
+	return value_d;
+}
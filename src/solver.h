@@ -0,0 +1,63 @@
+#ifndef SOLVER_H_DEFINED
+#define SOLVER_H_DEFINED
+
+#include <predict/predict.h>
+#include <stdbool.h>
+
+/**
+ * Root and maximum search for functions of time, such as elevation or eclipse depth. Used for finding horizon
+ * crossings, eclipse entry and exit, and the highest point of passes and eclipses.
+ **/
+
+//maximum number of iterations in the search for a root
+#define SOLVER_MAX_ROOT_ITERATIONS 100
+
+/**
+ * Function of time to search.
+ *
+ * \param time Time
+ * \param data User data
+ * \return Function value
+ **/
+typedef double (*solver_function_t)(predict_julian_date_t time, void *data);
+
+/**
+ * Check whether the search for a maximum can stop before reaching the tolerance.
+ *
+ * \param time Time of highest point found so far
+ * \param value Function value at that time
+ * \param interval Length of the interval still searched
+ * \param data User data
+ * \return True if the search should stop
+ **/
+typedef bool (*solver_stop_t)(predict_julian_date_t time, double value, double interval, void *data);
+
+/**
+ * Find time at which the function crosses zero between two times, using Brent's method.
+ *
+ * \param function Function
+ * \param data User data passed to the function
+ * \param start_time Time before the crossing
+ * \param start_value Function value at start time
+ * \param end_time Time after the crossing
+ * \param end_value Function value at end time, on the other side of zero
+ * \param tolerance Time resolution (days)
+ * \return Time of crossing, on the side where the function is non-negative
+ **/
+predict_julian_date_t solver_find_root(solver_function_t function, void *data, predict_julian_date_t start_time, double start_value, predict_julian_date_t end_time, double end_value, double tolerance);
+
+/**
+ * Find maximum of the function between two times using golden-section search. Assumes a single maximum.
+ *
+ * \param function Function
+ * \param stop Check for stopping the search early, NULL to always search until the tolerance is reached
+ * \param data User data passed to the function and the stop check
+ * \param start_time Start of interval
+ * \param end_time End of interval
+ * \param tolerance Time resolution (days)
+ * \param ret_time Returned time of highest point found
+ * \return Function value at returned time
+ **/
+double solver_find_maximum(solver_function_t function, solver_stop_t stop, void *data, predict_julian_date_t start_time, predict_julian_date_t end_time, double tolerance, predict_julian_date_t *ret_time);
+
+#endif
@@ -0,0 +1,138 @@
+#include "string_pool.h"
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+
+//default size of the chunks holding string data
+#define STRING_POOL_CHUNK_SIZE 65536
+
+//initial number of hash table slots
+#define STRING_POOL_INITIAL_SLOTS 64
+
+/**
+ * FNV-1a hash of string.
+ *
+ * \param string String
+ * \return Hash value
+ **/
+uint32_t string_pool_hash(const char *string)
+{
+	uint32_t hash = 2166136261u;
+	for (const unsigned char *c = (const unsigned char*)string; *c != '\0'; c++) {
+		hash ^= *c;
+		hash *= 16777619u;
+	}
+	return hash;
+}
+
+/**
+ * Find slot containing the string, or the empty slot where it should be inserted.
+ *
+ * \param slots Hash table slots
+ * \param num_slots Number of slots, power of two
+ * \param string String to look up
+ * \return Slot index
+ **/
+int string_pool_find_slot(const char **slots, int num_slots, const char *string)
+{
+	int mask = num_slots-1;
+	int slot = string_pool_hash(string) & mask;
+	while ((slots[slot] != NULL) && (strcmp(slots[slot], string) != 0)) {
+		slot = (slot + 1) & mask;
+	}
+	return slot;
+}
+
+/**
+ * Double the size of the hash table and reinsert all strings.
+ *
+ * \param pool String pool
+ * \return 0 on success, -1 on failure
+ **/
+int string_pool_grow(string_pool_t *pool)
+{
+	int num_slots = (pool->num_slots > 0) ? pool->num_slots*2 : STRING_POOL_INITIAL_SLOTS;
+	const char **slots = (const char**)calloc(num_slots, sizeof(const char*));
+	if (slots == NULL) {
+		return -1;
+	}
+
+	for (int i=0; i < pool->num_slots; i++) {
+		if (pool->slots[i] != NULL) {
+			slots[string_pool_find_slot(slots, num_slots, pool->slots[i])] = pool->slots[i];
+		}
+	}
+	free(pool->slots);
+	pool->slots = slots;
+	pool->num_slots = num_slots;
+	return 0;
+}
+
+/**
+ * Copy string into the chunk storage of the pool.
+ *
+ * \param pool String pool
+ * \param string String to copy
+ * \return Pointer to copy, NULL on allocation failure
+ **/
+char *string_pool_store(string_pool_t *pool, const char *string)
+{
+	size_t length = strlen(string) + 1;
+	struct string_pool_chunk *chunk = pool->chunks;
+	if ((chunk == NULL) || (chunk->size - chunk->used < length)) {
+		size_t size = (length > STRING_POOL_CHUNK_SIZE) ? length : STRING_POOL_CHUNK_SIZE;
+		chunk = (struct string_pool_chunk*)malloc(sizeof(struct string_pool_chunk) + size);
+		if (chunk == NULL) {
+			return NULL;
+		}
+		chunk->used = 0;
+		chunk->size = size;
+		chunk->next = pool->chunks;
+		pool->chunks = chunk;
+	}
+
+	char *copy = chunk->data + chunk->used;
+	memcpy(copy, string, length);
+	chunk->used += length;
+	return copy;
+}
+
+const char *string_pool_intern(string_pool_t *pool, const char *string)
+{
+	if (string == NULL) {
+		string = "";
+	}
+
+	//keep load factor below 0.5
+	if ((pool->num_strings+1)*2 > pool->num_slots) {
+		if (string_pool_grow(pool) != 0) {
+			return NULL;
+		}
+	}
+
+	int slot = string_pool_find_slot(pool->slots, pool->num_slots, string);
+	if (pool->slots[slot] == NULL) {
+		char *copy = string_pool_store(pool, string);
+		if (copy == NULL) {
+			return NULL;
+		}
+		pool->slots[slot] = copy;
+		pool->num_strings++;
+	}
+	return pool->slots[slot];
+}
+
+void string_pool_free(string_pool_t *pool)
+{
+	struct string_pool_chunk *chunk = pool->chunks;
+	while (chunk != NULL) {
+		struct string_pool_chunk *next = chunk->next;
+		free(chunk);
+		chunk = next;
+	}
+	free(pool->slots);
+	pool->slots = NULL;
+	pool->num_slots = 0;
+	pool->num_strings = 0;
+	pool->chunks = NULL;
+}
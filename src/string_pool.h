@@ -0,0 +1,52 @@
+#ifndef STRING_POOL_H_DEFINED
+#define STRING_POOL_H_DEFINED
+
+#include <stddef.h>
+
+/**
+ * Block of memory in which interned strings are stored back to back.
+ **/
+struct string_pool_chunk {
+	///Next chunk in list
+	struct string_pool_chunk *next;
+	///Number of used bytes in chunk
+	size_t used;
+	///Total number of bytes available in chunk
+	size_t size;
+	///String data
+	char data[];
+};
+
+/**
+ * Pool of interned strings. Each distinct string is stored only once, and the returned pointers
+ * stay valid until the pool is freed. Used for satellite names and filenames in the TLE database,
+ * where the same filename is shared by thousands of entries.
+ **/
+typedef struct {
+	///Hash table over interned strings (open addressing with linear probing), NULL for empty slots
+	const char **slots;
+	///Number of slots in the hash table, always a power of two
+	int num_slots;
+	///Number of interned strings
+	int num_strings;
+	///Chunks holding the string data, most recently allocated first
+	struct string_pool_chunk *chunks;
+} string_pool_t;
+
+/**
+ * Intern string in string pool. Returns the existing copy if the string already has been interned.
+ *
+ * \param pool String pool
+ * \param string String to intern. NULL is interned as the empty string
+ * \return Pointer to interned string, valid until string_pool_free() is called
+ **/
+const char *string_pool_intern(string_pool_t *pool, const char *string);
+
+/**
+ * Free all memory associated with string pool. All strings returned from the pool become invalid.
+ *
+ * \param pool String pool
+ **/
+void string_pool_free(string_pool_t *pool);
+
+#endif
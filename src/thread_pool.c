@@ -0,0 +1,149 @@
+#include "thread_pool.h"
+#include <stdlib.h>
+#include <unistd.h>
+
+/**
+ * Argument to worker thread.
+ **/
+struct thread_pool_worker {
+	///Thread pool
+	thread_pool_t *pool;
+	///Worker index
+	int worker_index;
+};
+
+/**
+ * Worker thread. Waits for batches, and picks tasks from the current batch until none are left.
+ *
+ * \param arg Worker argument, struct thread_pool_worker. Freed by the worker
+ * \return NULL
+ **/
+void *thread_pool_worker_thread(void *arg)
+{
+	struct thread_pool_worker *worker = (struct thread_pool_worker*)arg;
+	thread_pool_t *pool = worker->pool;
+	int worker_index = worker->worker_index;
+	free(worker);
+
+	pthread_mutex_lock(&(pool->mutex));
+	while (true) {
+		while (!pool->shutdown && (pool->next_task >= pool->num_tasks)) {
+			pthread_cond_wait(&(pool->batch_available), &(pool->mutex));
+		}
+		if (pool->shutdown) {
+			break;
+		}
+
+		//run task without holding the lock
+		int task_index = pool->next_task++;
+		thread_pool_task_t task = pool->task;
+		void *data = pool->data;
+		pthread_mutex_unlock(&(pool->mutex));
+
+		task(task_index, worker_index, data);
+
+		pthread_mutex_lock(&(pool->mutex));
+		pool->num_completed++;
+		if (pool->num_completed == pool->num_tasks) {
+			pthread_cond_broadcast(&(pool->batch_done));
+		}
+	}
+	pthread_mutex_unlock(&(pool->mutex));
+	return NULL;
+}
+
+int thread_pool_num_cpus()
+{
+	long num_cpus = sysconf(_SC_NPROCESSORS_ONLN);
+	return (num_cpus > 0) ? num_cpus : 1;
+}
+
+thread_pool_t *thread_pool_create(int num_workers)
+{
+	if (num_workers <= 0) {
+		num_workers = thread_pool_num_cpus();
+	}
+
+	thread_pool_t *pool = (thread_pool_t*)calloc(1, sizeof(thread_pool_t));
+	if (pool == NULL) {
+		return NULL;
+	}
+	pool->threads = (pthread_t*)calloc(num_workers, sizeof(pthread_t));
+	pthread_mutex_init(&(pool->mutex), NULL);
+	pthread_cond_init(&(pool->batch_available), NULL);
+	pthread_cond_init(&(pool->batch_done), NULL);
+
+	for (int i=0; i < num_workers; i++) {
+		struct thread_pool_worker *worker = (struct thread_pool_worker*)malloc(sizeof(struct thread_pool_worker));
+		worker->pool = pool;
+		worker->worker_index = i;
+		if (pthread_create(&(pool->threads[i]), NULL, thread_pool_worker_thread, worker) != 0) {
+			free(worker);
+			break;
+		}
+		pool->num_workers++;
+	}
+
+	if (pool->num_workers == 0) {
+		thread_pool_destroy(&pool);
+	}
+	return pool;
+}
+
+void thread_pool_destroy(thread_pool_t **pool)
+{
+	thread_pool_wait(*pool);
+
+	pthread_mutex_lock(&((*pool)->mutex));
+	(*pool)->shutdown = true;
+	pthread_cond_broadcast(&((*pool)->batch_available));
+	pthread_mutex_unlock(&((*pool)->mutex));
+
+	for (int i=0; i < (*pool)->num_workers; i++) {
+		pthread_join((*pool)->threads[i], NULL);
+	}
+
+	pthread_mutex_destroy(&((*pool)->mutex));
+	pthread_cond_destroy(&((*pool)->batch_available));
+	pthread_cond_destroy(&((*pool)->batch_done));
+	free((*pool)->threads);
+	free(*pool);
+	*pool = NULL;
+}
+
+void thread_pool_dispatch(thread_pool_t *pool, int num_tasks, thread_pool_task_t task, void *data)
+{
+	thread_pool_wait(pool);
+
+	pthread_mutex_lock(&(pool->mutex));
+	pool->task = task;
+	pool->data = data;
+	pool->num_tasks = num_tasks;
+	pool->next_task = 0;
+	pool->num_completed = 0;
+	pthread_cond_broadcast(&(pool->batch_available));
+	pthread_mutex_unlock(&(pool->mutex));
+}
+
+bool thread_pool_done(thread_pool_t *pool)
+{
+	pthread_mutex_lock(&(pool->mutex));
+	bool done = (pool->num_completed == pool->num_tasks);
+	pthread_mutex_unlock(&(pool->mutex));
+	return done;
+}
+
+void thread_pool_wait(thread_pool_t *pool)
+{
+	pthread_mutex_lock(&(pool->mutex));
+	while (pool->num_completed < pool->num_tasks) {
+		pthread_cond_wait(&(pool->batch_done), &(pool->mutex));
+	}
+	pthread_mutex_unlock(&(pool->mutex));
+}
+
+void thread_pool_run(thread_pool_t *pool, int num_tasks, thread_pool_task_t task, void *data)
+{
+	thread_pool_dispatch(pool, num_tasks, task, data);
+	thread_pool_wait(pool);
+}
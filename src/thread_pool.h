@@ -0,0 +1,109 @@
+#ifndef THREAD_POOL_H_DEFINED
+#define THREAD_POOL_H_DEFINED
+
+#include <pthread.h>
+#include <stdbool.h>
+
+/**
+ * Fixed-size pool of worker threads, used for running batches of independent tasks in parallel.
+ * A batch is a number of tasks identified by their index, all executed using the same task function.
+ * One batch runs at a time: thread_pool_run() blocks until the batch is finished, while
+ * thread_pool_dispatch() returns immediately and the batch is completed using thread_pool_wait().
+ **/
+
+/**
+ * Task function.
+ *
+ * \param task_index Index of task within the batch
+ * \param worker_index Index of the worker thread executing the task, in range [0, num_workers). Can be used for indexing per-worker scratch data
+ * \param data User data supplied along with the batch
+ **/
+typedef void (*thread_pool_task_t)(int task_index, int worker_index, void *data);
+
+/**
+ * Thread pool.
+ **/
+typedef struct {
+	///Number of worker threads
+	int num_workers;
+	///Worker threads
+	pthread_t *threads;
+	///Protects all fields below
+	pthread_mutex_t mutex;
+	///Signalled when a new batch is dispatched or the pool is shut down
+	pthread_cond_t batch_available;
+	///Signalled when all tasks in the current batch have been completed
+	pthread_cond_t batch_done;
+	///Task function of current batch
+	thread_pool_task_t task;
+	///User data of current batch
+	void *data;
+	///Number of tasks in current batch
+	int num_tasks;
+	///Next task to be picked up by a worker
+	int next_task;
+	///Number of completed tasks in current batch
+	int num_completed;
+	///Whether worker threads should exit
+	bool shutdown;
+} thread_pool_t;
+
+/**
+ * Create thread pool and start the worker threads.
+ *
+ * \param num_workers Number of worker threads. When 0 or less, the number of online CPUs is used
+ * \return Thread pool, NULL on failure
+ **/
+thread_pool_t *thread_pool_create(int num_workers);
+
+/**
+ * Stop worker threads and free thread pool. Waits for any running batch to finish.
+ *
+ * \param pool Thread pool
+ **/
+void thread_pool_destroy(thread_pool_t **pool);
+
+/**
+ * Start a batch of tasks on the worker threads, and return immediately. Waits for
+ * any previously dispatched batch to finish before starting the new batch.
+ *
+ * \param pool Thread pool
+ * \param num_tasks Number of tasks
+ * \param task Task function, called once for each task index in [0, num_tasks)
+ * \param data User data passed to the task function
+ **/
+void thread_pool_dispatch(thread_pool_t *pool, int num_tasks, thread_pool_task_t task, void *data);
+
+/**
+ * Check whether the most recently dispatched batch has finished.
+ *
+ * \param pool Thread pool
+ * \return True if all tasks have been completed (or no batch has been dispatched)
+ **/
+bool thread_pool_done(thread_pool_t *pool);
+
+/**
+ * Wait for the most recently dispatched batch to finish.
+ *
+ * \param pool Thread pool
+ **/
+void thread_pool_wait(thread_pool_t *pool);
+
+/**
+ * Run a batch of tasks on the worker threads, and wait for all of them to finish.
+ *
+ * \param pool Thread pool
+ * \param num_tasks Number of tasks
+ * \param task Task function, called once for each task index in [0, num_tasks)
+ * \param data User data passed to the task function
+ **/
+void thread_pool_run(thread_pool_t *pool, int num_tasks, thread_pool_task_t task, void *data);
+
+/**
+ * Get number of online CPUs.
+ *
+ * \return Number of CPUs, at least 1
+ **/
+int thread_pool_num_cpus();
+
+#endif
@@ -0,0 +1,245 @@
+#include "tle_checksum.h"
+#include <string.h>
+#include <ctype.h>
+
+#if defined(__x86_64__) || defined(__i386__)
+#define TLE_CHECKSUM_X86
+#include <immintrin.h>
+#endif
+
+//number of characters in a TLE line covered by the validation
+#define TLE_CHECKSUM_LINE_LENGTH 69
+
+//size of the padded line buffers used in the vectorized validation (multiple of both 16 and 32 bytes)
+#define TLE_CHECKSUM_BUFFER_LENGTH 96
+
+//checksum value of each character: digits count as their value, '-' as 1, everything else as 0
+const unsigned char tle_checksum_values[256] = {['0']=0, ['1']=1, ['2']=2, ['3']=3, ['4']=4, ['5']=5, ['6']=6, ['7']=7, ['8']=8, ['9']=9, ['-']=1};
+
+char KepCheck(const char *line1, const char *line2)
+{
+	int x;
+	unsigned sum1, sum2;
+
+	const unsigned char *val = tle_checksum_values;
+
+	/* Compute checksum for each line */
+
+	for (x=0, sum1=0, sum2=0; x<=67; sum1+=val[(unsigned char)line1[x]], sum2+=val[(unsigned char)line2[x]], x++);
+
+	/* Perform a "torture test" on the data */
+
+	x=(val[(unsigned char)line1[68]]^(sum1%10)) | (val[(unsigned char)line2[68]]^(sum2%10)) |
+	  (line1[0]^'1')  | (line1[1]^' ')  | (line1[7]^'U')  |
+	  (line1[8]^' ')  | (line1[17]^' ') | (line1[23]^'.') |
+	  (line1[32]^' ') | (line1[34]^'.') | (line1[43]^' ') |
+	  (line1[52]^' ') | (line1[61]^' ') | (line1[62]^'0') |
+	  (line1[63]^' ') | (line2[0]^'2')  | (line2[1]^' ')  |
+	  (line2[7]^' ')  | (line2[11]^'.') | (line2[16]^' ') |
+	  (line2[20]^'.') | (line2[25]^' ') | (line2[33]^' ') |
+	  (line2[37]^'.') | (line2[42]^' ') | (line2[46]^'.') |
+	  (line2[51]^' ') | (line2[54]^'.') | (line1[2]^line2[2]) |
+	  (line1[3]^line2[3]) | (line1[4]^line2[4]) |
+	  (line1[5]^line2[5]) | (line1[6]^line2[6]) |
+	  (isdigit((unsigned char)line1[68]) ? 0 : 1) | (isdigit((unsigned char)line2[68]) ? 0 : 1) |
+	  (isdigit((unsigned char)line1[18]) ? 0 : 1) | (isdigit((unsigned char)line1[19]) ? 0 : 1) |
+	  (isdigit((unsigned char)line2[31]) ? 0 : 1) | (isdigit((unsigned char)line2[32]) ? 0 : 1);
+
+	return (x ? 0 : 1);
+}
+
+#ifdef TLE_CHECKSUM_X86
+
+/**
+ * Column patterns used in the vectorized validation, corresponding to the tests in KepCheck().
+ * Each mask contains 0xff in the columns it applies to.
+ **/
+
+//expected characters in fixed columns
+const char tle_checksum_line1_expected[TLE_CHECKSUM_BUFFER_LENGTH] = {[0]='1', [1]=' ', [7]='U', [8]=' ', [17]=' ', [23]='.', [32]=' ', [34]='.', [43]=' ', [52]=' ', [61]=' ', [62]='0', [63]=' '};
+const char tle_checksum_line2_expected[TLE_CHECKSUM_BUFFER_LENGTH] = {[0]='2', [1]=' ', [7]=' ', [11]='.', [16]=' ', [20]='.', [25]=' ', [33]=' ', [37]='.', [42]=' ', [46]='.', [51]=' ', [54]='.'};
+const unsigned char tle_checksum_line1_fixed[TLE_CHECKSUM_BUFFER_LENGTH] = {[0]=0xff, [1]=0xff, [7]=0xff, [8]=0xff, [17]=0xff, [23]=0xff, [32]=0xff, [34]=0xff, [43]=0xff, [52]=0xff, [61]=0xff, [62]=0xff, [63]=0xff};
+const unsigned char tle_checksum_line2_fixed[TLE_CHECKSUM_BUFFER_LENGTH] = {[0]=0xff, [1]=0xff, [7]=0xff, [11]=0xff, [16]=0xff, [20]=0xff, [25]=0xff, [33]=0xff, [37]=0xff, [42]=0xff, [46]=0xff, [51]=0xff, [54]=0xff};
+
+//columns that have to contain digits
+const unsigned char tle_checksum_line1_digits[TLE_CHECKSUM_BUFFER_LENGTH] = {[18]=0xff, [19]=0xff, [68]=0xff};
+const unsigned char tle_checksum_line2_digits[TLE_CHECKSUM_BUFFER_LENGTH] = {[31]=0xff, [32]=0xff, [68]=0xff};
+
+//satellite number columns, which have to be equal in both lines
+const unsigned char tle_checksum_satellite_number[TLE_CHECKSUM_BUFFER_LENGTH] = {[2]=0xff, [3]=0xff, [4]=0xff, [5]=0xff, [6]=0xff};
+
+//columns included in the checksum sum
+const unsigned char tle_checksum_summed[TLE_CHECKSUM_BUFFER_LENGTH] = {[0 ... 67]=0xff};
+
+/**
+ * Copy TLE line into zero-padded buffer, so that full vectors can be loaded.
+ *
+ * \param line TLE line
+ * \param ret_buffer Returned buffer, of size TLE_CHECKSUM_BUFFER_LENGTH
+ **/
+void tle_checksum_pad_line(const char *line, char *ret_buffer)
+{
+	memcpy(ret_buffer, line, TLE_CHECKSUM_LINE_LENGTH);
+	memset(ret_buffer + TLE_CHECKSUM_LINE_LENGTH, 0, TLE_CHECKSUM_BUFFER_LENGTH - TLE_CHECKSUM_LINE_LENGTH);
+}
+
+/**
+ * Check the checksum digit in column 69 against the sum of the preceding columns.
+ *
+ * \param line Padded TLE line
+ * \param sum Checksum sum over columns 1-68
+ * \return True if checksum digit matches
+ **/
+bool tle_checksum_digit_matches(const char *line, unsigned sum)
+{
+	return (unsigned)(line[68] - '0') == sum % 10;
+}
+
+/**
+ * Validate single TLE line pair using SSE2. Runs through the line in 16-byte chunks, accumulating
+ * format errors in a vector and the checksum sums using SAD against zero.
+ *
+ * \param line1 Padded line 1
+ * \param line2 Padded line 2
+ * \return True if valid
+ **/
+__attribute__((target("sse2")))
+bool tle_checksum_validate_sse2(const char *line1, const char *line2)
+{
+	const __m128i zero_char = _mm_set1_epi8('0');
+	const __m128i nine = _mm_set1_epi8(9);
+	const __m128i minus = _mm_set1_epi8('-');
+	const __m128i one = _mm_set1_epi8(1);
+	const __m128i zero = _mm_setzero_si128();
+
+	__m128i errors = zero;
+	__m128i sum1 = zero;
+	__m128i sum2 = zero;
+
+	for (int i=0; i < 80; i += 16) {
+		__m128i l1 = _mm_loadu_si128((const __m128i*)(line1 + i));
+		__m128i l2 = _mm_loadu_si128((const __m128i*)(line2 + i));
+
+		//fixed characters
+		__m128i fixed1 = _mm_loadu_si128((const __m128i*)(tle_checksum_line1_fixed + i));
+		__m128i fixed2 = _mm_loadu_si128((const __m128i*)(tle_checksum_line2_fixed + i));
+		errors = _mm_or_si128(errors, _mm_andnot_si128(_mm_cmpeq_epi8(l1, _mm_loadu_si128((const __m128i*)(tle_checksum_line1_expected + i))), fixed1));
+		errors = _mm_or_si128(errors, _mm_andnot_si128(_mm_cmpeq_epi8(l2, _mm_loadu_si128((const __m128i*)(tle_checksum_line2_expected + i))), fixed2));
+
+		//equal satellite numbers
+		errors = _mm_or_si128(errors, _mm_andnot_si128(_mm_cmpeq_epi8(l1, l2), _mm_loadu_si128((const __m128i*)(tle_checksum_satellite_number + i))));
+
+		//digits: c - '0' is at most 9 when interpreted as unsigned
+		__m128i value1 = _mm_sub_epi8(l1, zero_char);
+		__m128i value2 = _mm_sub_epi8(l2, zero_char);
+		__m128i digit1 = _mm_cmpeq_epi8(_mm_min_epu8(value1, nine), value1);
+		__m128i digit2 = _mm_cmpeq_epi8(_mm_min_epu8(value2, nine), value2);
+		errors = _mm_or_si128(errors, _mm_andnot_si128(digit1, _mm_loadu_si128((const __m128i*)(tle_checksum_line1_digits + i))));
+		errors = _mm_or_si128(errors, _mm_andnot_si128(digit2, _mm_loadu_si128((const __m128i*)(tle_checksum_line2_digits + i))));
+
+		//checksum values
+		__m128i summed = _mm_loadu_si128((const __m128i*)(tle_checksum_summed + i));
+		value1 = _mm_or_si128(_mm_and_si128(value1, digit1), _mm_and_si128(_mm_cmpeq_epi8(l1, minus), one));
+		value2 = _mm_or_si128(_mm_and_si128(value2, digit2), _mm_and_si128(_mm_cmpeq_epi8(l2, minus), one));
+		sum1 = _mm_add_epi64(sum1, _mm_sad_epu8(_mm_and_si128(value1, summed), zero));
+		sum2 = _mm_add_epi64(sum2, _mm_sad_epu8(_mm_and_si128(value2, summed), zero));
+	}
+
+	if (_mm_movemask_epi8(errors) != 0) {
+		return false;
+	}
+
+	unsigned checksum1 = _mm_cvtsi128_si32(sum1) + _mm_cvtsi128_si32(_mm_unpackhi_epi64(sum1, sum1));
+	unsigned checksum2 = _mm_cvtsi128_si32(sum2) + _mm_cvtsi128_si32(_mm_unpackhi_epi64(sum2, sum2));
+	return tle_checksum_digit_matches(line1, checksum1) && tle_checksum_digit_matches(line2, checksum2);
+}
+
+/**
+ * Validate single TLE line pair using AVX2. Same as tle_checksum_validate_sse2(), with 32-byte chunks.
+ *
+ * \param line1 Padded line 1
+ * \param line2 Padded line 2
+ * \return True if valid
+ **/
+__attribute__((target("avx2")))
+bool tle_checksum_validate_avx2(const char *line1, const char *line2)
+{
+	const __m256i zero_char = _mm256_set1_epi8('0');
+	const __m256i nine = _mm256_set1_epi8(9);
+	const __m256i minus = _mm256_set1_epi8('-');
+	const __m256i one = _mm256_set1_epi8(1);
+	const __m256i zero = _mm256_setzero_si256();
+
+	__m256i errors = zero;
+	__m256i sum1 = zero;
+	__m256i sum2 = zero;
+
+	for (int i=0; i < TLE_CHECKSUM_BUFFER_LENGTH; i += 32) {
+		__m256i l1 = _mm256_loadu_si256((const __m256i*)(line1 + i));
+		__m256i l2 = _mm256_loadu_si256((const __m256i*)(line2 + i));
+
+		//fixed characters
+		__m256i fixed1 = _mm256_loadu_si256((const __m256i*)(tle_checksum_line1_fixed + i));
+		__m256i fixed2 = _mm256_loadu_si256((const __m256i*)(tle_checksum_line2_fixed + i));
+		errors = _mm256_or_si256(errors, _mm256_andnot_si256(_mm256_cmpeq_epi8(l1, _mm256_loadu_si256((const __m256i*)(tle_checksum_line1_expected + i))), fixed1));
+		errors = _mm256_or_si256(errors, _mm256_andnot_si256(_mm256_cmpeq_epi8(l2, _mm256_loadu_si256((const __m256i*)(tle_checksum_line2_expected + i))), fixed2));
+
+		//equal satellite numbers
+		errors = _mm256_or_si256(errors, _mm256_andnot_si256(_mm256_cmpeq_epi8(l1, l2), _mm256_loadu_si256((const __m256i*)(tle_checksum_satellite_number + i))));
+
+		//digits
+		__m256i value1 = _mm256_sub_epi8(l1, zero_char);
+		__m256i value2 = _mm256_sub_epi8(l2, zero_char);
+		__m256i digit1 = _mm256_cmpeq_epi8(_mm256_min_epu8(value1, nine), value1);
+		__m256i digit2 = _mm256_cmpeq_epi8(_mm256_min_epu8(value2, nine), value2);
+		errors = _mm256_or_si256(errors, _mm256_andnot_si256(digit1, _mm256_loadu_si256((const __m256i*)(tle_checksum_line1_digits + i))));
+		errors = _mm256_or_si256(errors, _mm256_andnot_si256(digit2, _mm256_loadu_si256((const __m256i*)(tle_checksum_line2_digits + i))));
+
+		//checksum values
+		__m256i summed = _mm256_loadu_si256((const __m256i*)(tle_checksum_summed + i));
+		value1 = _mm256_or_si256(_mm256_and_si256(value1, digit1), _mm256_and_si256(_mm256_cmpeq_epi8(l1, minus), one));
+		value2 = _mm256_or_si256(_mm256_and_si256(value2, digit2), _mm256_and_si256(_mm256_cmpeq_epi8(l2, minus), one));
+		sum1 = _mm256_add_epi64(sum1, _mm256_sad_epu8(_mm256_and_si256(value1, summed), zero));
+		sum2 = _mm256_add_epi64(sum2, _mm256_sad_epu8(_mm256_and_si256(value2, summed), zero));
+	}
+
+	if (_mm256_movemask_epi8(errors) != 0) {
+		return false;
+	}
+
+	//horizontal sums of the four 64-bit partial sums
+	__m128i sum1_128 = _mm_add_epi64(_mm256_castsi256_si128(sum1), _mm256_extracti128_si256(sum1, 1));
+	__m128i sum2_128 = _mm_add_epi64(_mm256_castsi256_si128(sum2), _mm256_extracti128_si256(sum2, 1));
+	unsigned checksum1 = _mm_cvtsi128_si32(sum1_128) + _mm_cvtsi128_si32(_mm_unpackhi_epi64(sum1_128, sum1_128));
+	unsigned checksum2 = _mm_cvtsi128_si32(sum2_128) + _mm_cvtsi128_si32(_mm_unpackhi_epi64(sum2_128, sum2_128));
+	return tle_checksum_digit_matches(line1, checksum1) && tle_checksum_digit_matches(line2, checksum2);
+}
+
+#endif
+
+void tle_checksum_validate_batch(const char **line1, const char **line2, int num_tles, bool *ret_valid)
+{
+#ifdef TLE_CHECKSUM_X86
+	bool (*validate)(const char *, const char *) = NULL;
+	if (__builtin_cpu_supports("avx2")) {
+		validate = tle_checksum_validate_avx2;
+	} else if (__builtin_cpu_supports("sse2")) {
+		validate = tle_checksum_validate_sse2;
+	}
+
+	if (validate != NULL) {
+		char padded_line1[TLE_CHECKSUM_BUFFER_LENGTH];
+		char padded_line2[TLE_CHECKSUM_BUFFER_LENGTH];
+		for (int i=0; i < num_tles; i++) {
+			tle_checksum_pad_line(line1[i], padded_line1);
+			tle_checksum_pad_line(line2[i], padded_line2);
+			ret_valid[i] = validate(padded_line1, padded_line2);
+		}
+		return;
+	}
+#endif
+
+	for (int i=0; i < num_tles; i++) {
+		ret_valid[i] = KepCheck(line1[i], line2[i]);
+	}
+}
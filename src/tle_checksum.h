@@ -0,0 +1,35 @@
+#ifndef TLE_CHECKSUM_H_DEFINED
+#define TLE_CHECKSUM_H_DEFINED
+
+#include <stdbool.h>
+
+/**
+ * Validation of NORAD TLE line pairs: line checksums, fixed-column format characters and matching
+ * satellite numbers in line 1 and line 2. Batches of TLEs are validated using SSE2 or AVX2 when
+ * available on the running CPU, with a scalar fallback.
+ **/
+
+/**
+ * Validate a batch of TLE line pairs. Gives the same result as KepCheck() for each line pair.
+ *
+ * \param line1 Pointers to line 1 of each TLE, each at least 69 characters long (not necessarily null-terminated)
+ * \param line2 Pointers to line 2 of each TLE, each at least 69 characters long (not necessarily null-terminated)
+ * \param num_tles Number of TLEs
+ * \param ret_valid Returned validity of each TLE
+ **/
+void tle_checksum_validate_batch(const char **line1, const char **line2, int num_tles, bool *ret_valid);
+
+/* This function scans line 1 and line 2 of a NASA 2-Line element
+ * set and returns a 1 if the element set appears to be valid or
+ * a 0 if it does not.  If the data survives this torture test,
+ * it's a pretty safe bet we're looking at a valid 2-line
+ * element set and not just some random text that might pass
+ * as orbital data based on a simple checksum calculation alone.
+ *
+ * \param line1 Line 1 of TLE, at least 69 characters
+ * \param line2 Line 2 of TLE, at least 69 characters
+ * \return 1 if valid, 0 if not
+ **/
+char KepCheck(const char *line1, const char *line2);
+
+#endif
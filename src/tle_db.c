@@ -10,7 +10,11 @@
 #include <sys/stat.h>
 #include <unistd.h>
 #include "string_array.h"
+#include "tle_db_snapshot.h"
+#include "tle_file.h"
+#include "thread_pool.h"
 #include <ctype.h>
+#include <stdint.h>
 
 struct tle_db *tle_db_create()
 {
@@ -19,89 +23,243 @@ struct tle_db *tle_db_create()
 	return tle_db;
 }
 
+void tle_db_free(struct tle_db *tle_db)
+{
+	free(tle_db->tles);
+	tle_db->tles = NULL;
+	tle_db->num_tles = 0;
+	tle_db->available_size = 0;
+	string_pool_free(&(tle_db->strings));
+	free(tle_db->index_slots);
+	tle_db->index_slots = NULL;
+	tle_db->num_index_slots = 0;
+}
+
 void tle_db_destroy(struct tle_db **tle_db)
 {
+	tle_db_free(*tle_db);
 	free(*tle_db);
 	*tle_db = NULL;
 }
 
 /**
- * Check if tle_1 is more recent than tle_2.
+ * Parse fixed-width field from TLE line.
  *
- * \param tle_1 First NORAD TLE
- * \param tle_2 Second NORAD TLE
- * \return True if tle_1 is newer than tle_2, false otherwise
+ * \param line TLE line
+ * \param start Start column (zero-indexed)
+ * \param length Field length
+ * \return Field value
  **/
-bool tle_is_newer_than(char *tle_1[2], char *tle_2[2])
+double tle_field_to_double(const char *line, int start, int length)
 {
-	predict_orbital_elements_t *orbele_1 = predict_parse_tle(tle_1);
-	predict_orbital_elements_t *orbele_2 = predict_parse_tle(tle_2);
-
-	double epoch_1 = orbele_1->epoch_year*1000.0 + orbele_1->epoch_day;
-	double epoch_2 = orbele_2->epoch_year*1000.0 + orbele_2->epoch_day;
+	char field[TLE_LINE_LENGTH+1] = {0};
+	strncpy(field, line + start, length);
+	return strtod(field, NULL);
+}
 
-	predict_destroy_orbital_elements(orbele_1);
-	predict_destroy_orbital_elements(orbele_2);
+void tle_db_entry_parse_header(struct tle_db_entry *entry)
+{
+	entry->satellite_number = (long)tle_field_to_double(entry->line1, 2, 5);
 
-	return epoch_1 > epoch_2;
+	//two-digit year, 57-99 corresponds to 1957-1999 and 00-56 to 2000-2056
+	int year = (int)tle_field_to_double(entry->line1, 18, 2);
+	entry->epoch_year = (year < 57) ? 2000 + year : 1900 + year;
+	entry->epoch_day = tle_field_to_double(entry->line1, 20, 12);
+	entry->epoch = entry->epoch_year*1000.0 + entry->epoch_day;
 }
 
 bool tle_db_entry_is_newer_than(struct tle_db_entry tle_entry_1, struct tle_db_entry tle_entry_2)
 {
-	char *tle_1[2] = {tle_entry_1.line1, tle_entry_1.line2};
-	char *tle_2[2] = {tle_entry_2.line1, tle_entry_2.line2};
-	return tle_is_newer_than(tle_1, tle_2);
+	return tle_entry_1.epoch > tle_entry_2.epoch;
+}
+
+//initial number of slots in the satellite number hash index
+#define TLE_DB_INITIAL_INDEX_SIZE 128
+
+/**
+ * Hash slot for satellite number in the hash index (Fibonacci hashing).
+ *
+ * \param satellite_number Satellite number
+ * \param num_slots Number of slots, power of two
+ * \return Slot at which to start probing
+ **/
+int tle_db_index_hash(long satellite_number, int num_slots)
+{
+	return (int)((((uint64_t)satellite_number) * 11400714819323198485ull) >> 32) & (num_slots-1);
+}
+
+/**
+ * Find slot in the hash index containing the satellite number, or the empty slot at which it should be inserted.
+ *
+ * \param tle_db TLE database, with allocated hash index
+ * \param satellite_number Satellite number
+ * \return Slot index
+ **/
+int tle_db_index_find_slot(const struct tle_db *tle_db, long satellite_number)
+{
+	int mask = tle_db->num_index_slots-1;
+	int slot = tle_db_index_hash(satellite_number, tle_db->num_index_slots);
+	while ((tle_db->index_slots[slot] != -1) && (tle_db->tles[tle_db->index_slots[slot]].satellite_number != satellite_number)) {
+		slot = (slot + 1) & mask;
+	}
+	return slot;
+}
+
+/**
+ * Insert entry in the hash index, unless the satellite number already is indexed.
+ *
+ * \param tle_db TLE database
+ * \param entry_index Index of entry in TLE database
+ **/
+void tle_db_index_insert(struct tle_db *tle_db, int entry_index)
+{
+	int slot = tle_db_index_find_slot(tle_db, tle_db->tles[entry_index].satellite_number);
+	if (tle_db->index_slots[slot] == -1) {
+		tle_db->index_slots[slot] = entry_index;
+	}
+}
+
+/**
+ * Rebuild hash index from the current entries, resizing it to keep the load factor below 0.5.
+ *
+ * \param tle_db TLE database
+ * \param num_entries Number of entries the index should have room for
+ * \return 0 on success, -1 on failure
+ **/
+int tle_db_index_rebuild(struct tle_db *tle_db, int num_entries)
+{
+	int num_slots = (tle_db->num_index_slots > 0) ? tle_db->num_index_slots : TLE_DB_INITIAL_INDEX_SIZE;
+	while (num_slots < num_entries*2) {
+		num_slots *= 2;
+	}
+	if (num_slots != tle_db->num_index_slots) {
+		int *temp = (int*)realloc(tle_db->index_slots, sizeof(int)*num_slots);
+		if (temp == NULL) {
+			return -1;
+		}
+		tle_db->index_slots = temp;
+		tle_db->num_index_slots = num_slots;
+	}
+
+	memset(tle_db->index_slots, -1, sizeof(int)*num_slots);
+	for (int i=0; i < tle_db->num_tles; i++) {
+		tle_db_index_insert(tle_db, i);
+	}
+	return 0;
+}
+
+/**
+ * Remove all entries from the TLE database, keeping the allocated memory for reuse.
+ *
+ * \param tle_db TLE database
+ **/
+void tle_db_clear(struct tle_db *tle_db)
+{
+	tle_db->num_tles = 0;
+	if (tle_db->index_slots != NULL) {
+		memset(tle_db->index_slots, -1, sizeof(int)*tle_db->num_index_slots);
+	}
 }
 
 void tle_db_overwrite_entry(int entry_index, struct tle_db *tle_db, const struct tle_db_entry *new_entry)
 {
 	if (entry_index < tle_db->num_tles) {
-		tle_db->tles[entry_index].satellite_number = new_entry->satellite_number;
-		strncpy(tle_db->tles[entry_index].name, new_entry->name, MAX_NUM_CHARS);
-		strncpy(tle_db->tles[entry_index].line1, new_entry->line1, MAX_NUM_CHARS);
-		strncpy(tle_db->tles[entry_index].line2, new_entry->line2, MAX_NUM_CHARS);
-		strncpy(tle_db->tles[entry_index].filename, new_entry->filename, MAX_NUM_CHARS);
+		struct tle_db_entry *entry = &(tle_db->tles[entry_index]);
+		bool number_changed = (entry->satellite_number != new_entry->satellite_number);
+		entry->satellite_number = new_entry->satellite_number;
+		entry->name = string_pool_intern(&(tle_db->strings), new_entry->name);
+		strncpy(entry->line1, new_entry->line1, TLE_LINE_LENGTH);
+		entry->line1[TLE_LINE_LENGTH] = '\0';
+		strncpy(entry->line2, new_entry->line2, TLE_LINE_LENGTH);
+		entry->line2[TLE_LINE_LENGTH] = '\0';
+		entry->filename = string_pool_intern(&(tle_db->strings), new_entry->filename);
+		entry->epoch_year = new_entry->epoch_year;
+		entry->epoch_day = new_entry->epoch_day;
+		entry->epoch = new_entry->epoch;
+
+		//satellite number is the hash key, index has to be rebuilt
+		if (number_changed) {
+			tle_db_index_rebuild(tle_db, tle_db->num_tles);
+		}
 	}
 }
 
-void tle_db_add_entry(struct tle_db *tle_db, const struct tle_db_entry *entry)
+//initial number of entries allocated in the TLE database
+#define TLE_DB_INITIAL_SIZE 64
+
+int tle_db_add_entry(struct tle_db *tle_db, const struct tle_db_entry *entry)
 {
-	if (tle_db->num_tles+1 < MAX_NUM_SATS) {
-		tle_db->num_tles++;
-		tle_db_overwrite_entry(tle_db->num_tles-1, tle_db, entry);
+	//extend size to twice the current size
+	if (tle_db->num_tles+1 > tle_db->available_size) {
+		int new_size = (tle_db->available_size > 0) ? tle_db->available_size*2 : TLE_DB_INITIAL_SIZE;
+		struct tle_db_entry *temp = (struct tle_db_entry*)realloc(tle_db->tles, sizeof(struct tle_db_entry)*new_size);
+		if (temp == NULL) {
+			return -1;
+		}
+		tle_db->tles = temp;
+		tle_db->available_size = new_size;
+	}
+
+	//keep load factor of hash index below 0.5
+	if ((tle_db->num_tles+1)*2 > tle_db->num_index_slots) {
+		if (tle_db_index_rebuild(tle_db, tle_db->num_tles+1) != 0) {
+			return -1;
+		}
 	}
+
+	tle_db->num_tles++;
+	int entry_index = tle_db->num_tles-1;
+	tle_db->tles[entry_index].enabled = false;
+	tle_db->tles[entry_index].satellite_number = entry->satellite_number;
+	tle_db_overwrite_entry(entry_index, tle_db, entry);
+	tle_db_index_insert(tle_db, entry_index);
+	return 0;
 }
 
 void tle_db_merge(struct tle_db *new_db, struct tle_db *main_db, enum tle_merge_behavior merge_opt)
 {
 	for (int i=0; i < new_db->num_tles; i++) {
-		bool tle_exists = false;
-		for (int j=0; j < main_db->num_tles; j++) {
-			//check whether TLE already exists in the database
-			if (new_db->tles[i].satellite_number == main_db->tles[j].satellite_number) {
-				tle_exists = true;
-
-				if ((merge_opt == TLE_OVERWRITE_OLD) && tle_db_entry_is_newer_than(new_db->tles[i], main_db->tles[j])) {
-					tle_db_overwrite_entry(j, main_db, &(new_db->tles[i]));
-				}
-			}
-		}
+		//check whether TLE already exists in the database
+		int j = tle_db_find_entry(main_db, new_db->tles[i].satellite_number);
 
-		//append TLE entry to main TLE database
-		if (!tle_exists) {
+		if (j == -1) {
+			//append TLE entry to main TLE database
 			tle_db_add_entry(main_db, &(new_db->tles[i]));
+		} else if ((merge_opt == TLE_OVERWRITE_OLD) && tle_db_entry_is_newer_than(new_db->tles[i], main_db->tles[j])) {
+			tle_db_overwrite_entry(j, main_db, &(new_db->tles[i]));
 		}
 	}
 }
 
 int tle_db_find_entry(const struct tle_db *tle_db, long satellite_number)
 {
-	for (int i=0; i < tle_db->num_tles; i++) {
-		if (tle_db->tles[i].satellite_number == satellite_number) {
-			return i;
-		}
+	if (tle_db->num_index_slots == 0) {
+		return -1;
 	}
-	return -1;
+	return tle_db->index_slots[tle_db_index_find_slot(tle_db, satellite_number)];
+}
+
+/**
+ * Input and output of parallel TLE file reading in tle_db_from_directory().
+ **/
+struct tle_db_file_ingest {
+	///Paths to TLE files
+	string_array_t paths;
+	///TLE database read from each file
+	struct tle_db *file_dbs;
+};
+
+/**
+ * Read single TLE file into its own TLE database. Task function for thread pool.
+ *
+ * \param task_index Index of file
+ * \param worker_index Worker index (unused)
+ * \param data struct tle_db_file_ingest
+ **/
+void tle_db_ingest_file(int task_index, int worker_index, void *data)
+{
+	struct tle_db_file_ingest *ingest = (struct tle_db_file_ingest*)data;
+	tle_db_from_file(string_array_get(&(ingest->paths), task_index), &(ingest->file_dbs[task_index]));
 }
 
 void tle_db_from_directory(const char *dirpath, struct tle_db *ret_tle_db)
@@ -119,6 +277,8 @@ void tle_db_from_directory(const char *dirpath, struct tle_db *ret_tle_db)
 		dirpath_ext = strdup(dirpath);
 	}
 
+	struct tle_db_file_ingest ingest = {{0}};
+
 	d = opendir(dirpath_ext);
 	if (d) {
 		while ((file = readdir(d)) != NULL) {
@@ -126,135 +286,74 @@ void tle_db_from_directory(const char *dirpath, struct tle_db *ret_tle_db)
 				int pathsize = strlen(file->d_name) + strlen(dirpath_ext) + 1;
 				char *full_path = (char*)malloc(sizeof(char)*pathsize);
 				snprintf(full_path, pathsize, "%s%s", dirpath_ext, file->d_name);
-
-				//read into empty TLE db
-				struct tle_db temp_db = {0};
-				tle_db_from_file(full_path, &temp_db);
+				string_array_add(&(ingest.paths), full_path);
 				free(full_path);
-
-				//merge with existing TLE db
-				tle_db_merge(&temp_db, ret_tle_db, TLE_OVERWRITE_OLD); //overwrite only entries with older epochs
 			}
 		}
 		closedir(d);
 	}
 	free(dirpath_ext);
-}
 
-/* This function scans line 1 and line 2 of a NASA 2-Line element
- * set and returns a 1 if the element set appears to be valid or
- * a 0 if it does not.  If the data survives this torture test,
- * it's a pretty safe bet we're looking at a valid 2-line
- * element set and not just some random text that might pass
- * as orbital data based on a simple checksum calculation alone.
- *
- * \param line1 Line 1 of TLE
- * \param line2 Line 2 of TLE
- * \return 1 if valid, 0 if not
- **/
-char KepCheck(const char *line1, const char *line2)
-{
-	int x;
-	unsigned sum1, sum2;
-
-	unsigned char val[256];
-
-	/* Set up translation table for computing TLE checksums */
-
-	for (x=0; x<=255; val[x]=0, x++);
-	for (x='0'; x<='9'; val[x]=x-'0', x++);
-
-	val['-']=1;
-
-	/* Compute checksum for each line */
-
-	for (x=0, sum1=0, sum2=0; x<=67; sum1+=val[(int)line1[x]], sum2+=val[(int)line2[x]], x++);
-
-	/* Perform a "torture test" on the data */
+	int num_files = string_array_size(&(ingest.paths));
+	if (num_files == 0) {
+		return;
+	}
 
-	x=(val[(int)line1[68]]^(sum1%10)) | (val[(int)line2[68]]^(sum2%10)) |
-	  (line1[0]^'1')  | (line1[1]^' ')  | (line1[7]^'U')  |
-	  (line1[8]^' ')  | (line1[17]^' ') | (line1[23]^'.') |
-	  (line1[32]^' ') | (line1[34]^'.') | (line1[43]^' ') |
-	  (line1[52]^' ') | (line1[61]^' ') | (line1[62]^'0') |
-	  (line1[63]^' ') | (line2[0]^'2')  | (line2[1]^' ')  |
-	  (line2[7]^' ')  | (line2[11]^'.') | (line2[16]^' ') |
-	  (line2[20]^'.') | (line2[25]^' ') | (line2[33]^' ') |
-	  (line2[37]^'.') | (line2[42]^' ') | (line2[46]^'.') |
-	  (line2[51]^' ') | (line2[54]^'.') | (line1[2]^line2[2]) |
-	  (line1[3]^line2[3]) | (line1[4]^line2[4]) |
-	  (line1[5]^line2[5]) | (line1[6]^line2[6]) |
-	  (isdigit(line1[68]) ? 0 : 1) | (isdigit(line2[68]) ? 0 : 1) |
-	  (isdigit(line1[18]) ? 0 : 1) | (isdigit(line1[19]) ? 0 : 1) |
-	  (isdigit(line2[31]) ? 0 : 1) | (isdigit(line2[32]) ? 0 : 1);
+	//read files in parallel, each into an empty TLE db
+	ingest.file_dbs = (struct tle_db*)calloc(num_files, sizeof(struct tle_db));
+	thread_pool_t *pool = NULL;
+	if (num_files > 1) {
+		int num_workers = thread_pool_num_cpus();
+		pool = thread_pool_create((num_workers < num_files) ? num_workers : num_files);
+	}
+	if (pool != NULL) {
+		thread_pool_run(pool, num_files, tle_db_ingest_file, &ingest);
+		thread_pool_destroy(&pool);
+	} else {
+		for (int i=0; i < num_files; i++) {
+			tle_db_ingest_file(i, 0, &ingest);
+		}
+	}
 
-	return (x ? 0 : 1);
+	//merge with existing TLE db in directory order, as if the files were read one by one
+	for (int i=0; i < num_files; i++) {
+		tle_db_merge(&(ingest.file_dbs[i]), ret_tle_db, TLE_OVERWRITE_OLD); //overwrite only entries with older epochs
+		tle_db_free(&(ingest.file_dbs[i]));
+	}
+	free(ingest.file_dbs);
+	string_array_free(&(ingest.paths));
 }
 
 int tle_db_from_file(const char *tle_file, struct tle_db *ret_db)
 {
-	//copied from ReadDataFiles().
-
-	ret_db->num_tles = 0;
-	int y = 0;
-	char name[80], line1[80], line2[80];
-
-	FILE *fd=fopen(tle_file,"r");
-	if (fd!=NULL) {
-		while (feof(fd)==0) {
-			/* Initialize variables */
-
-			name[0]=0;
-			line1[0]=0;
-			line2[0]=0;
-
-			/* Read element set */
-
-			fgets(name,75,fd);
-			fgets(line1,75,fd);
-			fgets(line2,75,fd);
-
-			if (KepCheck(line1,line2) && (feof(fd)==0)) {
-				/* We found a valid TLE! */
-
-				/* Some TLE sources left justify the sat
-				   name in a 24-byte field that is padded
-				   with blanks.  The following lines cut
-				   out the blanks as well as the line feed
-				   character read by the fgets() function. */
+	tle_db_clear(ret_db);
 
-				y=strlen(name);
-
-				while (name[y]==32 || name[y]==0 || name[y]==10 || name[y]==13 || y==0) {
-					name[y]=0;
-					y--;
-				}
-
-				/* Copy TLE data into the sat data structure */
+	tle_file_t file;
+	if (tle_file_open(tle_file, &file) != 0) {
+		return -1;
+	}
 
-				struct tle_db_entry entry = {0};
+	for (int i=0; i < file.num_records; i++) {
+		/* Copy TLE data into the sat data structure */
 
-				strncpy(entry.name,name,24);
-				strncpy(entry.line1,line1,69);
-				strncpy(entry.line2,line2,69);
+		struct tle_db_entry entry = {0};
 
-				/* Get satellite number, so that the satellite database can be parsed. */
+		char name[TLE_NAME_LENGTH+1];
+		tle_file_name(&file, i, name, TLE_NAME_LENGTH+1);
+		entry.name = name;
+		memcpy(entry.line1, tle_file_line1(&file, i), TLE_LINE_LENGTH);
+		memcpy(entry.line2, tle_file_line2(&file, i), TLE_LINE_LENGTH);
 
-				char *tle[2] = {entry.line1, entry.line2};
-				predict_orbital_elements_t *temp_elements = predict_parse_tle(tle);
-				entry.satellite_number = temp_elements->satellite_number;
-				predict_destroy_orbital_elements(temp_elements);
+		/* Get satellite number and epoch, so that the satellite database can be parsed and TLEs compared. */
 
-				strncpy(entry.filename, tle_file, MAX_NUM_CHARS);
+		tle_db_entry_parse_header(&entry);
 
-				tle_db_add_entry(ret_db, &entry);
-			}
-		}
+		entry.filename = tle_file;
 
-		fclose(fd);
-	} else {
-		return -1;
+		tle_db_add_entry(ret_db, &entry);
 	}
+
+	tle_file_close(&file);
 	return 0;
 }
 
@@ -325,6 +424,7 @@ void tle_db_update_file(const char *tle_filename, struct tle_db *tle_db)
 		}
 	}
 	tle_db_to_file(tle_filename, &subset_db);
+	tle_db_free(&subset_db);
 }
 
 void tle_db_update(const char *filename, struct tle_db *tle_db, int *update_status)
@@ -332,6 +432,7 @@ void tle_db_update(const char *filename, struct tle_db *tle_db, int *update_stat
 	struct tle_db new_db = {0};
 	int retval = tle_db_from_file(filename, &new_db);
 	if (retval != 0) {
+		tle_db_free(&new_db);
 		return;
 	}
 
@@ -358,6 +459,9 @@ void tle_db_update(const char *filename, struct tle_db *tle_db, int *update_stat
 	}
 
 	if (num_tles_to_update <= 0) {
+		free(newer_tle_indices);
+		free(tle_indices_to_update);
+		tle_db_free(&new_db);
 		return;
 	}
 
@@ -367,7 +471,7 @@ void tle_db_update(const char *filename, struct tle_db *tle_db, int *update_stat
 	//go over tles to update, collect tles belonging to one file in one update, update the file if possible, add to above array if not. Update internal db with new TLE information.
 	for (int i=0; i < num_tles_to_update; i++) {
 		if (newer_tle_indices[i] != -1) {
-			char *tle_filename = tle_db->tles[tle_indices_to_update[i]].filename; //filename to be updated
+			const char *tle_filename = tle_db->tles[tle_indices_to_update[i]].filename; //filename to be updated
 			bool file_is_writable = access(tle_filename, W_OK) == 0;
 
 			//find entries in tle database with corresponding filenames
@@ -378,16 +482,14 @@ void tle_db_update(const char *filename, struct tle_db *tle_db, int *update_stat
 					struct tle_db_entry *tle_entry = &(tle_db->tles[tle_index]);
 					if (strcmp(tle_filename, tle_entry->filename) == 0) {
 						//update tle db entry with new entry
-						char keep_filename[MAX_NUM_CHARS];
-						char keep_name[MAX_NUM_CHARS];
-						strncpy(keep_filename, tle_entry->filename, MAX_NUM_CHARS);
-						strncpy(keep_name, tle_entry->name, MAX_NUM_CHARS);
+						const char *keep_filename = tle_entry->filename;
+						const char *keep_name = tle_entry->name;
 
 						tle_db_overwrite_entry(tle_index, tle_db, tle_update_entry);
 
-						//keep old filename and name
-						strncpy(tle_entry->filename, keep_filename, MAX_NUM_CHARS);
-						strncpy(tle_entry->name, keep_name, MAX_NUM_CHARS);
+						//keep old filename and name (interned strings stay valid for the lifetime of the database)
+						tle_entry->filename = keep_filename;
+						tle_entry->name = keep_name;
 
 						//set db indices to update to -1 in order to ignore them on the next update
 						newer_tle_indices[j] = -1;
@@ -423,9 +525,10 @@ void tle_db_update(const char *filename, struct tle_db *tle_db, int *update_stat
 		for (int i=0; i < num_unwritable; i++) {
 			int tle_ind = unwritable_tles[i];
 			tle_db_add_entry(&unwritable_db, &(tle_db->tles[tle_ind]));
-			strncpy(tle_db->tles[tle_ind].filename, new_tle_filename, MAX_NUM_CHARS);
+			tle_db_entry_set_filename(tle_db, tle_ind, new_tle_filename);
 		}
 		int retval = tle_db_to_file(new_tle_filename, &unwritable_db);
+		tle_db_free(&unwritable_db);
 		if ((update_status != NULL) && (retval != -1)) {
 			for (int i=0; i < num_unwritable; i++) {
 				int tle_ind = unwritable_tles[i];
@@ -438,33 +541,54 @@ void tle_db_update(const char *filename, struct tle_db *tle_db, int *update_stat
 	free(newer_tle_indices);
 	free(tle_indices_to_update);
 	free(unwritable_tles);
+	tle_db_free(&new_db);
 }
 
 void tle_db_from_search_paths(struct tle_db *ret_tle_db)
 {
-	//read tles from user directory
+	//TLE directories in order of precedence: user directory, then system-wide data directories
+	string_array_t tle_dirs = {0};
 	char *data_home = xdg_data_home();
 	char home_tle_dir[MAX_NUM_CHARS] = {0};
 	snprintf(home_tle_dir, MAX_NUM_CHARS, "%s%s", data_home, TLE_RELATIVE_DIR_PATH);
-	tle_db_from_directory(home_tle_dir, ret_tle_db);
+	string_array_add(&tle_dirs, home_tle_dir);
 	free(data_home);
 
 	char *data_dirs_str = xdg_data_dirs();
 	string_array_t data_dirs = {0};
 	stringsplit(data_dirs_str, &data_dirs);
-
-	//read tles from system-wide data directories the order of precedence
 	for (int i=0; i < string_array_size(&data_dirs); i++) {
 		char dir[MAX_NUM_CHARS] = {0};
 		snprintf(dir, MAX_NUM_CHARS, "%s%s", string_array_get(&data_dirs, i), TLE_RELATIVE_DIR_PATH);
-
-		struct tle_db temp_db = {0};
-		tle_db_from_directory(dir, &temp_db);
-		tle_db_merge(&temp_db, ret_tle_db, TLE_OVERWRITE_NONE); //multiply defined TLEs in directories of less precedence are ignored
+		string_array_add(&tle_dirs, dir);
 	}
 	string_array_free(&data_dirs);
 	free(data_dirs_str);
 
+	//use cached snapshot if none of the TLE files have changed since it was written
+	tle_db_snapshot_sources_t sources = {0};
+	tle_db_snapshot_sources_from_directories(&tle_dirs, &sources);
+	char *snapshot_file = tle_db_snapshot_default_path();
+
+	if (tle_db_snapshot_read(snapshot_file, &sources, ret_tle_db) != 0) {
+		//read tles from user directory
+		tle_db_from_directory(string_array_get(&tle_dirs, 0), ret_tle_db);
+
+		//read tles from system-wide data directories the order of precedence
+		for (int i=1; i < string_array_size(&tle_dirs); i++) {
+			struct tle_db temp_db = {0};
+			tle_db_from_directory(string_array_get(&tle_dirs, i), &temp_db);
+			tle_db_merge(&temp_db, ret_tle_db, TLE_OVERWRITE_NONE); //multiply defined TLEs in directories of less precedence are ignored
+			tle_db_free(&temp_db);
+		}
+
+		tle_db_snapshot_write(snapshot_file, &sources, ret_tle_db);
+	}
+
+	free(snapshot_file);
+	tle_db_snapshot_sources_free(&sources);
+	string_array_free(&tle_dirs);
+
 	ret_tle_db->read_from_xdg = true;
 }
 
@@ -494,6 +618,13 @@ predict_orbital_elements_t *tle_db_entry_to_orbital_elements(const struct tle_db
 	}
 }
 
+void tle_db_entry_set_filename(struct tle_db *db, int tle_index, const char *filename)
+{
+	if ((tle_index < db->num_tles) && (tle_index >= 0)) {
+		db->tles[tle_index].filename = string_pool_intern(&(db->strings), filename);
+	}
+}
+
 const char *tle_db_entry_name(const struct tle_db *db, int tle_index)
 {
 	if ((tle_index < db->num_tles) && (tle_index >= 0)) {
@@ -3,35 +3,59 @@
 
 #include <stdbool.h>
 #include "string_array.h"
+#include "string_pool.h"
 #include "defines.h"
 #include <predict/predict.h>
 
+//length of a line in a NORAD TLE, excluding line endings
+#define TLE_LINE_LENGTH 69
+
+//maximum length of satellite name in TLE file
+#define TLE_NAME_LENGTH 24
+
 /**
  * Entry in TLE database.
  **/
 struct tle_db_entry {
 	///satellite number, parsed from TLE line 1
 	long satellite_number;
-	///satellite name, defined in TLE file
-	char name[MAX_NUM_CHARS];
+	///satellite name, defined in TLE file. Points to a string interned in the string pool of the TLE database
+	const char *name;
 	///line 1 in NORAD TLE
-	char line1[MAX_NUM_CHARS];
+	char line1[TLE_LINE_LENGTH+1];
 	///line 2 in NORAD TLE
-	char line2[MAX_NUM_CHARS];
-	///Filename from which the TLE has been read
-	char filename[MAX_NUM_CHARS];
+	char line2[TLE_LINE_LENGTH+1];
+	///Filename from which the TLE has been read. Points to a string interned in the string pool of the TLE database
+	const char *filename;
+	///Epoch year (four digits), parsed from TLE line 1
+	int epoch_year;
+	///Epoch day of year, including fraction of day, parsed from TLE line 1
+	double epoch_day;
+	///Epoch as epoch_year*1000 + epoch_day, used for comparing the age of TLEs
+	double epoch;
 	///Whether TLE entry is enabled for display
 	bool enabled;
 };
 
 /**
- * TLE database.
+ * TLE database. Entries are stored in a dynamically sized array, names and filenames are
+ * interned so that they are shared between entries. A zero-initialized struct is a valid,
+ * empty database, but tle_db_destroy() or tle_db_free() has to be called in order to release
+ * the memory that is allocated when entries are added.
  **/
 struct tle_db {
 	///Number of contained TLEs
 	int num_tles;
+	///Available number of entries in `tles` before it has to be reallocated
+	int available_size;
 	///TLE entries
-	struct tle_db_entry tles[MAX_NUM_SATS];
+	struct tle_db_entry *tles;
+	///Storage for entry names and filenames
+	string_pool_t strings;
+	///Hash index from satellite number to entry index (open addressing, linear probing). Empty slots are set to -1
+	int *index_slots;
+	///Number of slots in the hash index, always a power of two and at least twice the number of entries
+	int num_index_slots;
 	///Whether TLE database was read from XDG standard paths or supplied on command line
 	bool read_from_xdg;
 };
@@ -50,6 +74,14 @@ struct tle_db *tle_db_create();
  **/
 void tle_db_destroy(struct tle_db **tle_db);
 
+/**
+ * Free memory allocated within TLE database, without freeing the struct itself. The database
+ * is left empty, and can be reused. Used for TLE database structs that are not allocated using tle_db_create().
+ *
+ * \param tle_db TLE database
+ **/
+void tle_db_free(struct tle_db *tle_db);
+
 /**
  * Read TLE entries from folders defined using the XDG file specification. TLEs are read
  * from files located in {XDG_DATA_DIRS}/flyby/tles and XDG_DATA_HOME/flyby/tles.
@@ -143,7 +175,15 @@ enum tle_merge_behavior {
 void tle_db_merge(struct tle_db *new_db, struct tle_db *main_db, enum tle_merge_behavior merge_opt);
 
 /**
- * Check internal TLE lines within tle entries to see whether one is more recent than the other.
+ * Decode satellite number and epoch from line 1 of the TLE entry, and set the corresponding fields.
+ * Done once when TLEs are read, so that these fields are available without parsing the full orbital elements.
+ *
+ * \param entry TLE entry with line 1 set
+ **/
+void tle_db_entry_parse_header(struct tle_db_entry *entry);
+
+/**
+ * Check the epochs of the TLE entries to see whether one is more recent than the other.
  *
  * \param tle_entry_1 TLE entry 1
  * \param tle_entry_2 TLE entry 2
@@ -152,7 +192,8 @@ void tle_db_merge(struct tle_db *new_db, struct tle_db *main_db, enum tle_merge_
 bool tle_db_entry_is_newer_than(struct tle_db_entry tle_entry_1, struct tle_db_entry tle_entry_2);
 
 /**
- * Overwrite TLE database entry with supplied TLE entry.
+ * Overwrite TLE database entry with supplied TLE entry. Name and filename are copied into the
+ * string storage of the TLE database, and do not need to outlive the call.
  *
  * \param entry_index Index in TLE database
  * \param tle_db TLE database
@@ -161,15 +202,18 @@ bool tle_db_entry_is_newer_than(struct tle_db_entry tle_entry_1, struct tle_db_e
 void tle_db_overwrite_entry(int entry_index, struct tle_db *tle_db, const struct tle_db_entry *new_entry);
 
 /**
- * Add TLE entry to database.
+ * Add TLE entry to database. Reallocates the entry array to twice the size when the current
+ * available size is exceeded.
  *
  * \param tle_db TLE database
  * \param entry TLE database entry to add
+ * \return 0 on success, -1 on failure
  **/
-void tle_db_add_entry(struct tle_db *tle_db, const struct tle_db_entry *entry);
+int tle_db_add_entry(struct tle_db *tle_db, const struct tle_db_entry *entry);
 
 /**
- * Find TLE entry within TLE database. Searches with respect to the satellite number.
+ * Find TLE entry within TLE database. Searches with respect to the satellite number, using the hash index
+ * of the database. If the satellite number is defined multiple times, the first entry is returned.
  *
  * \param tle_db TLE database
  * \param satellite_number Lookup satellite number
@@ -204,6 +248,15 @@ bool tle_db_entry_enabled(const struct tle_db *db, int tle_index);
  **/
 predict_orbital_elements_t *tle_db_entry_to_orbital_elements(const struct tle_db *db, int tle_index);
 
+/**
+ * Set filename of TLE entry, used when the entry is moved to a different file.
+ *
+ * \param db TLE database
+ * \param tle_index Index in TLE database
+ * \param filename New filename
+ **/
+void tle_db_entry_set_filename(struct tle_db *db, int tle_index, const char *filename);
+
 /**
  * Get name of satellite corresponding to defined TLE entry.
  *
@@ -0,0 +1,402 @@
+#include "tle_db_snapshot.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <dirent.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include "xdg_basedirs.h"
+
+//identifies snapshot files
+#define TLE_DB_SNAPSHOT_MAGIC "FLYBYTLE"
+
+//increment when the layout of the snapshot file changes
+#define TLE_DB_SNAPSHOT_VERSION 1
+
+/**
+ * Snapshot file header. The file consists of the header, followed by `num_sources` source records,
+ * `num_entries` entry records and a table of null-terminated strings of size `strings_size`.
+ **/
+struct tle_db_snapshot_header {
+	///Magic identifier, TLE_DB_SNAPSHOT_MAGIC
+	char magic[8];
+	///Snapshot file version, TLE_DB_SNAPSHOT_VERSION
+	uint32_t version;
+	///Size of each entry record, guards against layout differences
+	uint32_t entry_size;
+	///Number of source records
+	uint32_t num_sources;
+	///Number of entry records
+	uint32_t num_entries;
+	///Size of string table
+	uint64_t strings_size;
+};
+
+/**
+ * Source file record in snapshot file.
+ **/
+struct tle_db_snapshot_source_record {
+	///Modification time, seconds part
+	int64_t mtime_sec;
+	///Modification time, nanoseconds part
+	int64_t mtime_nsec;
+	///File size
+	int64_t size;
+	///Offset of file path in string table
+	uint64_t path_offset;
+};
+
+/**
+ * TLE entry record in snapshot file.
+ **/
+struct tle_db_snapshot_entry {
+	///Satellite number
+	int64_t satellite_number;
+	///Epoch day
+	double epoch_day;
+	///Epoch year
+	int32_t epoch_year;
+	///Offset of satellite name in string table
+	uint32_t name_offset;
+	///Offset of filename in string table
+	uint32_t filename_offset;
+	///Line 1 of TLE
+	char line1[TLE_LINE_LENGTH+1];
+	///Line 2 of TLE
+	char line2[TLE_LINE_LENGTH+1];
+};
+
+void tle_db_snapshot_sources_add(tle_db_snapshot_sources_t *sources, const char *path, const struct stat *file_stat)
+{
+	if (sources->num_sources+1 > sources->available_size) {
+		int new_size = (sources->available_size > 0) ? sources->available_size*2 : 16;
+		struct tle_db_snapshot_source *temp = (struct tle_db_snapshot_source*)realloc(sources->sources, sizeof(struct tle_db_snapshot_source)*new_size);
+		if (temp == NULL) {
+			return;
+		}
+		sources->sources = temp;
+		sources->available_size = new_size;
+	}
+
+	struct tle_db_snapshot_source *source = &(sources->sources[sources->num_sources++]);
+	source->path = strdup(path);
+	source->mtime_sec = file_stat->st_mtim.tv_sec;
+	source->mtime_nsec = file_stat->st_mtim.tv_nsec;
+	source->size = file_stat->st_size;
+}
+
+void tle_db_snapshot_sources_from_directories(string_array_t *directories, tle_db_snapshot_sources_t *ret_sources)
+{
+	for (int i=0; i < string_array_size(directories); i++) {
+		const char *dirpath = string_array_get(directories, i);
+		bool has_backslash = (strlen(dirpath) > 0) && (dirpath[strlen(dirpath)-1] == '/');
+
+		DIR *d = opendir(dirpath);
+		if (!d) {
+			continue;
+		}
+
+		//same file selection as in tle_db_from_directory()
+		struct dirent *file;
+		while ((file = readdir(d)) != NULL) {
+			if (file->d_type == DT_REG) {
+				char full_path[MAX_NUM_CHARS] = {0};
+				snprintf(full_path, MAX_NUM_CHARS, "%s%s%s", dirpath, has_backslash ? "" : "/", file->d_name);
+
+				struct stat file_stat;
+				if (stat(full_path, &file_stat) == 0) {
+					tle_db_snapshot_sources_add(ret_sources, full_path, &file_stat);
+				}
+			}
+		}
+		closedir(d);
+	}
+}
+
+void tle_db_snapshot_sources_free(tle_db_snapshot_sources_t *sources)
+{
+	for (int i=0; i < sources->num_sources; i++) {
+		free(sources->sources[i].path);
+	}
+	free(sources->sources);
+	sources->sources = NULL;
+	sources->num_sources = 0;
+	sources->available_size = 0;
+}
+
+char *tle_db_snapshot_default_path()
+{
+	char *cache_home = xdg_cache_home();
+	int size = strlen(cache_home) + strlen(TLE_DB_SNAPSHOT_RELATIVE_FILE_PATH) + 1;
+	char *path = (char*)malloc(sizeof(char)*size);
+	snprintf(path, size, "%s%s", cache_home, TLE_DB_SNAPSHOT_RELATIVE_FILE_PATH);
+	free(cache_home);
+	return path;
+}
+
+/**
+ * Get string from string table in memory-mapped snapshot.
+ *
+ * \param strings String table
+ * \param strings_size Size of string table
+ * \param offset Offset of string
+ * \return String, or NULL if the offset is out of bounds
+ **/
+const char *tle_db_snapshot_string(const char *strings, uint64_t strings_size, uint64_t offset)
+{
+	if (offset >= strings_size) {
+		return NULL;
+	}
+	return strings + offset;
+}
+
+/**
+ * Validate snapshot contents against the current source files.
+ *
+ * \param data Memory-mapped snapshot file
+ * \param data_size Size of snapshot file
+ * \param sources Current source files
+ * \return True if the snapshot is well-formed and up to date
+ **/
+bool tle_db_snapshot_valid(const char *data, size_t data_size, const tle_db_snapshot_sources_t *sources)
+{
+	if (data_size < sizeof(struct tle_db_snapshot_header)) {
+		return false;
+	}
+
+	const struct tle_db_snapshot_header *header = (const struct tle_db_snapshot_header*)data;
+	if ((memcmp(header->magic, TLE_DB_SNAPSHOT_MAGIC, sizeof(header->magic)) != 0) ||
+		(header->version != TLE_DB_SNAPSHOT_VERSION) ||
+		(header->entry_size != sizeof(struct tle_db_snapshot_entry)) ||
+		(header->num_sources != (uint32_t)sources->num_sources)) {
+		return false;
+	}
+
+	//check that the file has the expected size, and that the string table is terminated
+	uint64_t expected_size = sizeof(struct tle_db_snapshot_header) +
+		(uint64_t)header->num_sources*sizeof(struct tle_db_snapshot_source_record) +
+		(uint64_t)header->num_entries*sizeof(struct tle_db_snapshot_entry) +
+		header->strings_size;
+	if ((expected_size != data_size) || (header->strings_size == 0) || (data[data_size-1] != '\0')) {
+		return false;
+	}
+
+	const struct tle_db_snapshot_source_record *records = (const struct tle_db_snapshot_source_record*)(data + sizeof(struct tle_db_snapshot_header));
+	const char *strings = data + data_size - header->strings_size;
+
+	//compare recorded source files against current source files
+	for (int i=0; i < sources->num_sources; i++) {
+		const char *path = tle_db_snapshot_string(strings, header->strings_size, records[i].path_offset);
+		if ((path == NULL) || (strcmp(path, sources->sources[i].path) != 0) ||
+			(records[i].mtime_sec != sources->sources[i].mtime_sec) ||
+			(records[i].mtime_nsec != sources->sources[i].mtime_nsec) ||
+			(records[i].size != sources->sources[i].size)) {
+			return false;
+		}
+	}
+	return true;
+}
+
+int tle_db_snapshot_read(const char *snapshot_file, const tle_db_snapshot_sources_t *sources, struct tle_db *ret_db)
+{
+	int fd = open(snapshot_file, O_RDONLY);
+	if (fd == -1) {
+		return -1;
+	}
+
+	struct stat file_stat;
+	if ((fstat(fd, &file_stat) != 0) || (file_stat.st_size == 0)) {
+		close(fd);
+		return -1;
+	}
+	size_t data_size = file_stat.st_size;
+
+	const char *data = (const char*)mmap(NULL, data_size, PROT_READ, MAP_PRIVATE, fd, 0);
+	close(fd);
+	if (data == MAP_FAILED) {
+		return -1;
+	}
+
+	int retval = -1;
+	if (tle_db_snapshot_valid(data, data_size, sources)) {
+		const struct tle_db_snapshot_header *header = (const struct tle_db_snapshot_header*)data;
+		const struct tle_db_snapshot_entry *entries = (const struct tle_db_snapshot_entry*)(data + sizeof(struct tle_db_snapshot_header) + header->num_sources*sizeof(struct tle_db_snapshot_source_record));
+		const char *strings = data + data_size - header->strings_size;
+
+		retval = 0;
+		for (uint32_t i=0; i < header->num_entries; i++) {
+			struct tle_db_entry entry = {0};
+			entry.name = tle_db_snapshot_string(strings, header->strings_size, entries[i].name_offset);
+			entry.filename = tle_db_snapshot_string(strings, header->strings_size, entries[i].filename_offset);
+			if ((entry.name == NULL) || (entry.filename == NULL)) {
+				retval = -1;
+				break;
+			}
+
+			entry.satellite_number = entries[i].satellite_number;
+			memcpy(entry.line1, entries[i].line1, TLE_LINE_LENGTH);
+			memcpy(entry.line2, entries[i].line2, TLE_LINE_LENGTH);
+			entry.epoch_year = entries[i].epoch_year;
+			entry.epoch_day = entries[i].epoch_day;
+			entry.epoch = entry.epoch_year*1000.0 + entry.epoch_day;
+
+			if (tle_db_add_entry(ret_db, &entry) != 0) {
+				retval = -1;
+				break;
+			}
+		}
+
+		//do not leave a partially read database behind
+		if (retval != 0) {
+			tle_db_free(ret_db);
+		}
+	}
+
+	munmap((void*)data, data_size);
+	return retval;
+}
+
+/**
+ * String table under construction, for writing to snapshot file.
+ **/
+struct tle_db_snapshot_strings {
+	///String data
+	char *data;
+	///Used size
+	uint64_t size;
+	///Available size
+	uint64_t available_size;
+};
+
+/**
+ * Append string to string table.
+ *
+ * \param strings String table
+ * \param string String to append
+ * \param ret_offset Returned offset of string in string table
+ * \return 0 on success, -1 on failure
+ **/
+int tle_db_snapshot_strings_add(struct tle_db_snapshot_strings *strings, const char *string, uint64_t *ret_offset)
+{
+	uint64_t length = strlen(string) + 1;
+	if (strings->size + length > strings->available_size) {
+		uint64_t new_size = (strings->available_size > 0) ? strings->available_size*2 : 4096;
+		while (new_size < strings->size + length) {
+			new_size *= 2;
+		}
+		char *temp = (char*)realloc(strings->data, new_size);
+		if (temp == NULL) {
+			return -1;
+		}
+		strings->data = temp;
+		strings->available_size = new_size;
+	}
+	memcpy(strings->data + strings->size, string, length);
+	*ret_offset = strings->size;
+	strings->size += length;
+	return 0;
+}
+
+/**
+ * Fill source records, entry records and string table of snapshot from TLE database.
+ *
+ * \param sources Source files
+ * \param tle_db TLE database
+ * \param records Returned source records, of size `sources->num_sources`
+ * \param entries Returned entry records, of size `tle_db->num_tles`
+ * \param strings Returned string table
+ * \return 0 on success, -1 on failure
+ **/
+int tle_db_snapshot_serialize(const tle_db_snapshot_sources_t *sources, const struct tle_db *tle_db, struct tle_db_snapshot_source_record *records, struct tle_db_snapshot_entry *entries, struct tle_db_snapshot_strings *strings)
+{
+	for (int i=0; i < sources->num_sources; i++) {
+		records[i].mtime_sec = sources->sources[i].mtime_sec;
+		records[i].mtime_nsec = sources->sources[i].mtime_nsec;
+		records[i].size = sources->sources[i].size;
+		if (tle_db_snapshot_strings_add(strings, sources->sources[i].path, &(records[i].path_offset)) != 0) {
+			return -1;
+		}
+	}
+
+	//filenames are interned in the TLE database, so consecutive entries from the same file share the filename pointer
+	const char *prev_filename = NULL;
+	uint64_t filename_offset = 0;
+	for (int i=0; i < tle_db->num_tles; i++) {
+		const struct tle_db_entry *tle = &(tle_db->tles[i]);
+		uint64_t name_offset = 0;
+		if (tle->filename != prev_filename) {
+			if (tle_db_snapshot_strings_add(strings, tle->filename, &filename_offset) != 0) {
+				return -1;
+			}
+			prev_filename = tle->filename;
+		}
+		if ((tle_db_snapshot_strings_add(strings, tle->name, &name_offset) != 0) || (strings->size > UINT32_MAX)) {
+			return -1;
+		}
+
+		entries[i].satellite_number = tle->satellite_number;
+		entries[i].epoch_day = tle->epoch_day;
+		entries[i].epoch_year = tle->epoch_year;
+		entries[i].name_offset = name_offset;
+		entries[i].filename_offset = filename_offset;
+		memcpy(entries[i].line1, tle->line1, TLE_LINE_LENGTH+1);
+		memcpy(entries[i].line2, tle->line2, TLE_LINE_LENGTH+1);
+	}
+
+	//string table is never empty, simplifies validation
+	uint64_t dummy_offset;
+	return tle_db_snapshot_strings_add(strings, "", &dummy_offset);
+}
+
+int tle_db_snapshot_write(const char *snapshot_file, const tle_db_snapshot_sources_t *sources, const struct tle_db *tle_db)
+{
+	struct tle_db_snapshot_strings strings = {0};
+	struct tle_db_snapshot_source_record *records = (struct tle_db_snapshot_source_record*)calloc(sources->num_sources+1, sizeof(struct tle_db_snapshot_source_record));
+	struct tle_db_snapshot_entry *entries = (struct tle_db_snapshot_entry*)calloc(tle_db->num_tles+1, sizeof(struct tle_db_snapshot_entry));
+	int retval = -1;
+
+	if ((records != NULL) && (entries != NULL) && (tle_db_snapshot_serialize(sources, tle_db, records, entries, &strings) == 0)) {
+		struct tle_db_snapshot_header header = {{0}};
+		memcpy(header.magic, TLE_DB_SNAPSHOT_MAGIC, sizeof(header.magic));
+		header.version = TLE_DB_SNAPSHOT_VERSION;
+		header.entry_size = sizeof(struct tle_db_snapshot_entry);
+		header.num_sources = sources->num_sources;
+		header.num_entries = tle_db->num_tles;
+		header.strings_size = strings.size;
+
+		//write to uniquely named temporary file in the same directory and move in place, so that concurrently
+		//writing instances never write to the same temporary file
+		create_xdg_dirs();
+		int temp_size = strlen(snapshot_file) + strlen(".XXXXXX") + 1;
+		char *temp_file = (char*)malloc(sizeof(char)*temp_size);
+		snprintf(temp_file, temp_size, "%s.XXXXXX", snapshot_file);
+
+		int temp_fd = mkstemp(temp_file);
+		FILE *fd = (temp_fd >= 0) ? fdopen(temp_fd, "wb") : NULL;
+		if ((fd == NULL) && (temp_fd >= 0)) {
+			close(temp_fd);
+			unlink(temp_file);
+		}
+		if (fd != NULL) {
+			bool written = (fwrite(&header, sizeof(header), 1, fd) == 1) &&
+				(fwrite(records, sizeof(struct tle_db_snapshot_source_record), sources->num_sources, fd) == (size_t)sources->num_sources) &&
+				(fwrite(entries, sizeof(struct tle_db_snapshot_entry), tle_db->num_tles, fd) == (size_t)tle_db->num_tles) &&
+				(fwrite(strings.data, 1, strings.size, fd) == strings.size);
+			written = (fclose(fd) == 0) && written;
+
+			if (written && (rename(temp_file, snapshot_file) == 0)) {
+				retval = 0;
+			} else {
+				unlink(temp_file);
+			}
+		}
+		free(temp_file);
+	}
+
+	free(strings.data);
+	free(records);
+	free(entries);
+	return retval;
+}
@@ -0,0 +1,93 @@
+#ifndef TLE_DB_SNAPSHOT_H_DEFINED
+#define TLE_DB_SNAPSHOT_H_DEFINED
+
+#include <stdint.h>
+#include "tle_db.h"
+#include "string_array.h"
+#include "xdg_basedirs.h"
+
+/**
+ * Functions for caching the merged TLE database from the XDG search paths in a binary snapshot file,
+ * so that the TLE files do not have to be parsed again on startup when none of them have changed.
+ *
+ * The snapshot records the path, modification time and size of each TLE file that was used in
+ * building the database, and is only used when the same set of files with the same modification times
+ * and sizes is found in the search paths.
+ **/
+
+//default relative path of TLE database snapshot within XDG_CACHE_HOME
+#define TLE_DB_SNAPSHOT_RELATIVE_FILE_PATH FLYBY_RELATIVE_ROOT_PATH "tles.snapshot"
+
+/**
+ * Source file of TLE database.
+ **/
+struct tle_db_snapshot_source {
+	///Path to file
+	char *path;
+	///Modification time, seconds part
+	int64_t mtime_sec;
+	///Modification time, nanoseconds part
+	int64_t mtime_nsec;
+	///File size
+	int64_t size;
+};
+
+/**
+ * List of source files of TLE database, in the order they are read.
+ **/
+typedef struct {
+	///Number of source files
+	int num_sources;
+	///Available size in `sources` array
+	int available_size;
+	///Source files
+	struct tle_db_snapshot_source *sources;
+} tle_db_snapshot_sources_t;
+
+/**
+ * Get source files for TLE database, in the same order as tle_db_from_directory() reads them.
+ * Non-existing directories are ignored.
+ *
+ * \param directories TLE directories, in the order they are read
+ * \param ret_sources Returned list of source files
+ **/
+void tle_db_snapshot_sources_from_directories(string_array_t *directories, tle_db_snapshot_sources_t *ret_sources);
+
+/**
+ * Free memory associated with list of source files.
+ *
+ * \param sources List of source files
+ **/
+void tle_db_snapshot_sources_free(tle_db_snapshot_sources_t *sources);
+
+/**
+ * Get default path to the TLE database snapshot, {XDG_CACHE_HOME}/flyby/tles.snapshot.
+ *
+ * \return Allocated path, to be freed by the caller
+ **/
+char *tle_db_snapshot_default_path();
+
+/**
+ * Read TLE database from snapshot file. The snapshot file is memory-mapped, and entries are
+ * only added to the TLE database when the header is valid and the recorded source files match the
+ * supplied source files.
+ *
+ * \param snapshot_file Snapshot file
+ * \param sources Current source files of TLE database
+ * \param ret_db Returned TLE database, assumed to be empty
+ * \return 0 on success, -1 when the snapshot is missing, invalid or outdated
+ **/
+int tle_db_snapshot_read(const char *snapshot_file, const tle_db_snapshot_sources_t *sources, struct tle_db *ret_db);
+
+/**
+ * Write TLE database to snapshot file. The file is written to a temporary file which is moved in place,
+ * so that concurrently running instances never see a partially written snapshot.
+ *
+ * \param snapshot_file Snapshot file
+ * \param sources Source files from which the TLE database was read, as obtained before reading the files
+ * \param tle_db TLE database
+ * \return 0 on success, -1 on failure
+ **/
+int tle_db_snapshot_write(const char *snapshot_file, const tle_db_snapshot_sources_t *sources, const struct tle_db *tle_db);
+
+#endif
@@ -0,0 +1,223 @@
+#include "tle_file.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+//minimum length of a TLE line, excluding line endings
+#define TLE_FILE_LINE_LENGTH 69
+
+/**
+ * Line within TLE file.
+ **/
+struct tle_file_line {
+	///Offset of line start
+	long offset;
+	///Line length, excluding line ending
+	long length;
+};
+
+/**
+ * Get next line in file contents.
+ *
+ * \param data File contents
+ * \param size Size of file contents
+ * \param offset Offset at which line starts
+ * \param ret_line Returned line
+ * \return Offset of the following line
+ **/
+long tle_file_next_line(const char *data, size_t size, long offset, struct tle_file_line *ret_line)
+{
+	const char *newline = (const char*)memchr(data + offset, '\n', size - offset);
+	long end = (newline != NULL) ? newline - data : (long)size;
+
+	ret_line->offset = offset;
+	ret_line->length = end - offset;
+
+	//CRLF line endings
+	if ((ret_line->length > 0) && (data[end-1] == '\r')) {
+		ret_line->length--;
+	}
+
+	return (newline != NULL) ? end + 1 : end;
+}
+
+/**
+ * Check whether two lines are candidates for a TLE, to be validated using tle_checksum_validate_batch().
+ *
+ * \param data File contents
+ * \param line1 Line 1 candidate
+ * \param line2 Line 2 candidate
+ * \return True if the lines are long enough and start with the correct line numbers
+ **/
+bool tle_file_lines_are_candidate(const char *data, const struct tle_file_line *line1, const struct tle_file_line *line2)
+{
+	return (line1->length >= TLE_FILE_LINE_LENGTH) && (line2->length >= TLE_FILE_LINE_LENGTH) &&
+		(data[line1->offset] == '1') && (data[line2->offset] == '2');
+}
+
+/**
+ * Add record to TLE file.
+ *
+ * \param file TLE file
+ * \param name Name line, NULL if TLE has no name line
+ * \param line1 Line 1
+ * \param line2 Line 2
+ **/
+void tle_file_add_record(tle_file_t *file, const struct tle_file_line *name, const struct tle_file_line *line1, const struct tle_file_line *line2)
+{
+	if (file->num_records+1 > file->available_size) {
+		int new_size = (file->available_size > 0) ? file->available_size*2 : 64;
+		struct tle_file_record *temp = (struct tle_file_record*)realloc(file->records, sizeof(struct tle_file_record)*new_size);
+		if (temp == NULL) {
+			return;
+		}
+		file->records = temp;
+		file->available_size = new_size;
+	}
+
+	struct tle_file_record *record = &(file->records[file->num_records++]);
+	record->line1_offset = line1->offset;
+	record->line2_offset = line2->offset;
+	record->name_offset = -1;
+	record->name_length = 0;
+
+	if (name != NULL) {
+		//cut out surrounding blanks, and the "0 " prefix used in some 3LE sources
+		long start = name->offset;
+		long end = name->offset + name->length;
+		if ((end - start >= 2) && (file->data[start] == '0') && (file->data[start+1] == ' ')) {
+			start += 2;
+		}
+		while ((start < end) && isspace((unsigned char)file->data[start])) {
+			start++;
+		}
+		while ((end > start) && isspace((unsigned char)file->data[end-1])) {
+			end--;
+		}
+
+		if (end > start) {
+			record->name_offset = start;
+			record->name_length = end - start;
+		}
+	}
+}
+
+int tle_file_open(const char *filename, tle_file_t *ret_file)
+{
+	memset(ret_file, 0, sizeof(tle_file_t));
+
+	int fd = open(filename, O_RDONLY);
+	if (fd == -1) {
+		return -1;
+	}
+
+	struct stat file_stat;
+	if (fstat(fd, &file_stat) != 0) {
+		close(fd);
+		return -1;
+	}
+
+	//empty files can't be mapped, but are valid
+	ret_file->size = file_stat.st_size;
+	if (ret_file->size == 0) {
+		close(fd);
+		return 0;
+	}
+
+	void *data = mmap(NULL, ret_file->size, PROT_READ, MAP_PRIVATE, fd, 0);
+	close(fd);
+	if (data == MAP_FAILED) {
+		ret_file->size = 0;
+		return -1;
+	}
+	ret_file->data = (const char*)data;
+	madvise(data, ret_file->size, MADV_SEQUENTIAL);
+
+	//locate all line boundaries
+	int num_lines = 0;
+	int available_lines = 0;
+	struct tle_file_line *lines = NULL;
+	long offset = 0;
+	while (offset < (long)ret_file->size) {
+		if (num_lines+1 > available_lines) {
+			available_lines = (available_lines > 0) ? available_lines*2 : 256;
+			lines = (struct tle_file_line*)realloc(lines, sizeof(struct tle_file_line)*available_lines);
+		}
+		offset = tle_file_next_line(ret_file->data, ret_file->size, offset, &(lines[num_lines++]));
+	}
+
+	//collect line pairs that might be TLEs. Line 1 and line 2 start with different characters, so candidates never overlap
+	int num_candidates = 0;
+	int *candidates = (int*)malloc(sizeof(int)*(num_lines+1));
+	const char **candidate_line1 = (const char**)malloc(sizeof(const char*)*(num_lines+1));
+	const char **candidate_line2 = (const char**)malloc(sizeof(const char*)*(num_lines+1));
+	for (int i=0; i+1 < num_lines; i++) {
+		if (tle_file_lines_are_candidate(ret_file->data, &(lines[i]), &(lines[i+1]))) {
+			candidates[num_candidates] = i;
+			candidate_line1[num_candidates] = ret_file->data + lines[i].offset;
+			candidate_line2[num_candidates] = ret_file->data + lines[i+1].offset;
+			num_candidates++;
+			i++;
+		}
+	}
+
+	//validate all candidates in one batch
+	bool *valid = (bool*)malloc(sizeof(bool)*(num_candidates+1));
+	tle_checksum_validate_batch(candidate_line1, candidate_line2, num_candidates, valid);
+
+	//the line preceding a TLE is its name, unless it belongs to the previous TLE
+	int last_consumed_line = -1;
+	for (int i=0; i < num_candidates; i++) {
+		if (valid[i]) {
+			int line_index = candidates[i];
+			bool has_name = (line_index-1 > last_consumed_line);
+			tle_file_add_record(ret_file, has_name ? &(lines[line_index-1]) : NULL, &(lines[line_index]), &(lines[line_index+1]));
+			last_consumed_line = line_index+1;
+		}
+	}
+
+	free(valid);
+	free(candidate_line2);
+	free(candidate_line1);
+	free(candidates);
+	free(lines);
+	return 0;
+}
+
+void tle_file_close(tle_file_t *file)
+{
+	if (file->data != NULL) {
+		munmap((void*)file->data, file->size);
+	}
+	free(file->records);
+	memset(file, 0, sizeof(tle_file_t));
+}
+
+const char *tle_file_line1(const tle_file_t *file, int record_index)
+{
+	return file->data + file->records[record_index].line1_offset;
+}
+
+const char *tle_file_line2(const tle_file_t *file, int record_index)
+{
+	return file->data + file->records[record_index].line2_offset;
+}
+
+void tle_file_name(const tle_file_t *file, int record_index, char *ret_name, int max_length)
+{
+	const struct tle_file_record *record = &(file->records[record_index]);
+	if (record->name_offset == -1) {
+		//satellite number, columns 3-7 of line 1
+		snprintf(ret_name, max_length, "%.5s", tle_file_line1(file, record_index) + 2);
+		return;
+	}
+
+	int length = (record->name_length < max_length-1) ? record->name_length : max_length-1;
+	memcpy(ret_name, file->data + record->name_offset, length);
+	ret_name[length] = '\0';
+}
@@ -0,0 +1,89 @@
+#ifndef TLE_FILE_H_DEFINED
+#define TLE_FILE_H_DEFINED
+
+#include <stddef.h>
+#include <stdbool.h>
+#include "tle_checksum.h"
+
+/**
+ * Memory-mapped TLE file scanner. The file is mapped into memory and scanned for line boundaries
+ * in place, without copying the file contents. Supports the three-line format (name line followed by
+ * the two TLE lines), the two-line format without name lines, and a mix of both. Both LF and CRLF
+ * line endings are accepted. The optional "0 " prefix used for name lines in some 3LE sources is skipped.
+ **/
+
+/**
+ * Location of a TLE within the memory-mapped file.
+ **/
+struct tle_file_record {
+	///Offset of satellite name in the mapping, -1 if the TLE has no name line
+	long name_offset;
+	///Length of satellite name, with surrounding whitespace removed
+	int name_length;
+	///Offset of line 1 in the mapping
+	long line1_offset;
+	///Offset of line 2 in the mapping
+	long line2_offset;
+};
+
+/**
+ * Memory-mapped TLE file.
+ **/
+typedef struct {
+	///File contents
+	const char *data;
+	///Size of file contents
+	size_t size;
+	///Number of valid TLEs found in file
+	int num_records;
+	///Available size in `records` array
+	int available_size;
+	///Valid TLEs found in file, in file order
+	struct tle_file_record *records;
+} tle_file_t;
+
+/**
+ * Map TLE file into memory and locate all valid TLEs within it.
+ *
+ * \param filename TLE file
+ * \param ret_file Returned TLE file. Has to be closed using tle_file_close()
+ * \return 0 on success, -1 if the file could not be opened or mapped
+ **/
+int tle_file_open(const char *filename, tle_file_t *ret_file);
+
+/**
+ * Unmap TLE file and free associated memory. Pointers into the file contents become invalid.
+ *
+ * \param file TLE file
+ **/
+void tle_file_close(tle_file_t *file);
+
+/**
+ * Get pointer to line 1 of TLE. The line is not null-terminated, but at least 69 characters long.
+ *
+ * \param file TLE file
+ * \param record_index Index of TLE in file
+ * \return Pointer into file contents
+ **/
+const char *tle_file_line1(const tle_file_t *file, int record_index);
+
+/**
+ * Get pointer to line 2 of TLE. The line is not null-terminated, but at least 69 characters long.
+ *
+ * \param file TLE file
+ * \param record_index Index of TLE in file
+ * \return Pointer into file contents
+ **/
+const char *tle_file_line2(const tle_file_t *file, int record_index);
+
+/**
+ * Copy satellite name of TLE into buffer. TLEs without a name line get the satellite number as name.
+ *
+ * \param file TLE file
+ * \param record_index Index of TLE in file
+ * \param ret_name Returned name, null-terminated
+ * \param max_length Size of returned name buffer
+ **/
+void tle_file_name(const tle_file_t *file, int record_index, char *ret_name, int max_length);
+
+#endif
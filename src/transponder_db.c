@@ -14,16 +14,43 @@ struct transponder_db *transponder_db_create()
 
 void transponder_db_destroy(struct transponder_db **transponder_db)
 {
+	free((*transponder_db)->sats);
 	free(*transponder_db);
 	*transponder_db = NULL;
 }
 
+/**
+ * Resize transponder database to the given number of entries. New entries are initialized to empty entries.
+ *
+ * \param transponder_db Transponder database
+ * \param num_sats Number of entries
+ * \return 0 on success, -1 on allocation failure
+ **/
+int transponder_db_resize(struct transponder_db *transponder_db, int num_sats)
+{
+	if (num_sats > transponder_db->num_sats) {
+		struct sat_db_entry *temp = (struct sat_db_entry*)realloc(transponder_db->sats, sizeof(struct sat_db_entry)*num_sats);
+		if (temp == NULL) {
+			return -1;
+		}
+		memset(temp + transponder_db->num_sats, 0, sizeof(struct sat_db_entry)*(num_sats - transponder_db->num_sats));
+		for (int i=transponder_db->num_sats; i < num_sats; i++) {
+			temp[i].location = LOCATION_NONE;
+		}
+		transponder_db->sats = temp;
+	}
+	transponder_db->num_sats = num_sats;
+	return 0;
+}
+
 int transponder_db_from_file(const char *dbfile, const struct tle_db *tle_db, struct transponder_db *ret_db, enum sat_db_location location_info)
 {
 	//copied from ReadDataFiles().
 
 	/* Load satellite database file */
-	ret_db->num_sats = tle_db->num_tles;
+	if (transponder_db_resize(ret_db, tle_db->num_tles) != 0) {
+		return -1;
+	}
 	FILE *fd=fopen(dbfile,"r");
 	long catnum;
 	char line1[80] = {0};
@@ -40,15 +67,12 @@ int transponder_db_from_file(const char *dbfile, const struct tle_db *tle_db, st
 
 			/* Search for match */
 
-			for (y=0, match=0; y<tle_db->num_tles && match==0; y++) {
-				if (catnum==tle_db->tles[y].satellite_number)
-					match=1;
-			}
+			y = tle_db_find_entry(tle_db, catnum);
+			match = (y != -1);
 
 			if (match) {
 				transponders=0;
 				entry=0;
-				y--;
 			}
 
 			fgets(line1,40,fd);
@@ -70,7 +94,7 @@ int transponder_db_from_file(const char *dbfile, const struct tle_db *tle_db, st
 					if (match) {
 						if (strncmp(line1,"No",2)!=0) {
 							line1[strlen(line1)-1]=0;
-							strcpy(ret_db->sats[y].transponder_name[entry],line1);
+							snprintf(ret_db->sats[y].transponder_name[entry], MAX_TRANSPONDER_NAME_LENGTH, "%s", line1);
 						} else
 							ret_db->sats[y].transponder_name[entry][0]=0;
 					}
@@ -138,7 +162,8 @@ void transponder_db_from_search_paths(const struct tle_db *tle_db, struct transp
 	free(data_dirs_str);
 
 	//initialize database
-	for (int i=0; i < MAX_NUM_SATS; i++) {
+	transponder_db_resize(transponder_db, tle_db->num_tles);
+	for (int i=0; i < transponder_db->num_sats; i++) {
 		transponder_db->sats[i].squintflag = false;
 		transponder_db->sats[i].num_transponders = 0;
 		transponder_db->sats[i].location = LOCATION_NONE;
@@ -230,7 +255,7 @@ bool transponder_db_entry_equal(struct sat_db_entry *entry_1, struct sat_db_entr
 	}
 
 	for (int i=0; i < entry_1->num_transponders; i++) {
-		if ((strncmp(entry_1->transponder_name[i], entry_2->transponder_name[i], MAX_NUM_CHARS) != 0) ||
+		if ((strncmp(entry_1->transponder_name[i], entry_2->transponder_name[i], MAX_TRANSPONDER_NAME_LENGTH) != 0) ||
 			(entry_1->uplink_start[i] != entry_2->uplink_start[i]) ||
 			(entry_1->uplink_end[i] != entry_2->uplink_end[i]) ||
 			(entry_1->downlink_start[i] != entry_2->downlink_start[i]) ||
@@ -248,7 +273,7 @@ void transponder_db_entry_copy(struct sat_db_entry *destination, struct sat_db_e
 	destination->alon = source->alon;
 	destination->num_transponders = source->num_transponders;
 	for (int i=0; i < source->num_transponders; i++) {
-		strncpy(destination->transponder_name[i], source->transponder_name[i], MAX_NUM_CHARS);
+		strncpy(destination->transponder_name[i], source->transponder_name[i], MAX_TRANSPONDER_NAME_LENGTH);
 	}
 	memcpy(destination->uplink_start, source->uplink_start, MAX_NUM_TRANSPONDERS*sizeof(double));
 	memcpy(destination->uplink_end, source->uplink_end, MAX_NUM_TRANSPONDERS*sizeof(double));
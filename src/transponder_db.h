@@ -27,7 +27,7 @@ struct sat_db_entry {
 	///number of transponders
 	int num_transponders;
 	///name of each transponder
-	char transponder_name[MAX_NUM_TRANSPONDERS][MAX_NUM_CHARS];
+	char transponder_name[MAX_NUM_TRANSPONDERS][MAX_TRANSPONDER_NAME_LENGTH];
 	///uplink frequencies
 	double uplink_start[MAX_NUM_TRANSPONDERS];
 	double uplink_end[MAX_NUM_TRANSPONDERS];
@@ -44,8 +44,8 @@ struct sat_db_entry {
 struct transponder_db {
 	///number of contained satellites. Corresponds to the number of TLEs in the TLE database
 	int num_sats;
-	///transponder database entries
-	struct sat_db_entry sats[MAX_NUM_SATS];
+	///transponder database entries, allocated to match the size of the TLE database when the database is read
+	struct sat_db_entry *sats;
 	///whether the transponder database is loaded, or empty
 	bool loaded;
 };
@@ -388,7 +388,7 @@ void transponder_editor_sysdefault(struct transponder_editor *transponder_editor
 	//create dummy TLE database with a single entry corresponding to the satellite number
 	struct tle_db *dummy_tle_db = tle_db_create();
 	struct transponder_db *dummy_transponder_db = transponder_db_create();
-	struct tle_db_entry dummy_entry;
+	struct tle_db_entry dummy_entry = {0};
 	dummy_entry.satellite_number = transponder_editor->satellite_number;
 	tle_db_add_entry(dummy_tle_db, &dummy_entry);
 
@@ -538,7 +538,8 @@ void transponder_editor_to_db_entry(struct transponder_editor *transponder_edito
 
 		//add to returned database entry if transponder name is defined
 		if (strlen(temp) > 0) {
-			strncpy(db_entry->transponder_name[entry_index], temp, MAX_NUM_CHARS);
+			snprintf(db_entry->transponder_name[entry_index], MAX_TRANSPONDER_NAME_LENGTH, "%.*s", MAX_TRANSPONDER_NAME_LENGTH-1, temp);
+			db_entry->transponder_name[entry_index][MAX_TRANSPONDER_NAME_LENGTH-1] = '\0';
 
 			if (uplink_end == 0.0) {
 				uplink_end = uplink_start;
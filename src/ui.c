@@ -58,11 +58,25 @@
 #include "qth_config.h"
 #include "transponder_editor.h"
 #include "multitrack.h"
+#include "illumination.h"
+#include "pass_tabulation.h"
+#include "output_sink.h"
+#include "event_loop.h"
 
 #define EARTH_RADIUS_KM		6.378137E3		/* WGS 84 Earth radius km */
-#define HALF_DELAY_TIME	5
 #define	KM_TO_MI		0.621371		/* km to miles */
 
+//update intervals of the data sources on the interactive screens (seconds)
+#define MULTITRACK_UPDATE_INTERVAL 1.0
+#define SUN_MOON_UPDATE_INTERVAL 10.0
+#define SINGLETRACK_DISPLAY_INTERVAL 1.0
+#define SINGLETRACK_CONTROL_INTERVAL 0.5
+
+//column headers of the prediction screens
+#define PREDICT_PASS_HEADER "           Date     Time    El   Az  Phase  LatN   LonE    Range   Orbit        "
+#define PREDICT_SUN_MOON_HEADER "           Date     Time    El   Az   RA     Dec    GHA     Vel   Range         "
+#define PREDICT_ILLUMINATION_HEADER "           Date     Mins/Day    Sun           Date     Mins/Day    Sun          "
+
 double reduce(double value, double rangeMin, double rangeMax)
 {
 	double range, rangeFrac, fullRanges, retval;
@@ -175,7 +189,7 @@ void AutoUpdate(const char *string, struct tle_db *tle_db)
 	}
 
 	//update TLE database with file
-	int update_status[MAX_NUM_SATS] = {0};
+	int *update_status = (int*)calloc(tle_db->num_tles, sizeof(int));
 	tle_db_update(filename, tle_db, update_status);
 
 	if (interactive_mode) {
@@ -247,6 +261,7 @@ void AutoUpdate(const char *string, struct tle_db *tle_db)
 			printf("No TLE updates/file not found.\n");
 		}
 	}
+	free(update_status);
 
 	if (interactive_mode) {
 		refresh();
@@ -409,194 +424,106 @@ double GetStartTime(const char* info_str)
 	return ((double)DayNum(mm,dd,yy)+((hr/24.0)+(min/1440.0)+(sec/86400.0)));
 }
 
-int Print(const char *title, const char *string, char mode)
+/**
+ * Prompt the user for the distance between rows in the pass predictions, as a time step, an angular step along the
+ * track of the satellite or only AOS, TCA and LOS. Default is PASS_TABULATION_DEFAULT_ANGULAR_STEP.
+ *
+ * \param info_str Name of satellite
+ * \param ret_mode Returned tabulation mode
+ * \param ret_step Returned step, see pass_tabulation_start()
+ **/
+void GetTabulationStep(const char *info_str, enum pass_tabulation_mode *ret_mode, double *ret_step)
 {
-	char type[20], head2[81];
-	int key, ans=0;
-	static char buffer[5000], lines, quit;
-	static FILE *fd;
-
-	/* Pass a NULL string to initialize the buffer, counter, and flags */
-
-	if (string[0]==0) {
-		lines=0;
-		quit=0;
-		buffer[0]=0;
-		fd=NULL;
-	} else {
-		if (mode=='p')
-			strcpy(type,"Satellite Passes");
-
-		if (mode=='v')
-			strcpy(type,"Visual");
-
-		if (mode=='s')
-			strcpy(type,"Solar Illumination");
+	char string[MAX_NUM_CHARS];
+	while (true) {
+		bkgdset(COLOR_PAIR(2)|A_BOLD);
+		clear();
 
-		if (mode=='m') {
-			strcpy(type,"Moon");
-		}
+		printw("\n\n\n\t     Distance Between Rows for Predictions of ");
+		printw("%-15s\n\n", info_str);
 
-		if (mode=='o') {
-			strcpy(type,"Sun");
-		}
+		attrset(COLOR_PAIR(4)|A_BOLD);
+		printw("\t\t    Format: 60s -or- 10deg -or- events");
 
-		if (mode=='m' || mode=='o') {
-			sprintf(head2,"           Date     Time    El   Az   RA     Dec    GHA     Vel   Range         ");
-		}
+		attrset(COLOR_PAIR(2)|A_BOLD);
+		mvprintw(21,30,"Default is `%.0fdeg'", PASS_TABULATION_DEFAULT_ANGULAR_STEP);
+		attrset(COLOR_PAIR(3)|A_BOLD);
+		mvprintw(13,1,"Enter Step >> ");
+		curs_set(1);
+		refresh();
+		echo();
+		string[0]=0;
+		wgetnstr(stdscr,string,29);
+		curs_set(0);
+		noecho();
 
-		if (mode!='m' && mode!='o') {
-			if (mode=='s')
-				sprintf(head2,"           Date     Mins/Day    Sun           Date     Mins/Day    Sun          ");
-			else {
-				sprintf(head2,"           Date     Time    El   Az  Phase  %s   %s    Range   Orbit        ","LatN","LonE");
-			}
+		if (strlen(string) == 0) {
+			*ret_mode = PASS_TABULATION_ANGULAR_STEP;
+			*ret_step = PASS_TABULATION_DEFAULT_ANGULAR_STEP;
+			return;
 		}
-
-		strcat(buffer,string);
-		lines++;
-//JHJHJH
-		if (lines==(LINES-8)) {
-			attrset(COLOR_PAIR(6)|A_REVERSE|A_BOLD);
-			clear();
-			mvprintw(0,0,"                                                                                ");
-			mvprintw(1,0,"  flyby Calendar :                                                              ");
-			mvprintw(1,21,"%-24s", type);
-			mvprintw(2,0,"                                                                                ");
-			int title_col = 79-strlen(title);
-			mvprintw(1,title_col, "%s", title);
-			attrset(COLOR_PAIR(2)|A_REVERSE|A_BOLD);
-			mvprintw(3,0,head2);
-
-			attrset(COLOR_PAIR(2)|A_BOLD);
-	                mvprintw(4,0,"\n");
-
-			addstr(buffer);
-			attrset(COLOR_PAIR(4)|A_BOLD);
-
-			if (buffer[0]=='\n')
-                              printw("\n");
-
-			if (fd==NULL)
-				mvprintw(LINES-2,63,"        ");
-			else
-				mvprintw(LINES-2,63,"Log = ON");
-
-			mvprintw(LINES-2,6,"More? [y/n] >> ");
-			curs_set(1);
-			refresh();
-
-			while (ans==0) {
-				key=toupper(getch());
-
-				if (key=='Y' || key=='\n' || key==' ') {
-					key='Y';
-					ans=1;
-					quit=0;
-				}
-
-				if (key=='N' || key=='Q' || key==27) {
-					key='N';
-					ans=1;
-					quit=1;
-				}
-
-				buffer[0]=0;
-			}
-
-			lines=0;
-			curs_set(0);
-		}
-	}
-	return (quit);
-}
-
-int PrintVisible(const char *title, const char *string)
-{
-	static char buffer[10000];
-	char line[80], plus, asterisk, visible;
-	int x, y, quit=0;
-
-	if (string[0]==0)
-		buffer[0]=0;
-	else {
-		strcat(buffer,string);
-
-		if (string[0]=='\n') {
-			plus=0;
-			visible=0;
-			asterisk=0;
-
-			for (x=0; buffer[x]!=0 && visible==0; x++) {
-				if (buffer[x]=='+')
-					plus++;
-
-				if (buffer[x]=='*')
-					asterisk++;
-
-				/* At least 3 +'s or at least 2 +'s
-				   combined with at least 2 *'s is
-				   worth displaying as a visible pass. */
-
-				if ((plus>3) || (plus>2 && asterisk>2))
-					visible=1;
-			}
-
-			if (visible) {
-				/* Dump buffer to Print() line by line */
-
-				for (x=0, y=0; buffer[x]!=0 && quit==0; x++) {
-					line[y]=buffer[x];
-
-					if (line[y]=='\n') {
-						line[y+1]=0;
-						quit=Print(title,line,'v');
-						line[0]=0;
-						y=0;
-					} else
-						y++;
-				}
-			}
-
-			buffer[0]=0;
+		if (pass_tabulation_parse_step(string, ret_mode, ret_step) == 0) {
+			return;
 		}
+		beep();
 	}
-
-	return quit;
 }
 
-void Predict(const char *name, predict_orbital_elements_t *orbital_elements, predict_observer_t *qth, char mode)
+void Predict(const char *name, predict_orbital_elements_t *orbital_elements, predict_observer_t *qth, pass_table_t *pass_table, char mode)
 {
-	Print("","",0);
-	PrintVisible("","");
 	bool should_quit = false;
 	bool should_break = false;
-	char data_string[MAX_NUM_CHARS];
 	char time_string[MAX_NUM_CHARS];
 
 	predict_julian_date_t curr_time = GetStartTime(name);
 
+	//visual passes are judged from the number of visible rows, and are always tabulated at the default step
+	enum pass_tabulation_mode tabulation_mode = PASS_TABULATION_ANGULAR_STEP;
+	double tabulation_step = PASS_TABULATION_DEFAULT_ANGULAR_STEP;
+	if (mode != 'v') {
+		GetTabulationStep(name, &tabulation_mode, &tabulation_step);
+	}
+
 	struct predict_orbit orbit;
 	predict_orbit(orbital_elements, &orbit, curr_time);
 	clear();
 
 	char title[MAX_NUM_CHARS] = {0};
 	sprintf(title, "%s (%d)", name, orbital_elements->satellite_number);
+	output_sink_t *sink = output_sink_create_pager(title, (mode == 'v') ? "Visual" : "Satellite Passes", PREDICT_PASS_HEADER);
+
+	//the shared pass table is only used when starting within the passes it already has, since starting it over
+	//at a different time would discard the passes needed by the other screens
+	pass_table_t *local_pass_table = NULL;
+	if ((pass_table == NULL) || !pass_table_covers(pass_table, curr_time)) {
+		local_pass_table = pass_table_create(qth, orbital_elements);
+		pass_table = local_pass_table;
+	}
 
 	if (predict_aos_happens(orbital_elements, qth->latitude) && !predict_is_geostationary(orbital_elements) && !(orbit.decayed)) {
+		int pass_index = pass_table_find_pass(pass_table, curr_time, true);
 		do {
-			predict_julian_date_t next_aos = predict_next_aos(qth, orbital_elements, curr_time);
-			predict_julian_date_t next_los = predict_next_los(qth, orbital_elements, next_aos);
-			curr_time = next_aos;
-
-			struct predict_observation obs;
-			predict_orbit(orbital_elements, &orbit, curr_time);
-			predict_observe_orbit(qth, &orbit, &obs);
-			bool has_printed_last_entry = false;
-			int last_printed_elevation = 1;
-			do {
+			const struct pass_table_pass *pass = pass_table_get_pass(pass_table, pass_index++);
+			if (pass == NULL) {
+				break;
+			}
+
+			//passes are held back until it is known whether they are visible
+			if (mode == 'v') {
+				output_sink_hold(sink);
+			}
+			int num_visible_rows = 0;
+			int num_sunlit_rows = 0;
+
+			pass_tabulation_t tabulation;
+			pass_tabulation_start(&tabulation, qth, orbital_elements, pass, tabulation_mode, tabulation_step);
+			struct pass_tabulation_row row;
+			while (!should_quit && pass_tabulation_next(&tabulation, &row)) {
+				struct predict_observation obs = row.observation;
+				orbit = row.orbit;
+
 				//get formatted time
-				time_t epoch = predict_from_julian(curr_time);
+				time_t epoch = predict_from_julian(row.time);
 				strftime(time_string, MAX_NUM_CHARS, "%a %d%b%y %H:%M:%S", gmtime(&epoch));
 
 				//modulo 256 phase
@@ -606,22 +533,17 @@ void Predict(const char *name, predict_orbital_elements_t *orbital_elements, pre
 				char visibility;
 				if (obs.visible) {
 					visibility = '+';
+					num_visible_rows++;
 				} else if (!(orbit.eclipsed)) {
 					visibility = '*';
+					num_sunlit_rows++;
 				} else {
 					visibility = ' ';
 				}
 
 				//format line of data
-				sprintf(data_string,"      %s%4d %4d  %4d  %4d   %4d   %6ld  %6ld %c\n", time_string, (int)(obs.elevation*180.0/M_PI), (int)(obs.azimuth*180.0/M_PI), ma256, (int)(orbit.latitude*180.0/M_PI), (int)(orbit.longitude*180.0/M_PI), (long)(obs.range), orbit.revolutions, visibility);
-				last_printed_elevation = obs.elevation*180.0/M_PI;
-
-				//print data to screen
-				if (mode=='p') {
-					should_quit=Print(title,data_string,'p');
-				}
+				should_quit = output_sink_printf(sink, "      %s%4d %4d  %4d  %4d   %4d   %6ld  %6ld %c\n", time_string, (int)(obs.elevation*180.0/M_PI), (int)(obs.azimuth*180.0/M_PI), ma256, (int)(orbit.latitude*180.0/M_PI), (int)(orbit.longitude*180.0/M_PI), (long)(obs.range), orbit.revolutions, visibility);
 
-				//print only visible passes to screen
 				if (mode=='v') {
 					nodelay(stdscr,TRUE);
 					attrset(COLOR_PAIR(4));
@@ -636,31 +558,17 @@ void Predict(const char *name, predict_orbital_elements_t *orbital_elements, pre
 					}
 
 					nodelay(stdscr,FALSE);
-
-					should_quit=PrintVisible(title,data_string);
 				}
+			}
 
-				//calculate results for next timestep
-				curr_time += cos((obs.elevation*180/M_PI-1.0)*M_PI/180.0)*sqrt(orbit.altitude)/25000.0; //predict's magic time increment formula
-				predict_orbit(orbital_elements, &orbit, curr_time);
-				predict_observe_orbit(qth, &orbit, &obs);
-
-				//make sure that the last printed line is at elevation 0 (since that looks nicer)
-				if ((last_printed_elevation != 0) && (obs.elevation < 0) && !has_printed_last_entry) {
-					has_printed_last_entry = true;
-					curr_time = next_los;
-
-					predict_orbit(orbital_elements, &orbit, curr_time);
-					predict_observe_orbit(qth, &orbit, &obs);
-				}
-			} while (((obs.elevation >= 0) || (curr_time <= next_los)) && !should_quit);
-
-			if (mode=='p') {
-				should_quit=Print(title,"\n",'p');
+			if (!should_quit) {
+				should_quit = output_sink_write(sink, "\n");
 			}
 
-			if (mode=='v') {
-				should_quit=PrintVisible(title,"\n");
+			if (mode == 'v') {
+				//at least 4 rows where the satellite is visible, or at least 3 visible rows combined with at least 3 sunlit rows, is worth displaying as a visible pass
+				bool visible = (num_visible_rows > 3) || ((num_visible_rows > 2) && (num_sunlit_rows > 2));
+				should_quit = output_sink_release(sink, visible);
 			}
 		} while (!should_quit && !should_break && !(orbit.decayed));
 	} else {
@@ -682,6 +590,11 @@ void Predict(const char *name, predict_orbital_elements_t *orbital_elements, pre
 		bkgdset(COLOR_PAIR(1));
 		refresh();
 	}
+
+	output_sink_destroy(&sink);
+	if (local_pass_table != NULL) {
+		pass_table_destroy(&local_pass_table);
+	}
 }
 
 void celestial_predict(enum celestial_object object, predict_observer_t *qth, predict_julian_date_t time, struct predict_observation *obs)
@@ -698,19 +611,18 @@ void celestial_predict(enum celestial_object object, predict_observer_t *qth, pr
 
 void PredictSunMoon(enum celestial_object object, predict_observer_t *qth)
 {
-	char print_mode;
+	char type[MAX_NUM_CHARS];
 	char name_str[MAX_NUM_CHARS];
 	switch (object){
 		case PREDICT_SUN:
-			print_mode='o';
+			strcpy(type, "Sun");
 			strcpy(name_str, "the Sun");
 		break;
 		case PREDICT_MOON:
-			print_mode='m';
+			strcpy(type, "Moon");
 			strcpy(name_str, "the Moon");
 		break;
 	}
-	Print("","",0);
 
 	int iaz, iel, lastel=0;
 	char string[MAX_NUM_CHARS], quit=0;
@@ -720,6 +632,7 @@ void PredictSunMoon(enum celestial_object object, predict_observer_t *qth)
 	predict_julian_date_t daynum = GetStartTime(name_str);
 	clear();
 	struct predict_observation obs = {0};
+	output_sink_t *sink = output_sink_create_pager("", type, PREDICT_SUN_MOON_HEADER);
 
 	const double HORIZON_THRESHOLD = 0.03;
 	const double REDUCTION_FACTOR = 0.004;
@@ -753,7 +666,7 @@ void PredictSunMoon(enum celestial_object object, predict_observer_t *qth)
 			time_t epoch = predict_from_julian(daynum);
 			strftime(time_string, MAX_NUM_CHARS, "%a %d%b%y %H:%M:%S", gmtime(&epoch));
 			sprintf(string,"      %s%4d %4d  %5.1f  %5.1f  %5.1f  %6.1f%7.3f\n",time_string, iel, iaz, right_ascension, declination, longitude, obs.range_rate, obs.range);
-			quit=Print("",string,print_mode);
+			quit=output_sink_write(sink,string);
 			lastel=iel;
 			lastdaynum=daynum;
 
@@ -780,15 +693,17 @@ void PredictSunMoon(enum celestial_object object, predict_observer_t *qth)
 			strftime(time_string, MAX_NUM_CHARS, "%a %d%b%y %H:%M:%S", gmtime(&epoch));
 
 			sprintf(string,"      %s%4d %4d  %5.1f  %5.1f  %5.1f  %6.1f%7.3f\n",time_string, iel, iaz, right_ascension, declination, longitude, obs.range_rate, obs.range);
-			quit=Print("",string,print_mode);
+			quit=output_sink_write(sink,string);
 			lastel=iel;
 		} //will continue until we have elevation 0 at the end of the pass
 
-		quit=Print("","\n",'o');
+		quit=output_sink_write(sink,"\n");
 		daynum+=0.4;
 		rise=0.0;
 
 	} while (quit==0);
+
+	output_sink_destroy(&sink);
 }
 
 void ShowOrbitData(const char *name, predict_orbital_elements_t *orbital_elements)
@@ -1015,6 +930,19 @@ void QthEdit(const char *qthfile, predict_observer_t *qth)
 	delwin(form_win);
 }
 
+/**
+ * Read key from the keyboard without blocking.
+ *
+ * \return Key, or ERR if no key is available
+ **/
+int ReadKey()
+{
+	nodelay(stdscr, TRUE);
+	int key = getch();
+	nodelay(stdscr, FALSE);
+	return key;
+}
+
 /**
  * Get next enabled entry within the TLE database. Used for navigating between enabled satellites within SingleTrack().
  *
@@ -1036,16 +964,31 @@ int get_next_enabled_satellite(int curr_index, int step, struct tle_db *tle_db)
 	return curr_index;
 }
 
-void SingleTrack(int orbit_ind, predict_observer_t *qth, struct transponder_db *sat_db, struct tle_db *tle_db, rotctld_info_t *rotctld, rigctld_info_t *downlink_info, rigctld_info_t *uplink_info)
+void SingleTrack(int orbit_ind, predict_observer_t *qth, struct transponder_db *sat_db, struct tle_db *tle_db, multitrack_listing_t *listing, rotctld_info_t *rotctld, rigctld_info_t *downlink_info, rigctld_info_t *uplink_info)
 {
 	double horizon = rotctld->tracking_horizon;
 
 	struct sat_db_entry *sat_db_entries = sat_db->sats;
 	struct tle_db_entry *tle_db_entries = tle_db->tles;
 
-	int     ans;
+	int     ans = ERR;
 	bool	downlink_update=true, uplink_update=true, readfreq=false;
 
+	//sleep until a key is pressed, the display is due for an update, or the rig and rotator are due for an update.
+	//The latter are only updated separately when connected
+	event_loop_t *loop = event_loop_create();
+	event_loop_add_fd(loop, STDIN_FILENO);
+	int display_timer = event_loop_add_timer(loop, SINGLETRACK_DISPLAY_INTERVAL);
+	int control_timer = -1;
+	if (rotctld->connected || downlink_info->connected || uplink_info->connected) {
+		control_timer = event_loop_add_timer(loop, SINGLETRACK_CONTROL_INTERVAL);
+	}
+
+	//replies from rotctld and rigctld are handled as they arrive, sending any queued commands
+	int rotctld_source = rotctld->connected ? event_loop_add_fd(loop, rotctld->connection.socket) : -1;
+	int downlink_source = downlink_info->connected ? event_loop_add_fd(loop, downlink_info->connection.socket) : -1;
+	int uplink_source = uplink_info->connected ? event_loop_add_fd(loop, uplink_info->connection.socket) : -1;
+
 	do {
 		int     length, xponder=0,
 			polarity=0;
@@ -1071,6 +1014,17 @@ void SingleTrack(int orbit_ind, predict_observer_t *qth, struct transponder_db *
 		struct predict_orbit orbit;
 		struct sat_db_entry sat_db = sat_db_entries[orbit_ind];
 
+		//reuse passes already calculated in the satellite listing
+		pass_table_t *pass_table = NULL;
+		pass_table_t *local_pass_table = NULL;
+		if (listing != NULL) {
+			pass_table = multitrack_pass_table(listing, orbit_ind);
+		}
+		if (pass_table == NULL) {
+			local_pass_table = pass_table_create(qth, orbital_elements);
+			pass_table = local_pass_table;
+		}
+
 		switch (orbital_elements->ephemeris) {
 			case EPHEMERIS_SGP4:
 				strcpy(ephemeris_string, "SGP4");
@@ -1122,7 +1076,6 @@ void SingleTrack(int orbit_ind, predict_observer_t *qth, struct transponder_db *
 		predict_orbit(orbital_elements, &orbit, daynum);
 		bool decayed = orbit.decayed;
 
-		halfdelay(HALF_DELAY_TIME);
 		curs_set(0);
 		bkgdset(COLOR_PAIR(3));
 		clear();
@@ -1154,249 +1107,292 @@ void SingleTrack(int orbit_ind, predict_observer_t *qth, struct transponder_db *
 			mvprintw(11,55,"Path loss :");
 		}
 
+		bool first_redraw = true;
 		do {
-			if (downlink_info->connected && readfreq)
-				downlink = rigctld_read_frequency(downlink_info)/(1+1.0e-08*doppler100);
-			if (uplink_info->connected && readfreq)
-				uplink = rigctld_read_frequency(uplink_info)/(1-1.0e-08*doppler100);
-
-
-			//predict and observe satellite orbit
-			time_t epoch = time(NULL);
-			daynum = predict_to_julian(epoch);
-			predict_orbit(orbital_elements, &orbit, daynum);
-			struct predict_observation obs;
-			predict_observe_orbit(qth, &orbit, &obs);
-			double sat_vel = sqrt(pow(orbit.velocity[0], 2.0) + pow(orbit.velocity[1], 2.0) + pow(orbit.velocity[2], 2.0));
-			double squint = predict_squint_angle(qth, &orbit, sat_db.alon, sat_db.alat);
-
-			//display current time
-			attrset(COLOR_PAIR(6)|A_REVERSE|A_BOLD);
-			strftime(time_string, MAX_NUM_CHARS, "%a %d%b%y %j.%H:%M:%S", gmtime(&epoch));
-			mvprintw(1,54,"%s",time_string);
-
-			attrset(COLOR_PAIR(4)|A_BOLD);
-			mvprintw(5,8,"N");
-			mvprintw(6,8,"E");
-
-			//display satellite data
-			attrset(COLOR_PAIR(2)|A_BOLD);
-			mvprintw(5,1,"%-6.2f",orbit.latitude*180.0/M_PI);
-
-			attrset(COLOR_PAIR(2)|A_BOLD);
-			mvprintw(5,55,"%0.f ",orbit.altitude*KM_TO_MI);
-			mvprintw(6,55,"%0.f ",orbit.altitude);
-			mvprintw(5,68,"%-5.0f",obs.range*KM_TO_MI);
-			mvprintw(6,68,"%-5.0f",obs.range);
-			mvprintw(6,1,"%-7.2f",orbit.longitude*180.0/M_PI);
-			mvprintw(5,15,"%-7.2f",obs.azimuth*180.0/M_PI);
-			mvprintw(6,14,"%+-6.2f",obs.elevation*180.0/M_PI);
-			mvprintw(5,29,"%0.f ",(3600.0*sat_vel)*KM_TO_MI);
-			mvprintw(6,29,"%0.f ",3600.0*sat_vel);
-			mvprintw(18,3,"%+6.2f deg",orbit.eclipse_depth*180.0/M_PI);
-			mvprintw(18,20,"%5.1f",256.0*(orbit.phase/(2*M_PI)));
-			mvprintw(18,37,"%s",ephemeris_string);
-			if (sat_db.squintflag) {
-				mvprintw(18,52,"%+6.2f",squint);
-			} else {
-				mvprintw(18,52,"N/A");
-			}
-			mvprintw(5,42,"%0.f ",orbit.footprint*KM_TO_MI);
-			mvprintw(6,42,"%0.f ",orbit.footprint);
-
-			attrset(COLOR_PAIR(1)|A_BOLD);
-			mvprintw(20,1,"Orbit Number: %ld", orbit.revolutions);
+			if (event_loop_ready(loop, rotctld_source))
+				rotctld_process(rotctld);
+			if (event_loop_ready(loop, downlink_source))
+				rigctld_process(downlink_info);
+			if (event_loop_ready(loop, uplink_source))
+				rigctld_process(uplink_info);
+
+			//rig and rotator are controlled at their own interval, and immediately after keyboard input
+			bool control = event_loop_ready(loop, control_timer) || (ans != ERR);
+
+			//the display is updated at its own interval, and immediately after keyboard input. Replies from rotctld
+			//and rigctld only get processed
+			bool redraw = event_loop_ready(loop, display_timer) || (ans != ERR) || first_redraw;
+			first_redraw = false;
+
+			//frequencies are read without waiting for the rig, and applied once the replies have arrived
+			if (downlink_info->connected && readfreq && control)
+				rigctld_request_frequency(downlink_info);
+			if (uplink_info->connected && readfreq && control)
+				rigctld_request_frequency(uplink_info);
+			double read_frequency;
+			if (downlink_info->connected && rigctld_frequency_available(downlink_info, &read_frequency) && readfreq)
+				downlink = read_frequency/(1+1.0e-08*doppler100);
+			if (uplink_info->connected && rigctld_frequency_available(uplink_info, &read_frequency) && readfreq)
+				uplink = read_frequency/(1-1.0e-08*doppler100);
+
+
+			//position, rig and rotator are only recomputed when either the display or the rig/rotator are due
+			if (redraw || control) {
+				//predict and observe satellite orbit
+				time_t epoch = time(NULL);
+				daynum = predict_to_julian(epoch);
+				predict_orbit(orbital_elements, &orbit, daynum);
+				struct predict_observation obs;
+				predict_observe_orbit(qth, &orbit, &obs);
+				double sat_vel = sqrt(pow(orbit.velocity[0], 2.0) + pow(orbit.velocity[1], 2.0) + pow(orbit.velocity[2], 2.0));
+				double squint = predict_squint_angle(qth, &orbit, sat_db.alon, sat_db.alat);
 
-			mvprintw(22,1,"Spacecraft is currently ");
-			if (obs.visible) {
-				mvprintw(22,25,"visible    ");
-			} else if (!(orbit.eclipsed)) {
-				mvprintw(22,25,"in sunlight");
-			} else {
-				mvprintw(22,25,"in eclipse ");
-			}
+				if (redraw) {
+					//display current time
+					attrset(COLOR_PAIR(6)|A_REVERSE|A_BOLD);
+					strftime(time_string, MAX_NUM_CHARS, "%a %d%b%y %j.%H:%M:%S", gmtime(&epoch));
+					mvprintw(1,54,"%s",time_string);
 
-			//display satellite AOS/LOS information
-			if (geostationary && (obs.elevation>=0.0)) {
-				mvprintw(21,1,"Satellite orbit is geostationary");
-				aoslos=-3651.0;
-			} else if ((obs.elevation>=0.0) && !geostationary && !decayed && daynum>lostime) {
-				predict_julian_date_t calc_time = daynum;
-				lostime = predict_next_los(qth, orbital_elements, calc_time);
-				time_t epoch = predict_from_julian(lostime);
-				strftime(time_string, MAX_NUM_CHARS, "%a %d%b%y %j.%H:%M:%S", gmtime(&epoch));
-				mvprintw(21,1,"LOS at: %s %s  ",time_string, "GMT");
-				aoslos=lostime;
-			} else if (obs.elevation<0.0 && !geostationary && !decayed && aos_happens && daynum>aoslos) {
-				predict_julian_date_t calc_time = daynum + 0.003;  /* Move ahead slightly... */
-				nextaos=predict_next_aos(qth, orbital_elements, calc_time);
-				time_t epoch = predict_from_julian(nextaos);
-				strftime(time_string, MAX_NUM_CHARS, "%a %d%b%y %j.%H:%M:%S", gmtime(&epoch));
-				mvprintw(21,1,"Next AOS: %s %s",time_string, "GMT");
-				aoslos=nextaos;
-			} else if (decayed || !aos_happens || (geostationary && (obs.elevation<0.0))){
-				mvprintw(21,1,"This satellite never reaches AOS");
-				aoslos=-3651.0;
-			}
+					attrset(COLOR_PAIR(4)|A_BOLD);
+					mvprintw(5,8,"N");
+					mvprintw(6,8,"E");
 
-			//predict and observe sun and moon
-			struct predict_observation sun;
-			predict_observe_sun(qth, daynum, &sun);
-
-			struct predict_observation moon;
-			predict_observe_moon(qth, daynum, &moon);
-
-			//display sun and moon
-			attrset(COLOR_PAIR(4)|A_REVERSE|A_BOLD);
-			mvprintw(20,55,"   Sun   ");
-			mvprintw(20,70,"   Moon  ");
-			if (sun.elevation > 0.0)
-				attrset(COLOR_PAIR(3)|A_BOLD);
-			else
-				attrset(COLOR_PAIR(2));
-			mvprintw(21,55,"%-7.2fAz",sun.azimuth*180.0/M_PI);
-			mvprintw(22,55,"%+-6.2f El",sun.elevation*180.0/M_PI);
-
-			attrset(COLOR_PAIR(3)|A_BOLD);
-			if (moon.elevation > 0.0)
-				attrset(COLOR_PAIR(1)|A_BOLD);
-			else
-				attrset(COLOR_PAIR(1));
-			mvprintw(21,70,"%-7.2fAz",moon.azimuth*180.0/M_PI);
-			mvprintw(22,70,"%+-6.2f El",moon.elevation*180.0/M_PI);
-
-			attrset(COLOR_PAIR(2)|A_BOLD);
-
-			//display downlink/uplink information
-			if (comsat) {
-				length=strlen(sat_db.transponder_name[xponder])/2;
-	      mvprintw(10,0,"                                                                                ");
-				mvprintw(10,40-length,"%s",sat_db.transponder_name[xponder]);
-
-				if (downlink!=0.0)
-					mvprintw(12,11,"%11.5f MHz%c%c%c",downlink,
-					readfreq ? '<' : ' ',
-					(readfreq || downlink_update) ? '=' : ' ',
-					downlink_update ? '>' : ' ');
-
-				else
-					mvprintw(12,11,"               ");
-
-				if (uplink!=0.0)
-					mvprintw(11,11,"%11.5f MHz%c%c%c",uplink,
-					readfreq ? '<' : ' ',
-					(readfreq || uplink_update) ? '=' : ' ',
-					uplink_update ? '>' : ' ');
-
-				else
-					mvprintw(11,11,"               ");
-			}
+					//display satellite data
+					attrset(COLOR_PAIR(2)|A_BOLD);
+					mvprintw(5,1,"%-6.2f",orbit.latitude*180.0/M_PI);
 
-			//calculate and display downlink/uplink information during pass, and control rig if available
-			doppler100=-100.0e06*((obs.range_rate*1000.0)/299792458.0);
-			delay=1000.0*((1000.0*obs.range)/299792458.0);
-			if (obs.elevation>=horizon) {
-				if (obs.elevation>=0 && aos_alarm==0) {
-					beep();
-					aos_alarm=1;
-				}
+					attrset(COLOR_PAIR(2)|A_BOLD);
+					mvprintw(5,55,"%0.f ",orbit.altitude*KM_TO_MI);
+					mvprintw(6,55,"%0.f ",orbit.altitude);
+					mvprintw(5,68,"%-5.0f",obs.range*KM_TO_MI);
+					mvprintw(6,68,"%-5.0f",obs.range);
+					mvprintw(6,1,"%-7.2f",orbit.longitude*180.0/M_PI);
+					mvprintw(5,15,"%-7.2f",obs.azimuth*180.0/M_PI);
+					mvprintw(6,14,"%+-6.2f",obs.elevation*180.0/M_PI);
+					mvprintw(5,29,"%0.f ",(3600.0*sat_vel)*KM_TO_MI);
+					mvprintw(6,29,"%0.f ",3600.0*sat_vel);
+					mvprintw(18,3,"%+6.2f deg",orbit.eclipse_depth*180.0/M_PI);
+					mvprintw(18,20,"%5.1f",256.0*(orbit.phase/(2*M_PI)));
+					mvprintw(18,37,"%s",ephemeris_string);
+					if (sat_db.squintflag) {
+						mvprintw(18,52,"%+6.2f",squint);
+					} else {
+						mvprintw(18,52,"N/A");
+					}
+					mvprintw(5,42,"%0.f ",orbit.footprint*KM_TO_MI);
+					mvprintw(6,42,"%0.f ",orbit.footprint);
 
-				if (comsat) {
-					attrset(COLOR_PAIR(4)|A_BOLD);
+					attrset(COLOR_PAIR(1)|A_BOLD);
+					mvprintw(20,1,"Orbit Number: %ld", orbit.revolutions);
 
-					if (fabs(obs.range_rate)<0.1)
-						mvprintw(13,34,"    TCA    ");
-					else {
-						if (obs.range_rate<0.0)
-							mvprintw(13,34,"Approaching");
+					mvprintw(22,1,"Spacecraft is currently ");
+					if (obs.visible) {
+						mvprintw(22,25,"visible    ");
+					} else if (!(orbit.eclipsed)) {
+						mvprintw(22,25,"in sunlight");
+					} else {
+						mvprintw(22,25,"in eclipse ");
+					}
 
-						if (obs.range_rate>0.0)
-							mvprintw(13,34,"  Receding ");
+					//display satellite AOS/LOS information
+					if (geostationary && (obs.elevation>=0.0)) {
+						mvprintw(21,1,"Satellite orbit is geostationary");
+						aoslos=-3651.0;
+					} else if ((obs.elevation>=0.0) && !geostationary && !decayed && daynum>lostime) {
+						const struct pass_table_pass *pass = pass_table_get_pass(pass_table, pass_table_find_pass(pass_table, daynum, false));
+						lostime = (pass != NULL) ? pass->los : daynum;
+						time_t epoch = predict_from_julian(lostime);
+						strftime(time_string, MAX_NUM_CHARS, "%a %d%b%y %j.%H:%M:%S", gmtime(&epoch));
+						mvprintw(21,1,"LOS at: %s %s  ",time_string, "GMT");
+						aoslos=lostime;
+					} else if (obs.elevation<0.0 && !geostationary && !decayed && aos_happens && daynum>aoslos) {
+						const struct pass_table_pass *pass = pass_table_get_pass(pass_table, pass_table_find_pass(pass_table, daynum, true));
+						nextaos = (pass != NULL) ? pass->aos : daynum;
+						time_t epoch = predict_from_julian(nextaos);
+						strftime(time_string, MAX_NUM_CHARS, "%a %d%b%y %j.%H:%M:%S", gmtime(&epoch));
+						mvprintw(21,1,"Next AOS: %s %s",time_string, "GMT");
+						aoslos=nextaos;
+					} else if (decayed || !aos_happens || (geostationary && (obs.elevation<0.0))){
+						mvprintw(21,1,"This satellite never reaches AOS");
+						aoslos=-3651.0;
 					}
 
+					//predict and observe sun and moon
+					struct predict_observation sun;
+					predict_observe_sun(qth, daynum, &sun);
+
+					struct predict_observation moon;
+					predict_observe_moon(qth, daynum, &moon);
+
+					//display sun and moon
+					attrset(COLOR_PAIR(4)|A_REVERSE|A_BOLD);
+					mvprintw(20,55,"   Sun   ");
+					mvprintw(20,70,"   Moon  ");
+					if (sun.elevation > 0.0)
+						attrset(COLOR_PAIR(3)|A_BOLD);
+					else
+						attrset(COLOR_PAIR(2));
+					mvprintw(21,55,"%-7.2fAz",sun.azimuth*180.0/M_PI);
+					mvprintw(22,55,"%+-6.2f El",sun.elevation*180.0/M_PI);
+
+					attrset(COLOR_PAIR(3)|A_BOLD);
+					if (moon.elevation > 0.0)
+						attrset(COLOR_PAIR(1)|A_BOLD);
+					else
+						attrset(COLOR_PAIR(1));
+					mvprintw(21,70,"%-7.2fAz",moon.azimuth*180.0/M_PI);
+					mvprintw(22,70,"%+-6.2f El",moon.elevation*180.0/M_PI);
+
 					attrset(COLOR_PAIR(2)|A_BOLD);
 
-					if (downlink!=0.0) {
-						dopp=1.0e-08*(doppler100*downlink);
-						mvprintw(12,32,"%11.5f MHz",downlink+dopp);
-						loss=32.4+(20.0*log10(downlink))+(20.0*log10(obs.range));
-						mvprintw(12,67,"%7.3f dB",loss);
-						mvprintw(13,13,"%7.3f   ms",delay);
-						if (downlink_info->connected && downlink_update)
-							rigctld_set_frequency(downlink_info, downlink+dopp);
+					//display downlink/uplink information
+					if (comsat) {
+						length=strlen(sat_db.transponder_name[xponder])/2;
+			      mvprintw(10,0,"                                                                                ");
+						mvprintw(10,40-length,"%s",sat_db.transponder_name[xponder]);
+
+						if (downlink!=0.0)
+							mvprintw(12,11,"%11.5f MHz%c%c%c",downlink,
+							readfreq ? '<' : ' ',
+							(readfreq || downlink_update) ? '=' : ' ',
+							downlink_update ? '>' : ' ');
+
+						else
+							mvprintw(12,11,"               ");
+
+						if (uplink!=0.0)
+							mvprintw(11,11,"%11.5f MHz%c%c%c",uplink,
+							readfreq ? '<' : ' ',
+							(readfreq || uplink_update) ? '=' : ' ',
+							uplink_update ? '>' : ' ');
+
+						else
+							mvprintw(11,11,"               ");
 					}
+				}
 
-					else
-					{
-						mvprintw(12,32,"                ");
-						mvprintw(12,67,"          ");
-						mvprintw(13,13,"            ");
+				//calculate and display downlink/uplink information during pass, and control rig if available
+				doppler100=-100.0e06*((obs.range_rate*1000.0)/299792458.0);
+				delay=1000.0*((1000.0*obs.range)/299792458.0);
+				if (obs.elevation>=horizon) {
+					if (obs.elevation>=0 && aos_alarm==0) {
+						beep();
+						aos_alarm=1;
+					}
+
+					if (comsat && redraw) {
+						attrset(COLOR_PAIR(4)|A_BOLD);
+
+						if (fabs(obs.range_rate)<0.1)
+							mvprintw(13,34,"    TCA    ");
+						else {
+							if (obs.range_rate<0.0)
+								mvprintw(13,34,"Approaching");
+
+							if (obs.range_rate>0.0)
+								mvprintw(13,34,"  Receding ");
+						}
+
+						attrset(COLOR_PAIR(2)|A_BOLD);
+
+						if (downlink!=0.0) {
+							dopp=1.0e-08*(doppler100*downlink);
+							mvprintw(12,32,"%11.5f MHz",downlink+dopp);
+							loss=32.4+(20.0*log10(downlink))+(20.0*log10(obs.range));
+							mvprintw(12,67,"%7.3f dB",loss);
+							mvprintw(13,13,"%7.3f   ms",delay);
+						}
+
+						else
+						{
+							mvprintw(12,32,"                ");
+							mvprintw(12,67,"          ");
+							mvprintw(13,13,"            ");
+						}
+						if (uplink!=0.0) {
+							dopp=1.0e-08*(doppler100*uplink);
+							mvprintw(11,32,"%11.5f MHz",uplink-dopp);
+							loss=32.4+(20.0*log10(uplink))+(20.0*log10(obs.range));
+							mvprintw(11,67,"%7.3f dB",loss);
+						}
+						else
+						{
+							mvprintw(11,32,"                ");
+							mvprintw(11,67,"          ");
+						}
+
+						if (uplink!=0.0 && downlink!=0.0)
+							mvprintw(12,67,"%7.3f ms",2.0*delay);
+						else
+							mvprintw(13,67,"              ");
 					}
-					if (uplink!=0.0) {
-						dopp=1.0e-08*(doppler100*uplink);
-						mvprintw(11,32,"%11.5f MHz",uplink-dopp);
-						loss=32.4+(20.0*log10(uplink))+(20.0*log10(obs.range));
-						mvprintw(11,67,"%7.3f dB",loss);
-						if (uplink_info->connected && uplink_update)
+
+					//send doppler-corrected frequencies to rigctld
+					if (comsat && control) {
+						if (downlink!=0.0 && downlink_info->connected && downlink_update) {
+							dopp=1.0e-08*(doppler100*downlink);
+							rigctld_set_frequency(downlink_info, downlink+dopp);
+						}
+						if (uplink!=0.0 && uplink_info->connected && uplink_update) {
+							dopp=1.0e-08*(doppler100*uplink);
 							rigctld_set_frequency(uplink_info, uplink-dopp);
+						}
 					}
-					else
-					{
+
+				} else {
+					lostime=0.0;
+					aos_alarm=0;
+
+					if (comsat && redraw) {
 						mvprintw(11,32,"                ");
 						mvprintw(11,67,"          ");
+						mvprintw(12,32,"                ");
+						mvprintw(12,67,"          ");
+						mvprintw(13,13,"            ");
+						mvprintw(13,34,"           ");
+						mvprintw(13,67,"          ");
 					}
-
-					if (uplink!=0.0 && downlink!=0.0)
-						mvprintw(12,67,"%7.3f ms",2.0*delay);
-					else
-						mvprintw(13,67,"              ");
 				}
 
-			} else {
-				lostime=0.0;
-				aos_alarm=0;
-
-				if (comsat) {
-					mvprintw(11,32,"                ");
-					mvprintw(11,67,"          ");
-					mvprintw(12,32,"                ");
-					mvprintw(12,67,"          ");
-					mvprintw(13,13,"            ");
-					mvprintw(13,34,"           ");
-					mvprintw(13,67,"          ");
+				if (redraw) {
+					//display rotation information
+					if (rotctld->connected) {
+						if (obs.elevation>=horizon)
+							mvprintw(17,67,"   Active   ");
+						else
+							mvprintw(17,67,"Standing  By");
+					} else
+						mvprintw(18,67,"Not  Enabled");
 				}
-			}
 
-			//display rotation information
-			if (rotctld->connected) {
-				if (obs.elevation>=horizon)
-					mvprintw(17,67,"   Active   ");
-				else
-					mvprintw(17,67,"Standing  By");
-			} else
-				mvprintw(18,67,"Not  Enabled");
-
-
-			//send data to rotctld
-			if (obs.elevation*180.0/M_PI >= horizon) {
-				time_t curr_time = time(NULL);
-				int elevation = (int)round(obs.elevation*180.0/M_PI);
-				int azimuth = (int)round(obs.azimuth*180.0/M_PI);
-				bool coordinates_differ = (elevation != prev_elevation) || (azimuth != prev_azimuth);
-				bool use_update_interval = (rotctld->update_time_interval > 0);
-
-				//send when coordinates differ or when a update interval has been specified
-				if ((coordinates_differ && !use_update_interval) || (use_update_interval && ((curr_time - rotctld->update_time_interval) >= prev_time))) {
-					if (rotctld->connected) rotctld_track(rotctld, obs.azimuth*180.0/M_PI, obs.elevation*180.0/M_PI);
-					prev_elevation = elevation;
-					prev_azimuth = azimuth;
-					prev_time = curr_time;
+				//send data to rotctld
+				if ((obs.elevation*180.0/M_PI >= horizon) && control) {
+					time_t curr_time = time(NULL);
+					int elevation = (int)round(obs.elevation*180.0/M_PI);
+					int azimuth = (int)round(obs.azimuth*180.0/M_PI);
+					bool coordinates_differ = (elevation != prev_elevation) || (azimuth != prev_azimuth);
+					bool use_update_interval = (rotctld->update_time_interval > 0);
+
+					//send when coordinates differ or when a update interval has been specified
+					if ((coordinates_differ && !use_update_interval) || (use_update_interval && ((curr_time - rotctld->update_time_interval) >= prev_time))) {
+						if (rotctld->connected) rotctld_track(rotctld, obs.azimuth*180.0/M_PI, obs.elevation*180.0/M_PI);
+						prev_elevation = elevation;
+						prev_azimuth = azimuth;
+						prev_time = curr_time;
+					}
 				}
 			}
 
 			/* Get input from keyboard */
 
-			ans=getch();
+			//waiting is skipped after a key, since further keys might already be buffered by curses
+			if (redraw) {
+				refresh();
+			}
+			if (ans == ERR) {
+				event_loop_wait(loop);
+			}
+			ans=ReadKey();
 
 			if (comsat) {
 				if (ans==' ' && sat_db.num_transponders>1) {
@@ -1466,10 +1462,11 @@ void SingleTrack(int orbit_ind, predict_observer_t *qth, struct transponder_db *
 					uplink_update=false;
 				if (ans=='f' || ans=='F')
 				{
-					if (downlink_info->connected)
-						downlink = rigctld_read_frequency(downlink_info)/(1+1.0e-08*doppler100);
-					if (uplink_info->connected)
-						uplink = rigctld_read_frequency(uplink_info)/(1-1.0e-08*doppler100);
+					//current frequencies are kept when the rig does not reply
+					if (downlink_info->connected && rigctld_read_frequency(downlink_info, &read_frequency))
+						downlink = read_frequency/(1+1.0e-08*doppler100);
+					if (uplink_info->connected && rigctld_read_frequency(uplink_info, &read_frequency))
+						uplink = read_frequency/(1-1.0e-08*doppler100);
 					if (ans=='f')
 					{
 						downlink_update=true;
@@ -1484,10 +1481,10 @@ void SingleTrack(int orbit_ind, predict_observer_t *qth, struct transponder_db *
 				{
 					if (downlink_info->connected && uplink_info->connected)
 					{
-						char tmp_vfo[MAX_NUM_CHARS];
-						strncpy(tmp_vfo, downlink_info->vfo_name, MAX_NUM_CHARS);
-						strncpy(downlink_info->vfo_name, uplink_info->vfo_name, MAX_NUM_CHARS);
-						strncpy(uplink_info->vfo_name, tmp_vfo, MAX_NUM_CHARS);
+						char tmp_vfo[RIGCTLD_MAX_VFO_NAME_LENGTH+1];
+						strncpy(tmp_vfo, downlink_info->vfo_name, RIGCTLD_MAX_VFO_NAME_LENGTH+1);
+						strncpy(downlink_info->vfo_name, uplink_info->vfo_name, RIGCTLD_MAX_VFO_NAME_LENGTH+1);
+						strncpy(uplink_info->vfo_name, tmp_vfo, RIGCTLD_MAX_VFO_NAME_LENGTH+1);
 					}
 				}
 			}
@@ -1502,28 +1499,26 @@ void SingleTrack(int orbit_ind, predict_observer_t *qth, struct transponder_db *
 				orbit_ind = get_next_enabled_satellite(orbit_ind, +1, tle_db);
 			}
 
-			halfdelay(HALF_DELAY_TIME);
-
 		} while (ans!='q' && ans!='Q' && ans!=27 &&
 		 	ans!='+' && ans!='-' &&
 		 	ans!=KEY_LEFT && ans!=KEY_RIGHT);
 
+		if (local_pass_table != NULL) {
+			pass_table_destroy(&local_pass_table);
+		}
 		predict_destroy_orbital_elements(orbital_elements);
 	} while (ans!='q' && ans!=17);
 
-	cbreak();
+	event_loop_destroy(&loop);
 }
 
 void Illumination(const char *name, predict_orbital_elements_t *orbital_elements)
 {
-	double startday, oneminute, sunpercent;
-	int eclipses, minutes, quit, breakout=0, count;
+	double startday, sunpercent, sunfraction;
+	int sunlit_minutes, quit, breakout=0, count;
+	bool decayed = false;
 	char string1[MAX_NUM_CHARS], string[MAX_NUM_CHARS], datestring[MAX_NUM_CHARS];
 
-	Print("","",0);
-
-	oneminute=1.0/(24.0*60.0);
-
 	predict_julian_date_t daynum = floor(GetStartTime(name));
 	startday=daynum;
 	count=0;
@@ -1533,8 +1528,10 @@ void Illumination(const char *name, predict_orbital_elements_t *orbital_elements
 
 	const int NUM_MINUTES = 1440;
 
-	struct predict_orbit orbit;
-
+	char title[MAX_NUM_CHARS] = {0};
+	sprintf(title, "%s (%d)", name, orbital_elements->satellite_number);
+	output_sink_t *sink = output_sink_create_pager(title, "Solar Illumination", PREDICT_ILLUMINATION_HEADER);
+	int page_lines = output_sink_page_lines();
 
 	do {
 		attrset(COLOR_PAIR(4));
@@ -1542,28 +1539,22 @@ void Illumination(const char *name, predict_orbital_elements_t *orbital_elements
 		refresh();
 
 		count++;
-		daynum=startday;
 
 		mvprintw(1,60, "%s (%d)", name, orbital_elements->satellite_number);
 
-		for (minutes=0, eclipses=0; minutes<NUM_MINUTES; minutes++) {
-			predict_orbit(orbital_elements, &orbit, daynum);
-
-			if (orbit.eclipsed) {
-				eclipses++;
-			}
-
-			daynum=startday+(oneminute*(double)minutes);
+		sunfraction=illumination_sunlit_fraction(orbital_elements, startday, startday+1.0);
+		if (sunfraction < 0) {
+			decayed=true;
+			sunfraction=0;
 		}
-
-		sunpercent=((double)eclipses)/((double)minutes);
-		sunpercent=100.0-(sunpercent*100.0);
+		sunlit_minutes=round(sunfraction*NUM_MINUTES);
+		sunpercent=sunfraction*100.0;
 
 		time_t epoch = predict_from_julian(startday);
 		strftime(datestring, MAX_NUM_CHARS, "%a %d%b%y %H:%M:%S", gmtime(&epoch));
 		datestring[11]=0;
 
-		sprintf(string1,"      %s    %4d    %6.2f%c",datestring,NUM_MINUTES-eclipses,sunpercent,37);
+		sprintf(string1,"      %s    %4d    %6.2f%c",datestring,sunlit_minutes,sunpercent,37);
 
 		/* Allow a quick way out */
 
@@ -1574,33 +1565,23 @@ void Illumination(const char *name, predict_orbital_elements_t *orbital_elements
 
 		nodelay(stdscr,FALSE);
 
-		startday+= (LINES-8);
-
-		daynum=startday;
-
-		for (minutes=0, eclipses=0; minutes<NUM_MINUTES; minutes++) {
-			predict_orbit(orbital_elements, &orbit, daynum);
-
-			if (orbit.eclipsed) {
-				eclipses++;
-			}
+		startday+= page_lines;
 
-			daynum=startday+(oneminute*(double)minutes);
+		sunfraction=illumination_sunlit_fraction(orbital_elements, startday, startday+1.0);
+		if (sunfraction < 0) {
+			decayed=true;
+			sunfraction=0;
 		}
-
-		sunpercent=((double)eclipses)/((double)minutes);
-		sunpercent=100.0-(sunpercent*100.0);
+		sunlit_minutes=round(sunfraction*NUM_MINUTES);
+		sunpercent=sunfraction*100.0;
 
 		epoch = predict_from_julian(startday);
 		strftime(datestring, MAX_NUM_CHARS, "%a %d%b%y %H:%M:%S", gmtime(&epoch));
 
 		datestring[11]=0;
-		sprintf(string,"%s\t %s    %4d    %6.2f%c\n",string1,datestring,1440-eclipses,sunpercent,37);
-
-		char title[MAX_NUM_CHARS] = {0};
-		sprintf(title, "%s (%d)", name, orbital_elements->satellite_number);
+		sprintf(string,"%s\t %s    %4d    %6.2f%c\n",string1,datestring,sunlit_minutes,sunpercent,37);
 
-		quit=Print(title,string,'s');
+		quit=output_sink_write(sink,string);
 
 		/* Allow a quick way out */
 
@@ -1611,14 +1592,16 @@ void Illumination(const char *name, predict_orbital_elements_t *orbital_elements
 
 		nodelay(stdscr,FALSE);
 
-		if (count< (LINES-8))
-			startday-= (LINES-9);
+		if (count< page_lines)
+			startday-= (page_lines-1);
 		else {
 			count=0;
 			startday+=1.0;
 		}
 	}
-	while (quit!=1 && breakout!=1 && !(orbit.decayed));
+	while (quit!=1 && breakout!=1 && !decayed);
+
+	output_sink_destroy(&sink);
 }
 
 void trim_whitespaces_from_end(char *string)
@@ -1662,10 +1645,7 @@ void EditWhitelist(struct tle_db *tle_db)
 
 	if (tle_db->num_tles > 0) {
 		attrset(COLOR_PAIR(3)|A_BOLD);
-		if (tle_db->num_tles >= MAX_NUM_SATS)
-			mvprintw(LINES-3,46,"Truncated to %d satellites",MAX_NUM_SATS);
-		else
-			mvprintw(LINES-3,46,"%d satellites",tle_db->num_tles);
+		mvprintw(LINES-3,46,"%d satellites",tle_db->num_tles);
 	}
 
 	/* Create form for query input */
@@ -2254,29 +2234,42 @@ void RunFlybyUI(bool new_user, const char *qthfile, predict_observer_t *observer
 
 	refresh();
 
+	//sleep until a key is pressed or the satellite list or sun/moon positions are due for an update
+	event_loop_t *loop = event_loop_create();
+	event_loop_add_fd(loop, STDIN_FILENO);
+	int listing_timer = event_loop_add_timer(loop, MULTITRACK_UPDATE_INTERVAL);
+	int sun_moon_timer = event_loop_add_timer(loop, SUN_MOON_UPDATE_INTERVAL);
+
 	/* Display main menu and handle keyboard input */
-	int key = 0;
+	int key = ERR;
+	bool redraw = true;
 	bool should_run = true;
 	while (should_run) {
 		curr_time = predict_to_julian(time(NULL));
 
-		if (!multitrack_search_field_visible(listing->search_field)) {
-			PrintMainMenu(main_menu_win);
+		//everything is redrawn after keyboard input, since the screen might have been cleared by a submenu
+		if (redraw || event_loop_ready(loop, sun_moon_timer)) {
+			if (!multitrack_search_field_visible(listing->search_field)) {
+				PrintMainMenu(main_menu_win);
+			}
+			PrintSunMoon(listing->window_height + listing->window_row - 7, sat_list_win_width+1, observer, curr_time);
+			PrintQth(listing->window_row, sat_list_win_width+1, observer);
 		}
-		PrintSunMoon(listing->window_height + listing->window_row - 7, sat_list_win_width+1, observer, curr_time);
-		PrintQth(listing->window_row, sat_list_win_width+1, observer);
 
 		//refresh satellite list
-		multitrack_update_listing(listing, curr_time);
-		multitrack_display_listing(listing);
-
-		//get input character
+		if (redraw || event_loop_ready(loop, listing_timer)) {
+			multitrack_update_listing(listing, curr_time);
+			multitrack_display_listing(listing);
+		}
 		refresh();
-		halfdelay(HALF_DELAY_TIME);  // Increase if CPU load is too high
-		key = getch();
-		if (key != -1) {
-			cbreak(); //turn off halfdelay
 
+		//get input character. Waiting is skipped after a key, since further keys might already be buffered by curses
+		if (key == ERR) {
+			event_loop_wait(loop);
+		}
+		key = ReadKey();
+		redraw = (key != ERR);
+		if (key != ERR) {
 			//handle input to satellite list
 			bool handled = multitrack_handle_listing(listing, key);
 
@@ -2288,13 +2281,13 @@ void RunFlybyUI(bool new_user, const char *qthfile, predict_observer_t *observer
 				const char *sat_name = tle_db->tles[satellite_index].name;
 				switch (option) {
 					case OPTION_SINGLETRACK:
-						SingleTrack(satellite_index, observer, sat_db, tle_db, rotctld, downlink, uplink);
+						SingleTrack(satellite_index, observer, sat_db, tle_db, listing, rotctld, downlink, uplink);
 						break;
 					case OPTION_PREDICT_VISIBLE:
-						Predict(sat_name, orbital_elements, observer, 'v');
+						Predict(sat_name, orbital_elements, observer, multitrack_pass_table(listing, satellite_index), 'v');
 						break;
 					case OPTION_PREDICT:
-						Predict(sat_name, orbital_elements, observer, 'p');
+						Predict(sat_name, orbital_elements, observer, multitrack_pass_table(listing, satellite_index), 'p');
 						break;
 					case OPTION_DISPLAY_ORBITAL_DATA:
 						ShowOrbitData(sat_name, orbital_elements);
@@ -2357,6 +2350,8 @@ void RunFlybyUI(bool new_user, const char *qthfile, predict_observer_t *observer
 		}
 	}
 
+	event_loop_destroy(&loop);
+
 	curs_set(1);
 	bkgdset(COLOR_PAIR(1));
 	clear();
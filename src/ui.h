@@ -5,6 +5,7 @@
 #include <predict/predict.h>
 #include "tle_db.h"
 #include "transponder_db.h"
+#include "multitrack.h"
 #include <curses.h>
 
 /**
@@ -34,39 +35,15 @@ void bailout(const char *string);
  **/
 void AutoUpdate(const char *string, struct tle_db *tle_db);
 
-/* This function buffers and displays orbital predictions.
- *
- * \param title Title to show on top of the screen
- * \param string Data string to display
- * \param mode Display mode for changing the UI according to the type
- * of data to show: 'p' for satellite passes, 'v' for visible passes, 's' for solar illumination prediction,
- * 'm' for moon passes, 's' for sun passes
- * \return 1 if user wants to quit, 0 otherwise
- **/
-int Print(const char *title, const char *string, char mode);
-
-/* This function acts as a filter to display passes that could
- * possibly be visible to the ground station.  It works by first
- * buffering prediction data generated by the Predict() function
- * and then checking it to see if at least a part of the pass
- * is visible.  If it is, then the buffered prediction data
- * is sent to the Print() function so it can be displayed
- * to the user.
- *
- * \param title Title to show on top of the screen
- * \param string Data to display
- * \return 1 if user wants to quit, 0 otherwise
- **/
-int PrintVisible(const char *title, const char *string);
-
 /* This function predicts satellite passes.
  *
  * \param name Name of satellite
  * \param orbital_elements Orbital elements of satellite
  * \param qth QTH at which satellite is to be observed
- * \param mode 'p' for all passes, 'v' for visible passes only
+ * \param pass_table Pass table of the satellite at the same QTH, for reusing already calculated passes. Can be NULL
+ * \param mode 'p' for all passes, tabulated at a step chosen by the user, 'v' for visible passes only
  **/
-void Predict(const char *name, predict_orbital_elements_t *orbital_elements, predict_observer_t *qth, char mode);
+void Predict(const char *name, predict_orbital_elements_t *orbital_elements, predict_observer_t *qth, pass_table_t *pass_table, char mode);
 
 /**
  * Convenience enum so that screens for predicting moon and sun can be unified to one function.
@@ -104,11 +81,12 @@ void QthEdit(const char *qthfile, predict_observer_t *qth);
  * \param qth Point of observation
  * \param transponder_db Transponder database
  * \param tle_db TLE database
+ * \param listing Satellite listing, for reusing passes already calculated there. Can be NULL
  * \param rotctld rotctld connection instance
  * \param downlink_info rigctld connection instance for downlink
  * \param uplink_info rigctld connection instance for uplink
  **/
-void SingleTrack(int orbit_ind, predict_observer_t *qth, struct transponder_db *transponder_db, struct tle_db *tle_db, rotctld_info_t *rotctld, rigctld_info_t *downlink_info, rigctld_info_t *uplink_info);
+void SingleTrack(int orbit_ind, predict_observer_t *qth, struct transponder_db *transponder_db, struct tle_db *tle_db, multitrack_listing_t *listing, rotctld_info_t *rotctld, rigctld_info_t *downlink_info, rigctld_info_t *uplink_info);
 
 /**
  * Display solar illumination predictions.
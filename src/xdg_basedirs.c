@@ -20,6 +20,8 @@
 #define XDG_CONFIG_DIRS_DEFAULT "/etc/xdg/"
 #define XDG_CONFIG_HOME "XDG_CONFIG_HOME"
 #define XDG_CONFIG_HOME_DEFAULT ".config/"
+#define XDG_CACHE_HOME "XDG_CACHE_HOME"
+#define XDG_CACHE_HOME_DEFAULT ".cache/"
 
 /**
  * Check if dirpath contains a backslash at the end, and append one if not.
@@ -114,6 +116,11 @@ char *xdg_config_home()
 	return xdg_home(XDG_CONFIG_HOME, XDG_CONFIG_HOME_DEFAULT);
 }
 
+char *xdg_cache_home()
+{
+	return xdg_home(XDG_CACHE_HOME, XDG_CACHE_HOME_DEFAULT);
+}
+
 void create_xdg_dirs()
 {
 	//create ~/.config/flyby
@@ -143,4 +150,18 @@ void create_xdg_dirs()
 		mkdir(data_path, 0777);
 	}
 	free(data_home);
+
+	//create ~/.cache/flyby
+	char *cache_home = xdg_cache_home();
+	char cache_path[MAX_NUM_CHARS] = {0};
+	err = stat(cache_home, &s);
+	if ((err == -1) && (errno == ENOENT)) {
+		mkdir(cache_home, 0777);
+	}
+	snprintf(cache_path, MAX_NUM_CHARS, "%s%s", cache_home, FLYBY_RELATIVE_ROOT_PATH);
+	err = stat(cache_path, &s);
+	if ((err == -1) && (errno == ENOENT)) {
+		mkdir(cache_path, 0777);
+	}
+	free(cache_home);
 }
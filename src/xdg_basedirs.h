@@ -37,7 +37,12 @@ char *xdg_config_dirs();
 char *xdg_config_home();
 
 /**
- * Create ~/.config/flyby and ./local/share/flyby/tles/ if these do not exist.
+ * \return XDG_CACHE_HOME variable, or the xdg basedir specification default if XDG_CACHE_HOME is empty
+ **/
+char *xdg_cache_home();
+
+/**
+ * Create ~/.config/flyby, ./local/share/flyby/tles/ and ~/.cache/flyby if these do not exist.
  **/
 void create_xdg_dirs();
 